@@ -1,15 +1,45 @@
 #include "ApiManager.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <sstream>
+#include <thread>
+
+#include <Poco/DateTime.h>
 #include <Poco/DateTimeFormatter.h>
+#include <Poco/Exception.h>
+#include <Poco/File.h>
+#include <Poco/JSON/Parser.h>
+#include <Poco/NumberParser.h>
+#include <Poco/Timestamp.h>
 
 #include <version.h>
 
 #include "CommonType.h"
 #include "DataConvert.h"
+#include "EventBus.h"
+#include "JsonWriter.h"
 #include "Logger.h"
+#include "SearchIndex.h"
 #include "TMDBAPI.h"
+#include "TaskExecutor.h"
 #include "Utils.h"
 
+const std::size_t ApiManager::BATCH_MAX_ITEMS;
+const std::size_t ApiManager::BATCH_MAX_JOBS;
+const std::size_t ApiManager::BATCH_WORKER_NUM;
+const std::size_t ApiManager::BATCH_MAX_ACTIVE;
+const std::size_t ApiManager::JOB_WORKER_NUM;
+const std::size_t ApiManager::JOB_QUEUE_SIZE;
+const std::size_t ApiManager::LIST_MAX_LIMIT;
+const std::size_t ApiManager::SEARCH_DEFAULT_LIMIT;
+const std::size_t ApiManager::DETAIL_CACHE_BYTES;
+const int ApiManager::SCAN_PROGRESS_INTERVAL_MS;
+
+// 进程启动时间, 区分不同进程的快照版本号
+static const std::string BOOT_TAG = std::to_string(std::time(nullptr));
+
 void ApiManager::SetScanPaths(std::map<VideoType, std::vector<std::string>> paths)
 {
     m_paths = paths;
@@ -20,13 +50,107 @@ void ApiManager::ProcessScan(VideoType videoType, bool forceDetectHdr)
     std::unique_lock<std::mutex> locker(m_scanInfos.at(videoType).lock, std::try_to_lock);
     m_scanInfos.at(videoType).scanStatus    = SCANNING;
     m_scanInfos.at(videoType).scanBeginTime = Poco::DateTime();
+
+    // 扫描期间定时推送进度, 进度没有变化时不推送
+    std::mutex              reportLock;
+    std::condition_variable reportCond;
+    bool                    isScanDone = false;
+    std::thread             reporter([&]() {
+        std::size_t                  lastProcessedNum = 0;
+        auto                         isDone           = [&isScanDone]() { return isScanDone; };
+        std::unique_lock<std::mutex> reportLocker(reportLock);
+        while (!reportCond.wait_for(reportLocker, std::chrono::milliseconds(SCAN_PROGRESS_INTERVAL_MS), isDone)) {
+            const std::size_t processedNum = m_scanInfos.at(videoType).processedVideoNum.load();
+            if (processedNum != lastProcessedNum) {
+                lastProcessedNum = processedNum;
+                PublishScanProgress(videoType, SCANNING);
+            }
+        }
+    });
+
+    // 扫描到新的列表中, 完成后整体发布, 扫描期间读取者使用的仍然是上一次的快照
+    std::vector<VideoInfo> videoInfos;
+    m_library.BeginScan(videoType);
     DataSource::Scan(videoType,
                      m_paths[videoType],
-                     m_videoInfos.at(videoType),
+                     videoInfos,
+                     m_scanInfos.at(videoType).foundVideoNum,
                      m_scanInfos.at(videoType).processedVideoNum,
                      forceDetectHdr);
+    {
+        std::lock_guard<std::mutex> reportLocker(reportLock);
+        isScanDone = true;
+    }
+    reportCond.notify_one();
+    reporter.join();
+
+    m_library.PublishScan(videoType, std::move(videoInfos));
+    PublishLibraryChange(videoType);
     m_scanInfos.at(videoType).scanEndTime = Poco::DateTime();
     m_scanInfos.at(videoType).scanStatus  = SCANNING_FINISHED;
+    PublishScanProgress(videoType, SCANNING_FINISHED);
+}
+
+void ApiManager::PublishScanProgress(VideoType videoType, ScanSatus scanStatus)
+{
+    if (!EventBus::Instance().HasSubscribers()) {
+        return;
+    }
+    const auto        &scanInfo = m_scanInfos.at(videoType);
+    std::ostringstream data;
+    JsonWriter         writer(data);
+    writer.StartObject();
+    writer.Field("VideoType", VIDEO_TYPE_TO_STR.at(videoType));
+    writer.Field("ScanStatus", static_cast<int>(scanStatus));
+    writer.Field("TotalVideoNum", scanInfo.foundVideoNum.load());
+    writer.Field("ProcessedVideoNum", scanInfo.processedVideoNum.load());
+    writer.EndObject();
+    EventBus::Instance().Publish("scan", data.str());
+}
+
+void ApiManager::PublishLibraryChange(VideoType videoType)
+{
+    if (!EventBus::Instance().HasSubscribers()) {
+        return;
+    }
+    std::ostringstream data;
+    JsonWriter         writer(data);
+    writer.StartObject();
+    writer.Field("videoType", VIDEO_TYPE_TO_STR.at(videoType));
+    writer.Field("epoch", BOOT_TAG);
+    writer.Field("version", m_library.Snapshot(videoType)->version);
+    writer.EndObject();
+    EventBus::Instance().Publish("library", data.str());
+}
+
+void ApiManager::PublishJobStatus(const JobInfo &info)
+{
+    if (!EventBus::Instance().HasSubscribers()) {
+        return;
+    }
+    std::ostringstream data;
+    JobInfoToJson(info).stringify(data);
+    EventBus::Instance().Publish("job", data.str());
+}
+
+bool ApiManager::LatestVideoInfo(VideoType videoType, VideoId id, VideoInfo &videoInfo)
+{
+    LibrarySnapshotPtr snapshot = m_library.Snapshot(videoType);
+    std::size_t        index    = 0;
+    if (!snapshot->Find(id, index)) {
+        return false;
+    }
+    videoInfo = *snapshot->videoInfos[index];
+    return true;
+}
+
+bool ApiManager::UpdateLibrary(VideoType videoType, VideoId id, const VideoInfo &videoInfo)
+{
+    if (!m_library.Update(videoType, id, videoInfo)) {
+        return false;
+    }
+    PublishLibraryChange(videoType);
+    return true;
 }
 
 void ApiManager::Scan(const Poco::JSON::Object &param, std::ostream &out)
@@ -51,19 +175,42 @@ void ApiManager::Scan(const Poco::JSON::Object &param, std::ostream &out)
         return;
     }
 
-    // 无法加锁说明后台正在扫描
-    std::unique_lock<std::mutex> locker(m_scanInfos.at(videoType).lock, std::try_to_lock);
-    if (!locker.owns_lock()) {
-        out << R"({"success": false, "msg": "Still scanning!"})";
+    bool forceDetectHdr = param.optValue("forceDetectHdr", false);
+    SubmitLibraryJob("scan " + VIDEO_TYPE_TO_STR.at(videoType),
+                     videoType,
+                     JOB_INTERACTIVE,
+                     [this, videoType, forceDetectHdr](const JobScheduler::CancelFlag &) {
+                         ProcessScan(videoType, forceDetectHdr);
+                     },
+                     out);
+}
+
+void ApiManager::SubmitLibraryJob(const std::string    &name,
+                                  VideoType             videoType,
+                                  JobPriority           priority,
+                                  JobScheduler::JobFunc func,
+                                  std::ostream         &out)
+{
+    uint64_t jobId = 0;
+    if (m_jobScheduler.Submit(name, "library:" + VIDEO_TYPE_TO_STR.at(videoType), priority, func, jobId)) {
+        Poco::JSON::Object outJsonObj;
+        outJsonObj.set("success", true);
+        outJsonObj.set("msg", "Job submitted!");
+        outJsonObj.set("jobId", jobId);
+        outJsonObj.stringify(out);
         return;
     }
 
-    // 加锁后在新线程进行扫描
-    std::thread scanThread(std::bind(&ApiManager::ProcessScan, this, std::placeholders::_1, std::placeholders::_2),
-                           videoType, param.optValue("forceDetectHdr", false));
-    scanThread.detach();
-
-    out << R"({"success": true, "msg": "Begin scanning!"})";
+    // 同一视频类型已有任务时返回已有任务的ID, 方便客户端查询其进度
+    if (jobId != 0) {
+        Poco::JSON::Object outJsonObj;
+        outJsonObj.set("success", false);
+        outJsonObj.set("msg", "Still scanning or refreshing!");
+        outJsonObj.set("jobId", jobId);
+        outJsonObj.stringify(out);
+        return;
+    }
+    out << R"({"success": false, "msg": "Too many pending jobs or server is quitting, try again later!"})";
 }
 
 void ApiManager::ScanAll()
@@ -77,32 +224,29 @@ void ApiManager::ScanAll()
 
 void ApiManager::ScanResult(const Poco::JSON::Object&, std::ostream &out)
 {
-    Poco::JSON::Array outJsonArr;
+    JsonWriter writer(out);
+    writer.StartArray();
     for (auto &scanInfoPair : m_scanInfos) {
-        Poco::JSON::Object           scanInfoJsonObj;
-        scanInfoJsonObj.set("VideoType", VIDEO_TYPE_TO_STR.at(scanInfoPair.first));
+        writer.StartObject();
+        writer.Field("VideoType", VIDEO_TYPE_TO_STR.at(scanInfoPair.first));
         auto& scanInfo = scanInfoPair.second;
         std::unique_lock<std::mutex> locker(scanInfo.lock, std::try_to_lock);
         if (!locker.owns_lock()) { // 避免原子性问题
-            scanInfoJsonObj.set("ScanStatus", static_cast<int>(SCANNING));
-            scanInfoJsonObj.set("ScanBeginTime",
-                                Poco::DateTimeFormatter::format(scanInfo.scanBeginTime, "%Y-%m-%d %H:%M:%S"));
-            scanInfoJsonObj.set("TotalVideoNum", static_cast<std::size_t>(m_videoInfos.at(scanInfoPair.first).size()));
-            scanInfoJsonObj.set("ProcessedVideoNum", scanInfo.processedVideoNum.load());
+            writer.Field("ScanStatus", static_cast<int>(SCANNING));
+            writer.Field("ScanBeginTime", Poco::DateTimeFormatter::format(scanInfo.scanBeginTime, "%Y-%m-%d %H:%M:%S"));
+            writer.Field("TotalVideoNum", scanInfo.foundVideoNum.load());
+            writer.Field("ProcessedVideoNum", scanInfo.processedVideoNum.load());
         } else if (scanInfo.scanStatus == NEVER_SCANNED) {
-            scanInfoJsonObj.set("ScanStatus", static_cast<int>(scanInfo.scanStatus));
+            writer.Field("ScanStatus", static_cast<int>(scanInfo.scanStatus));
         } else {
-            scanInfoJsonObj.set("ScanStatus", static_cast<int>(scanInfo.scanStatus));
-            scanInfoJsonObj.set("ScanBeginTime",
-                                Poco::DateTimeFormatter::format(scanInfo.scanBeginTime, "%Y-%m-%d %H:%M:%S"));
-            scanInfoJsonObj.set("ScanEndTime",
-                                Poco::DateTimeFormatter::format(scanInfo.scanEndTime, "%Y-%m-%d %H:%M:%S"));
-            scanInfoJsonObj.set("TotalVideoNum", static_cast<std::size_t>(m_videoInfos.at(scanInfoPair.first).size()));
+            writer.Field("ScanStatus", static_cast<int>(scanInfo.scanStatus));
+            writer.Field("ScanBeginTime", Poco::DateTimeFormatter::format(scanInfo.scanBeginTime, "%Y-%m-%d %H:%M:%S"));
+            writer.Field("ScanEndTime", Poco::DateTimeFormatter::format(scanInfo.scanEndTime, "%Y-%m-%d %H:%M:%S"));
+            writer.Field("TotalVideoNum", m_library.Snapshot(scanInfoPair.first)->videoInfos.size());
         }
-        outJsonArr.add(scanInfoJsonObj);
+        writer.EndObject();
     }
-
-    outJsonArr.stringify(out);
+    writer.EndArray();
 }
 
 void ApiManager::List(const Poco::JSON::Object &param, std::ostream &out)
@@ -119,71 +263,248 @@ void ApiManager::List(const Poco::JSON::Object &param, std::ostream &out)
     }
     VideoType videoType = findResult->second;
 
-    enum VideoStatus {
-        INCOMPLETE,
-        COMPLETE,
-        ALL,
-    };
+    // 排序与过滤
+    ListQuery query;
+    if (!ParseListFilter(param, query, out)) {
+        return;
+    }
+    if (!param.isNull("sort") && !LibraryQuery::ParseSortField(param.getValue<std::string>("sort"), query.sortField)) {
+        out << R"({"success": false, "msg": "Sort field is invalid!"})";
+        return;
+    }
+    query.descending = Poco::toLower(param.optValue<std::string>("order", "asc")) == "desc";
+
+    // 分页, 不指定limit时返回所有条目
+    if (!param.isNull("limit")) {
+        unsigned int limit = 0;
+        if (!Poco::NumberParser::tryParseUnsigned(param.getValue<std::string>("limit"), limit) || limit == 0) {
+            out << R"({"success": false, "msg": "Limit is invalid!"})";
+            return;
+        }
+        query.limit = std::min<std::size_t>(limit, LIST_MAX_LIMIT);
+    }
+    query.cursor = param.optValue<std::string>("cursor", "");
+
+    // 读取当前快照, 扫描/刮削进行中时返回上一次发布的结果
+    LibrarySnapshotPtr snapshot = m_library.Snapshot(videoType);
+    if (!snapshot->isScanned) {
+        out << R"({"success": false, "msg": "The datasource has never been scanned, please scan first!"})";
+        return;
+    }
+    ListPage page;
+    if (!LibraryQuery::Run(*snapshot, query, page)) {
+        out << R"({"success": false, "msg": "Cursor is invalid or does not match the sort order!"})";
+        return;
+    }
+
+    // 只输出当前页的条目, 由缓存的JSON片段拼接而成, ID由快照的ID索引给出, 不属于片段
+    JsonWriter writer(out);
+    writer.StartObject();
+    writer.Field("success", "true");
+    writer.Field("epoch", BOOT_TAG);
+    writer.Field("version", snapshot->version);
+    writer.Field("total", page.total);
+    if (!page.nextCursor.empty()) {
+        writer.Field("nextCursor", page.nextCursor);
+    }
+    writer.Key("list").StartArray();
+    for (auto index : page.indexes) {
+        writer.StartObject();
+        writer.Field("id", snapshot->IdAt(index));
+        writer.MergeObject(*m_fragmentCache.Brief(snapshot->videoInfos[index]));
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+}
 
-    static std::map<std::string, VideoStatus> videoStatusStrToEnum = {
-        {"incomplete", INCOMPLETE},
-        {"complete", COMPLETE},
-        {"all", ALL},
+bool ApiManager::ParseListFilter(const Poco::JSON::Object &param, ListQuery &query, std::ostream &out)
+{
+    static std::map<std::string, ListStatusFilter> videoStatusStrToEnum = {
+        {"incomplete", LIST_INCOMPLETE},
+        {"complete", LIST_COMPLETE},
+        {"all", LIST_ALL},
     };
 
-    VideoStatus videoStatus;
-    if (param.isNull("status")) {
-        videoStatus = ALL;
-    } else {
+    if (!param.isNull("status")) {
         const std::string videoStatusStr = Poco::toLower(param.getValue<std::string>("status"));
         auto iter = videoStatusStrToEnum.find(videoStatusStr);
         if (iter == videoStatusStrToEnum.end()) {
             out << R"({"success": false, "msg": "Video status is invalid!"})";
-            return;
-        } else {
-            videoStatus = iter->second;
+            return false;
         }
+        query.status = iter->second;
     }
 
-    Poco::JSON::Array           outJsonArr;
-    std::unique_lock<std::mutex> locker(m_scanInfos.at(videoType).lock, std::try_to_lock);
-    if (!locker.owns_lock()) {
-        out << R"({"success": false, "msg": "Scanning/refreshing job is still unfinished!"})";
+    query.hdrType = param.optValue<std::string>("hdr", "");
+    query.genre   = param.optValue<std::string>("genre", "");
+    query.country = param.optValue<std::string>("country", "");
+    query.studio  = param.optValue<std::string>("studio", "");
+    if (!param.isNull("hasArtwork")) {
+        query.hasArtwork = param.getValue<bool>("hasArtwork") ? 1 : 0;
+    }
+    return true;
+}
+
+void ApiManager::Facets(const Poco::JSON::Object &param, std::ostream &out)
+{
+    if (param.isNull("videoType")) {
+        out << R"({"success": false, "msg": "Video type is not given!"})";
         return;
-    } else if (m_scanInfos.at(videoType).scanStatus == NEVER_SCANNED) {
+    }
+
+    auto findResult = STR_TO_VIDEO_TYPE.find(param.get("videoType"));
+    if (findResult == STR_TO_VIDEO_TYPE.end()) {
+        out << R"({"success": false, "msg": "Video type is invalid!"})";
+        return;
+    }
+
+    ListQuery query;
+    if (!ParseListFilter(param, query, out)) {
+        return;
+    }
+
+    LibrarySnapshotPtr snapshot = m_library.Snapshot(findResult->second);
+    if (!snapshot->isScanned) {
         out << R"({"success": false, "msg": "The datasource has never been scanned, please scan first!"})";
         return;
-    } else {
-        for (std::size_t i = 0; i < m_videoInfos.at(videoType).size(); i++) {
-            const auto& videoInfo = m_videoInfos.at(videoType).at(i);
-            Poco::JSON::Object jsonObj;
-            switch (videoStatus) {
-                case INCOMPLETE: {
-                    if (DataSource::IsMetaCompleted(videoInfo)) {
-                        continue;
-                    }
-                    break;
-                }
-                case COMPLETE: {
-                    if (!DataSource::IsMetaCompleted(videoInfo)) {
-                        continue;
-                    }
-                    break;
-                }
-                case ALL:
-                default:
-                    break;
-            }
-            jsonObj.set("id", i);
-            VideoInfoToBriefJson(videoInfo, jsonObj);
-            outJsonArr.add(jsonObj);
+    }
+
+    // 各个取值的数量只计算与过滤结果的交集大小, 不遍历视频
+    const FacetIndex &facetIndex = *snapshot->facetIndex;
+    const Bitmap      candidates = LibraryQuery::Filter(facetIndex, query);
+    JsonWriter        writer(out);
+    writer.StartObject();
+    writer.Field("success", true);
+    writer.Field("total", candidates.Count());
+    writer.Key("facets").StartObject();
+    for (int field = 0; field < FACET_FIELD_NUM; field++) {
+        writer.Key(FacetIndex::FieldToStr(static_cast<FacetField>(field))).StartObject();
+        for (const auto &facet : facetIndex.Values(static_cast<FacetField>(field))) {
+            writer.Field(facet.first.c_str(), Bitmap::AndCount(candidates, *facet.second));
         }
+        writer.EndObject();
     }
+    writer.EndObject();
+    writer.EndObject();
+}
 
-    Poco::JSON::Object outJsonObj;
-    outJsonObj.set("success", "true");
-    outJsonObj.set("list", outJsonArr);
-    outJsonObj.stringify(out);
+void ApiManager::Search(const Poco::JSON::Object &param, std::ostream &out)
+{
+    if (param.isNull("videoType")) {
+        out << R"({"success": false, "msg": "Video type is not given!"})";
+        return;
+    }
+
+    if (param.isNull("q")) {
+        out << R"({"success": false, "msg": "Query is not given!"})";
+        return;
+    }
+
+    auto findResult = STR_TO_VIDEO_TYPE.find(param.get("videoType"));
+    if (findResult == STR_TO_VIDEO_TYPE.end()) {
+        out << R"({"success": false, "msg": "Video type is invalid!"})";
+        return;
+    }
+    VideoType videoType = findResult->second;
+
+    unsigned int limit = static_cast<unsigned int>(SEARCH_DEFAULT_LIMIT);
+    if (!param.isNull("limit") &&
+        (!Poco::NumberParser::tryParseUnsigned(param.getValue<std::string>("limit"), limit) || limit == 0)) {
+        out << R"({"success": false, "msg": "Limit is invalid!"})";
+        return;
+    }
+
+    LibrarySnapshotPtr snapshot = m_library.Snapshot(videoType);
+    if (!snapshot->isScanned) {
+        out << R"({"success": false, "msg": "The datasource has never been scanned, please scan first!"})";
+        return;
+    }
+
+    // 全文索引与快照分别读取, 索引中已被删除的视频跳过
+    std::vector<SearchHit> hits;
+    const std::size_t      pageSize = std::min<std::size_t>(limit, LIST_MAX_LIMIT);
+    const std::size_t      total    = m_library.Search(videoType, param.getValue<std::string>("q"), pageSize, hits);
+    JsonWriter writer(out);
+    writer.StartObject();
+    writer.Field("success", true);
+    writer.Field("total", total);
+    writer.Key("list").StartArray();
+    for (const auto &hit : hits) {
+        std::size_t index = 0;
+        if (!snapshot->Find(hit.id, index)) {
+            continue;
+        }
+        writer.StartObject();
+        writer.Field("id", hit.id);
+        writer.Field("score", hit.score);
+        writer.MergeObject(*m_fragmentCache.Brief(snapshot->videoInfos[index]));
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+}
+
+void ApiManager::Changes(const Poco::JSON::Object &param, std::ostream &out)
+{
+    if (param.isNull("videoType")) {
+        out << R"({"success": false, "msg": "Video type is not given!"})";
+        return;
+    }
+
+    if (param.isNull("since")) {
+        out << R"({"success": false, "msg": "Since is not given!"})";
+        return;
+    }
+
+    auto findResult = STR_TO_VIDEO_TYPE.find(param.get("videoType"));
+    if (findResult == STR_TO_VIDEO_TYPE.end()) {
+        out << R"({"success": false, "msg": "Video type is invalid!"})";
+        return;
+    }
+    VideoType videoType = findResult->second;
+
+    uint64_t since = 0;
+    if (!Poco::NumberParser::tryParseUnsigned64(param.getValue<std::string>("since"), since)) {
+        out << R"({"success": false, "msg": "Since is invalid!"})";
+        return;
+    }
+
+    LibrarySnapshotPtr   snapshot;
+    std::vector<VideoId> ids;
+    bool                 isIncremental = m_library.Changes(videoType, since, snapshot, ids);
+    if (!snapshot->isScanned) {
+        out << R"({"success": false, "msg": "The datasource has never been scanned, please scan first!"})";
+        return;
+    }
+    // 服务重启后版本号重新计数, 其他进程的版本号不可比较
+    if (param.optValue<std::string>("epoch", BOOT_TAG) != BOOT_TAG) {
+        isIncremental = false;
+    }
+
+    // 变化的视频以当前快照中的状态为准, 不在快照中的已被删除
+    JsonWriter writer(out);
+    writer.StartObject();
+    writer.Field("success", true);
+    writer.Field("epoch", BOOT_TAG);
+    writer.Field("version", snapshot->version);
+    writer.Field("resync", !isIncremental);
+    writer.Key("changes").StartArray();
+    for (std::size_t i = 0; isIncremental && i < ids.size(); i++) {
+        std::size_t index = 0;
+        writer.StartObject();
+        writer.Field("id", ids[i]);
+        if (!snapshot->Find(ids[i], index)) {
+            writer.Field("removed", true);
+        } else {
+            writer.Field("removed", false);
+            writer.Field("completed", DataSource::IsMetaCompleted(*snapshot->videoInfos[index]));
+            writer.MergeObject(*m_fragmentCache.Brief(snapshot->videoInfos[index]));
+        }
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
 }
 
 void ApiManager::Detail(const Poco::JSON::Object &param, std::ostream &out)
@@ -205,19 +526,101 @@ void ApiManager::Detail(const Poco::JSON::Object &param, std::ostream &out)
     }
     VideoType videoType = findResult->second;
 
-    Poco::JSON::Object outJsonObj;
-    std::unique_lock<std::mutex> locker(m_scanInfos.at(videoType).lock, std::try_to_lock);
-    if (locker.owns_lock() && m_scanInfos.at(videoType).scanStatus != NEVER_SCANNED) {
-        size_t id = std::stoull(param.getValue<std::string>("id"));
-        if (id >= m_videoInfos.at(videoType).size()) { // 防止ID越界
-            out << R"({"success": false, "msg": "Id is out of range!"})";
-            return;
-        }
-        outJsonObj.set("id", id);
-        VideoInfoToDetailedJson(m_videoInfos.at(videoType).at(id), outJsonObj);
+    LibrarySnapshotPtr snapshot = m_library.Snapshot(videoType);
+    if (!snapshot->isScanned) {
+        out << "{}";
+        return;
     }
 
-    outJsonObj.stringify(out);
+    VideoId     id    = 0;
+    std::size_t index = 0;
+    if (!Poco::NumberParser::tryParseUnsigned64(param.getValue<std::string>("id"), id)) {
+        out << R"({"success": false, "msg": "Id is invalid!"})";
+        return;
+    }
+    if (!snapshot->Find(id, index)) {
+        out << R"({"success": false, "msg": "Id is not found!"})";
+        return;
+    }
+    JsonWriter writer(out);
+    writer.StartObject();
+    writer.Field("id", id);
+    writer.MergeObject(*m_fragmentCache.Detailed(m_detailCache.Get(id, snapshot->videoInfos[index])));
+    writer.EndObject();
+}
+
+ApiManager::ExportFunc ApiManager::Export(const Poco::JSON::Object &param, std::ostream &out)
+{
+    if (param.isNull("videoType")) {
+        out << R"({"success": false, "msg": "Video type is not given!"})";
+        return nullptr;
+    }
+
+    auto findResult = STR_TO_VIDEO_TYPE.find(param.get("videoType"));
+    if (findResult == STR_TO_VIDEO_TYPE.end()) {
+        out << R"({"success": false, "msg": "Video type is invalid!"})";
+        return nullptr;
+    }
+
+    ListQuery query;
+    if (!ParseListFilter(param, query, out)) {
+        return nullptr;
+    }
+
+    LibrarySnapshotPtr snapshot = m_library.Snapshot(findResult->second);
+    if (!snapshot->isScanned) {
+        out << R"({"success": false, "msg": "The datasource has never been scanned, please scan first!"})";
+        return nullptr;
+    }
+
+    // 持有快照直到导出结束, 导出期间的扫描/刮削不影响导出的内容
+    const Bitmap candidates = LibraryQuery::Filter(*snapshot->facetIndex, query);
+    return [snapshot, candidates](std::ostream &ndjsonOut) {
+        candidates.ForEach([&snapshot, &ndjsonOut](uint32_t index) {
+            // 客户端断开后跳过剩余的条目
+            if (!ndjsonOut.good()) {
+                return;
+            }
+
+            // 逐条加载完整详情并立即输出, 内存占用与视频数无关; 不经过详情缓存, 避免淘汰交互访问的条目
+            VideoInfo videoInfo(*snapshot->videoInfos[index]);
+            LoadVideoDetail(videoInfo);
+            JsonWriter writer(ndjsonOut);
+            writer.StartObject();
+            writer.Field("id", snapshot->IdAt(index));
+            writer.MergeObject(VideoInfoToDetailedJsonStr(videoInfo));
+            writer.EndObject();
+            ndjsonOut << '\n';
+        });
+    };
+}
+
+bool ApiManager::LoadVideoDetail(VideoInfo &videoInfo)
+{
+    if (videoInfo.nfoStatus != FILE_FORMAT_MATCH) {
+        return false;
+    }
+    try {
+        return ParseNfoToVideoInfo(videoInfo);
+    } catch (Poco::Exception &e) {
+        LOG_WARN("Load detail failed for {}: {}", videoInfo.videoPath, e.displayText());
+    } catch (std::exception &e) {
+        LOG_WARN("Load detail failed for {}: {}", videoInfo.videoPath, e.what());
+    }
+    return false;
+}
+
+std::string ApiManager::LibraryETag(const Poco::JSON::Object &param)
+{
+    if (param.isNull("videoType")) {
+        return "";
+    }
+    auto findResult = STR_TO_VIDEO_TYPE.find(param.getValue<std::string>("videoType"));
+    if (findResult == STR_TO_VIDEO_TYPE.end()) {
+        return "";
+    }
+    return '"' + BOOT_TAG + '-' + VIDEO_TYPE_TO_STR.at(findResult->second) + '-' +
+           std::to_string(m_library.Snapshot(findResult->second)->version) + '"';
 }
 
 void ApiManager::Scrape(const Poco::JSON::Object &param, std::ostream &out)
@@ -244,23 +647,11 @@ void ApiManager::Scrape(const Poco::JSON::Object &param, std::ostream &out)
     }
     VideoType videoType = findResult->second;
 
-    std::unique_lock<std::mutex> locker(m_scanInfos.at(videoType).lock, std::try_to_lock);
-    if (!locker.owns_lock()) {
-        out << R"({"success": false, "msg": "Still scanning in background!"})";
-        return;
-    }
-
-    if (m_scanInfos.at(videoType).scanStatus == NEVER_SCANNED) {
+    if (!m_library.Snapshot(videoType)->isScanned) {
         out << R"({"success": false, "msg": "Never scanned!"})";
         return;
     }
 
-    size_t id = std::stoull(param.getValue<std::string>("id"));
-    if (id >= m_videoInfos.at(videoType).size()) { // 防止ID越界
-        out << R"({"success": false, "msg": "Id is out of range!"})";
-        return;
-    }
-
     // 电视剧需要给定季编号
     int seasonId = 0;
     bool forceUseOnlineTvMeta = param.optValue("forceUseOnlineTvMeta", false);
@@ -272,46 +663,537 @@ void ApiManager::Scrape(const Poco::JSON::Object &param, std::ostream &out)
         seasonId = std::stoi(param.getValue<std::string>("seasonId"));
     }
 
+    VideoId id = 0;
+    if (!Poco::NumberParser::tryParseUnsigned64(param.getValue<std::string>("id"), id)) {
+        out << R"({"success": false, "msg": "Id is invalid!"})";
+        return;
+    }
+
+    // 人工指定的TMDB ID以用户为准, 清除之前的404记录后重新请求
+    const int tmdbId = std::stoi(param.getValue<std::string>("tmdbid"));
+    TMDBAPI::ForgetMissing(videoType, tmdbId);
+
+    std::string msg;
+    bool        isSuccess = ScrapeOne(videoType,
+                               id,
+                               tmdbId,
+                               seasonId,
+                               forceUseOnlineTvMeta,
+                               msg);
+    FillWithResponseJson(out, isSuccess, msg);
+}
+
+bool ApiManager::ScrapeOne(VideoType    videoType,
+                           VideoId      id,
+                           int          tmdbId,
+                           int          seasonId,
+                           bool         forceUseOnlineTvMeta,
+                           std::string &msg)
+{
+    // 同一视频的刮削串行执行, 在锁内读取最新的信息, 不会覆盖并发刮削的结果; 不同视频的刮削互不阻塞
+    std::lock_guard<std::mutex> entryLocker(m_entryLocks.Of(id));
+
+    // 在副本上刮削, 成功后发布新的快照, 刮削期间读取者看到的仍然是原来的信息
     // TODO: 当NFO文件损坏时, 必须指定force才进行刮削
-    auto             &videoInfo = m_videoInfos.at(videoType).at(id);
-    int               tmdbId    = std::stoi(param.getValue<std::string>("tmdbid"));
-    std::stringstream sS;
+    VideoInfo videoInfo;
+    if (!LatestVideoInfo(videoType, id, videoInfo)) {
+        msg = "Id is not found!";
+        return false;
+    }
+    TMDBAPI api;
+    bool    isSuccess = false;
     switch (videoType) {
-        case MOVIE: {
-            TMDBAPI api;
-            if(!api.ScrapeMovie(videoInfo, tmdbId)) {
-                FillWithResponseJson(out, false, api.GetLastErrStr());
-            } else {
-                FillWithResponseJson(out, true, videoInfo.videoDetail.title);
+        case MOVIE:
+            isSuccess = api.ScrapeMovie(videoInfo, tmdbId);
+            break;
+        case TV:
+            isSuccess = api.ScrapeTV(videoInfo, tmdbId, seasonId, forceUseOnlineTvMeta);
+            break;
+        default:
+            msg = "Unsupported video type!";
+            return false;
+    }
+
+    if (isSuccess) {
+        if (!UpdateLibrary(videoType, id, videoInfo)) {
+            LOG_WARN("Video is removed by rescanning, scrape result of {} is not published", videoInfo.videoPath);
+        }
+
+        // 人工指定TMDB ID刮削成功后, 移出自动匹配的待确认队列
+        std::lock_guard<std::mutex> locker(m_reviewLock);
+        m_reviewQueue.erase(videoInfo.videoPath);
+    }
+
+    msg = isSuccess ? videoInfo.videoDetail.title : api.GetLastErrStr();
+    return isSuccess;
+}
+
+void ApiManager::ScrapeBatch(const Poco::JSON::Object &param, std::ostream &out)
+{
+    // 条目可以是POST的JSON数组, 也可以是查询参数中的JSON字符串
+    Poco::JSON::Array::Ptr itemsArr;
+    try {
+        if (param.isArray("items")) {
+            itemsArr = param.getArray("items");
+        } else if (param.has("items")) {
+            Poco::JSON::Parser parser;
+            itemsArr = parser.parse(param.getValue<std::string>("items")).extract<Poco::JSON::Array::Ptr>();
+        }
+    } catch (Poco::Exception &e) {
+        LOG_ERROR("Parse batch scrape items failed: {}", e.displayText());
+    }
+
+    if (itemsArr.isNull() || itemsArr->size() == 0) {
+        out << R"({"success": false, "msg": "Items are not given or invalid!"})";
+        return;
+    }
+
+    if (itemsArr->size() > BATCH_MAX_ITEMS) {
+        FillWithResponseJson(out, false, "Too many items, at most " + std::to_string(BATCH_MAX_ITEMS) + " per batch!");
+        return;
+    }
+
+    // 参数不合法的条目直接标记为失败, 不影响其余条目
+    auto job       = std::make_shared<BatchJob>();
+    job->beginTime = Poco::LocalDateTime();
+    job->items.resize(itemsArr->size());
+    for (std::size_t i = 0; i < itemsArr->size(); i++) {
+        auto &item = job->items[i];
+        try {
+            Poco::JSON::Object::Ptr itemObj = itemsArr->getObject(i);
+            if (itemObj.isNull() || itemObj->isNull("videoType") || itemObj->isNull("id") ||
+                itemObj->isNull("tmdbid")) {
+                throw Poco::InvalidArgumentException("videoType, id and tmdbid are required");
             }
-            return;
+
+            auto findResult = STR_TO_VIDEO_TYPE.find(itemObj->getValue<std::string>("videoType"));
+            if (findResult == STR_TO_VIDEO_TYPE.end()) {
+                throw Poco::InvalidArgumentException("video type is invalid");
+            }
+            item.videoType = findResult->second;
+            item.id        = std::stoull(itemObj->getValue<std::string>("id"));
+            item.tmdbId    = std::stoi(itemObj->getValue<std::string>("tmdbid"));
+            if (item.videoType == TV) {
+                if (itemObj->isNull("seasonId")) {
+                    throw Poco::InvalidArgumentException("TV should give season id");
+                }
+                item.seasonId = std::stoi(itemObj->getValue<std::string>("seasonId"));
+            }
+            item.forceUseOnlineTvMeta = itemObj->optValue("forceUseOnlineTvMeta", false);
+        } catch (Poco::Exception &e) {
+            item.status = BATCH_ITEM_FAILED;
+            item.msg    = "Invalid item: " + e.message();
+        } catch (std::exception &e) {
+            item.status = BATCH_ITEM_FAILED;
+            item.msg    = std::string("Invalid item: ") + e.what();
         }
-        case TV: {
-            TMDBAPI api;
-            if (!api.ScrapeTV(videoInfo, tmdbId, seasonId, forceUseOnlineTvMeta)) {
-                FillWithResponseJson(out, false, api.GetLastErrStr());
-            } else {
-                FillWithResponseJson(out, true, videoInfo.videoDetail.title);
+    }
+
+    for (const auto &item : job->items) {
+        job->finishedNum += item.status == BATCH_ITEM_FAILED ? 1 : 0;
+    }
+    if (job->finishedNum == job->items.size()) {
+        job->endTime = Poco::LocalDateTime();
+    }
+
+    auto process = [this, job](std::size_t index) { ProcessBatchItem(job, index); };
+    if (!SubmitBatchJob("scrape batch", job, process)) {
+        out << R"({"success": false, "msg": "Too many pending scrape items, try again later!"})";
+        return;
+    }
+
+    Poco::JSON::Object outJsonObj;
+    outJsonObj.set("success", true);
+    outJsonObj.set("jobId", job->jobId);
+    outJsonObj.set("total", job->items.size());
+    outJsonObj.stringify(out);
+}
+
+bool ApiManager::SubmitBatchJob(const std::string                      &name,
+                                std::shared_ptr<BatchJob>               job,
+                                const std::function<void(std::size_t)> &process)
+{
+    // 与扫描/刷新共用调度器, 可以通过/api/job查询与取消; 条目的状态仍记录在批量任务中.
+    // 条目分发到任务自己的执行器中并发执行, 请求速率由TMDBAPI限制; 取消后不再开始新的条目
+    auto func = [job, process](const JobScheduler::CancelFlag &cancelled) {
+        std::vector<std::size_t> pendingIndexes;
+        {
+            std::lock_guard<std::mutex> locker(job->lock);
+            for (std::size_t i = 0; i < job->items.size(); i++) {
+                if (job->items[i].status == BATCH_ITEM_PENDING) { // 参数不合法的条目已经标记为失败
+                    pendingIndexes.push_back(i);
+                }
             }
+        }
+
+        std::mutex                      lock;
+        std::condition_variable         cond;
+        std::size_t                     remaining = pendingIndexes.size();
+        std::vector<TaskExecutor::Task> tasks;
+        for (auto index : pendingIndexes) {
+            tasks.push_back([&cancelled, &process, &lock, &cond, &remaining, index]() {
+                // 条目的异常不能跳过计数, 否则任务会一直等待
+                try {
+                    if (!cancelled) {
+                        process(index);
+                    }
+                } catch (std::exception &e) {
+                    LOG_ERROR("Batch item {} failed: {}", index, e.what());
+                }
+                std::lock_guard<std::mutex> locker(lock);
+                if (--remaining == 0) {
+                    cond.notify_all();
+                }
+            });
+        }
+
+        // 执行器最后声明, 先于计数器析构, 析构时等待工作线程退出
+        TaskExecutor executor(BATCH_WORKER_NUM, std::max<std::size_t>(pendingIndexes.size(), 1));
+        if (executor.Submit(std::move(tasks))) {
+            std::unique_lock<std::mutex> locker(lock);
+            cond.wait(locker, [&remaining]() { return remaining == 0; });
+        }
+
+        // 取消后未开始的条目标记为失败
+        FailPendingItems(*job, "Job is cancelled!");
+    };
+
+    // 限制同时排队或执行的批量任务数, 为扫描/刷新保留调度器的线程
+    std::lock_guard<std::mutex> locker(m_batchLock);
+    std::size_t                 activeNum = 0;
+    for (const auto &pair : m_batchJobs) {
+        JobInfo info;
+        if (m_jobScheduler.Get(pair.first, info) && (info.status == JOB_QUEUED || info.status == JOB_RUNNING)) {
+            activeNum++;
+        }
+    }
+    if (activeNum >= BATCH_MAX_ACTIVE) {
+        return false;
+    }
+    if (!m_jobScheduler.Submit(name, "", JOB_INTERACTIVE, func, job->jobId)) {
+        return false;
+    }
+    m_batchJobs[job->jobId] = job;
+
+    // 只保留最近的任务记录
+    while (m_batchJobs.size() > BATCH_MAX_JOBS) {
+        m_batchJobs.erase(m_batchJobs.begin());
+    }
+    return true;
+}
+
+void ApiManager::FailPendingItems(BatchJob &job, const std::string &msg)
+{
+    std::lock_guard<std::mutex> locker(job.lock);
+    bool                        changed = false;
+    for (auto &item : job.items) {
+        if (item.status == BATCH_ITEM_PENDING) {
+            item.status = BATCH_ITEM_FAILED;
+            item.msg    = msg;
+            job.finishedNum++;
+            changed = true;
+        }
+    }
+    if (changed && job.finishedNum == job.items.size()) {
+        job.endTime = Poco::LocalDateTime();
+    }
+}
+
+void ApiManager::ProcessBatchItem(std::shared_ptr<BatchJob> job, std::size_t index)
+{
+    BatchItem item;
+    {
+        std::lock_guard<std::mutex> locker(job->lock);
+        job->items[index].status = BATCH_ITEM_RUNNING;
+        item                     = job->items[index];
+    }
+
+    std::string msg;
+    bool        isSuccess = false;
+    if (IsQuitting()) {
+        msg = "Server is quitting!";
+    } else if (!m_library.Snapshot(item.videoType)->isScanned) {
+        msg = "Never scanned!";
+    } else {
+        isSuccess = ScrapeOne(item.videoType, item.id, item.tmdbId, item.seasonId, item.forceUseOnlineTvMeta, msg);
+    }
+
+    std::lock_guard<std::mutex> locker(job->lock);
+    job->items[index].status = isSuccess ? BATCH_ITEM_SUCCESS : BATCH_ITEM_FAILED;
+    job->items[index].msg    = msg;
+    if (++job->finishedNum == job->items.size()) {
+        job->endTime = Poco::LocalDateTime();
+    }
+}
+
+void ApiManager::ScrapeBatchResult(const Poco::JSON::Object &param, std::ostream &out)
+{
+    if (param.isNull("jobId")) {
+        out << R"({"success": false, "msg": "Job id is not given!"})";
+        return;
+    }
+
+    Poco::UInt64 jobId = 0;
+    if (!Poco::NumberParser::tryParseUnsigned64(param.getValue<std::string>("jobId"), jobId)) {
+        out << R"({"success": false, "msg": "Job id is invalid!"})";
+        return;
+    }
+
+    std::shared_ptr<BatchJob> job;
+    {
+        std::lock_guard<std::mutex> locker(m_batchLock);
+        auto                        iter = m_batchJobs.find(jobId);
+        if (iter == m_batchJobs.end()) {
+            out << R"({"success": false, "msg": "Job is not found or expired!"})";
             return;
         }
-        default:
-            out << R"({"success": false, "msg": "Unsupported video type!"})";
+        job = iter->second;
+    }
+
+    // 排队中被取消或者退出时被丢弃的任务不会执行, 其条目不会再被处理
+    JobInfo info;
+    if (!m_jobScheduler.Get(job->jobId, info) || (info.status != JOB_QUEUED && info.status != JOB_RUNNING)) {
+        FailPendingItems(*job, "Job is cancelled!");
+    }
+
+    static const std::map<BatchItemStatus, std::string> BATCH_ITEM_STATUS_TO_STR = {
+        {BATCH_ITEM_PENDING, "pending"},
+        {BATCH_ITEM_RUNNING, "running"},
+        {BATCH_ITEM_SUCCESS, "success"},
+        {BATCH_ITEM_FAILED, "failed"},
+        {BATCH_ITEM_REVIEW, "review"},
+    };
+
+    Poco::JSON::Object outJsonObj;
+    Poco::JSON::Array  itemsJsonArr;
+    std::size_t        successNum = 0;
+
+    std::lock_guard<std::mutex> locker(job->lock);
+    for (const auto &item : job->items) {
+        Poco::JSON::Object itemJsonObj;
+        if (item.videoType != UNKNOWN_TYPE) {
+            itemJsonObj.set("videoType", VIDEO_TYPE_TO_STR.at(item.videoType));
+        }
+        itemJsonObj.set("id", item.id);
+        itemJsonObj.set("tmdbid", item.tmdbId);
+        if (item.videoType == TV) {
+            itemJsonObj.set("seasonId", item.seasonId);
+        }
+        itemJsonObj.set("status", BATCH_ITEM_STATUS_TO_STR.at(item.status));
+        if (!item.msg.empty()) {
+            itemJsonObj.set("msg", item.msg);
+        }
+        if (!item.videoPath.empty()) {
+            itemJsonObj.set("path", item.videoPath);
+        }
+        itemsJsonArr.add(itemJsonObj);
+        successNum += item.status == BATCH_ITEM_SUCCESS ? 1 : 0;
+    }
+
+    bool isFinished = job->finishedNum == job->items.size();
+    outJsonObj.set("success", true);
+    outJsonObj.set("jobId", job->jobId);
+    outJsonObj.set("finished", isFinished);
+    outJsonObj.set("total", job->items.size());
+    outJsonObj.set("processed", job->finishedNum);
+    outJsonObj.set("succeeded", successNum);
+    outJsonObj.set("beginTime", Poco::DateTimeFormatter::format(job->beginTime, "%Y-%m-%d %H:%M:%S"));
+    if (isFinished) {
+        outJsonObj.set("endTime", Poco::DateTimeFormatter::format(job->endTime, "%Y-%m-%d %H:%M:%S"));
+    }
+    outJsonObj.set("items", itemsJsonArr);
+    outJsonObj.stringify(out);
+}
+
+void ApiManager::AutoMatch(const Poco::JSON::Object &param, std::ostream &out)
+{
+    if (param.isNull("videoType")) {
+        out << R"({"success": false, "msg": "Video type is not given!"})";
+        return;
+    }
+
+    auto findResult = STR_TO_VIDEO_TYPE.find(param.get("videoType"));
+    if (findResult == STR_TO_VIDEO_TYPE.end() || (findResult->second != MOVIE && findResult->second != TV)) {
+        out << R"({"success": false, "msg": "Video type is invalid!"})";
+        return;
+    }
+    VideoType videoType = findResult->second;
+
+    // 从当前快照中收集没有NFO的视频, 匹配在后台进行
+    auto                     job      = std::make_shared<BatchJob>();
+    LibrarySnapshotPtr       snapshot = m_library.Snapshot(videoType);
+    std::vector<std::string> firstEpisodePaths;
+    if (!snapshot->isScanned) {
+        out << R"({"success": false, "msg": "Never scanned!"})";
+        return;
+    }
+
+    for (std::size_t i = 0; i < snapshot->videoInfos.size() && job->items.size() < BATCH_MAX_ITEMS; i++) {
+        const VideoInfo &videoInfo = *snapshot->videoInfos[i];
+        if (videoInfo.nfoStatus == FILE_FORMAT_MATCH) {
+            continue;
+        }
+        BatchItem item;
+        item.videoType = videoType;
+        item.id        = snapshot->IdAt(i);
+        item.videoPath = videoInfo.videoPath;
+        job->items.push_back(item);
+        firstEpisodePaths.push_back(
+            videoInfo.videoDetail.episodePaths.empty() ? "" : videoInfo.videoDetail.episodePaths.front().str());
+    }
+
+    job->beginTime = Poco::LocalDateTime();
+    if (job->items.empty()) {
+        job->endTime = Poco::LocalDateTime();
+    }
+
+    auto process = [this, job, firstEpisodePaths](std::size_t index) {
+        ProcessAutoMatchItem(job, index, firstEpisodePaths[index]);
+    };
+    if (!SubmitBatchJob("auto match " + VIDEO_TYPE_TO_STR.at(videoType), job, process)) {
+        out << R"({"success": false, "msg": "Too many pending scrape items, try again later!"})";
+        return;
+    }
+
+    Poco::JSON::Object outJsonObj;
+    outJsonObj.set("success", true);
+    outJsonObj.set("jobId", job->jobId);
+    outJsonObj.set("total", job->items.size());
+    outJsonObj.stringify(out);
+}
+
+void ApiManager::ProcessAutoMatchItem(std::shared_ptr<BatchJob> job,
+                                      std::size_t               index,
+                                      const std::string        &firstEpisodePath)
+{
+    BatchItem item;
+    {
+        std::lock_guard<std::mutex> locker(job->lock);
+        job->items[index].status = BATCH_ITEM_RUNNING;
+        item                     = job->items[index];
+    }
+
+    // 搜索与打分基于快照进行, 多个条目可以并发进行, 请求速率由TMDBAPI限制
+    MatchResult matchResult;
+    if (IsQuitting()) {
+        item.status = BATCH_ITEM_FAILED;
+        item.msg    = "Server is quitting!";
+    } else if (!AutoMatcher::Match(item.videoType, item.videoPath, firstEpisodePath, matchResult)) {
+        item.status = BATCH_ITEM_FAILED;
+        item.msg    = "Name can not be parsed or search failed!";
+    } else if (!matchResult.isConfident) {
+        item.status = BATCH_ITEM_REVIEW;
+        if (matchResult.candidates.empty()) {
+            item.msg = "No candidates found for \"" + matchResult.parsed.title + "\"";
+        } else {
+            item.tmdbId = matchResult.candidates.front().tmdbId;
+            item.msg    = "Low confidence(" + std::to_string(matchResult.candidates.front().score) + "): " +
+                       matchResult.candidates.front().title;
+        }
+
+        ReviewEntry entry;
+        entry.videoType   = item.videoType;
+        entry.id          = item.id;
+        entry.matchResult = matchResult;
+        entry.addTime     = Poco::LocalDateTime();
+
+        std::lock_guard<std::mutex> locker(m_reviewLock);
+        m_reviewQueue[item.videoPath] = entry;
+    } else {
+        item.tmdbId   = matchResult.candidates.front().tmdbId;
+        item.seasonId = matchResult.parsed.season > 0 ? matchResult.parsed.season : 1;
+
+        // 刮削前确认视频没有因为重新扫描而被删除
+        LibrarySnapshotPtr snapshot = m_library.Snapshot(item.videoType);
+        std::size_t        index    = 0;
+        if (!snapshot->Find(item.id, index) || snapshot->videoInfos[index]->videoPath != item.videoPath) {
+            item.status = BATCH_ITEM_FAILED;
+            item.msg    = "Video is removed by rescanning!";
+        } else {
+            bool isSuccess =
+                ScrapeOne(item.videoType, item.id, item.tmdbId, item.seasonId, item.forceUseOnlineTvMeta, item.msg);
+            item.status = isSuccess ? BATCH_ITEM_SUCCESS : BATCH_ITEM_FAILED;
+        }
+    }
+
+    std::lock_guard<std::mutex> locker(job->lock);
+    job->items[index] = item;
+    if (++job->finishedNum == job->items.size()) {
+        job->endTime = Poco::LocalDateTime();
+    }
+}
+
+void ApiManager::ReviewQueue(const Poco::JSON::Object &param, std::ostream &out)
+{
+    VideoType videoType = UNKNOWN_TYPE;
+    if (!param.isNull("videoType")) {
+        auto findResult = STR_TO_VIDEO_TYPE.find(param.get("videoType"));
+        if (findResult == STR_TO_VIDEO_TYPE.end()) {
+            out << R"({"success": false, "msg": "Video type is invalid!"})";
             return;
+        }
+        videoType = findResult->second;
+    }
+
+    std::lock_guard<std::mutex> locker(m_reviewLock);
+    if (!param.isNull("dismiss")) {
+        m_reviewQueue.erase(param.getValue<std::string>("dismiss"));
     }
+
+    Poco::JSON::Array outJsonArr;
+    for (const auto &entryPair : m_reviewQueue) {
+        const auto &entry = entryPair.second;
+        if (videoType != UNKNOWN_TYPE && entry.videoType != videoType) {
+            continue;
+        }
+
+        Poco::JSON::Object entryJsonObj;
+        entryJsonObj.set("videoType", VIDEO_TYPE_TO_STR.at(entry.videoType));
+        entryJsonObj.set("id", entry.id);
+        entryJsonObj.set("path", entryPair.first);
+        entryJsonObj.set("parsedTitle", entry.matchResult.parsed.title);
+        entryJsonObj.set("parsedYear", entry.matchResult.parsed.year);
+        if (entry.videoType == TV) {
+            entryJsonObj.set("seasonId", entry.matchResult.parsed.season > 0 ? entry.matchResult.parsed.season : 1);
+        }
+        entryJsonObj.set("addTime", Poco::DateTimeFormatter::format(entry.addTime, "%Y-%m-%d %H:%M:%S"));
+
+        Poco::JSON::Array candidatesJsonArr;
+        for (const auto &candidate : entry.matchResult.candidates) {
+            Poco::JSON::Object candidateJsonObj;
+            candidateJsonObj.set("tmdbid", candidate.tmdbId);
+            candidateJsonObj.set("title", candidate.title);
+            candidateJsonObj.set("originalTitle", candidate.originalTitle);
+            candidateJsonObj.set("year", candidate.year);
+            candidateJsonObj.set("runtime", candidate.runtime);
+            candidateJsonObj.set("score", candidate.score);
+            candidatesJsonArr.add(candidateJsonObj);
+        }
+        entryJsonObj.set("candidates", candidatesJsonArr);
+        outJsonArr.add(entryJsonObj);
+    }
+
+    Poco::JSON::Object outJsonObj;
+    outJsonObj.set("success", true);
+    outJsonObj.set("list", outJsonArr);
+    outJsonObj.stringify(out);
 }
 
-void ApiManager::ProcessRefresh(VideoType videoType)
+void ApiManager::ProcessRefresh(VideoType videoType, const JobScheduler::CancelFlag &cancelled)
 {
+    // 扫描过程无法中断, 扫描结束后再检查是否已取消
     ProcessScan(videoType, true);
+    if (cancelled.load()) {
+        return;
+    }
 
     std::unique_lock<std::mutex> locker(m_refreshInfos[videoType].lock, std::try_to_lock);
     m_refreshInfos[videoType].refreshStatus = REFRESHING;
     m_refreshInfos[videoType].refreshBeginTime = Poco::DateTime();
     if (videoType == MOVIE) {
-        RefreshMovie();
+        RefreshMovie(cancelled);
     } else if (videoType == TV) {
-        RefreshTV();
+        RefreshTV(cancelled);
     }
     m_refreshInfos[videoType].refreshEndTime = Poco::DateTime();
     m_refreshInfos[videoType].refreshStatus  = REFRESHING_FINISHED;
@@ -331,82 +1213,162 @@ void ApiManager::Refresh(const Poco::JSON::Object &param, std::ostream &out)
     }
     VideoType videoType = findResult->second;
 
-    // 无法加锁说明后台正在扫描
-    std::unique_lock<std::mutex> locker(m_scanInfos.at(videoType).lock, std::try_to_lock);
-    if (!locker.owns_lock()) {
-        out << R"({"success": false, "msg": "Still refreshing!"})";
-        return;
-    }
-
-    // 加锁后在新线程进行扫描
-    std::thread scanThread(std::bind(&ApiManager::ProcessRefresh, this, std::placeholders::_1), videoType);
-    scanThread.detach();
-
-    out << R"({"success": true})";
+    SubmitLibraryJob("refresh " + VIDEO_TYPE_TO_STR.at(videoType),
+                     videoType,
+                     JOB_INTERACTIVE,
+                     [this, videoType](const JobScheduler::CancelFlag &cancelled) {
+                         ProcessRefresh(videoType, cancelled);
+                     },
+                     out);
 }
 
 void ApiManager::RefreshResult(const Poco::JSON::Object &, std::ostream &out)
 {
-    Poco::JSON::Array outJsonArr;
+    JsonWriter writer(out);
+    writer.StartArray();
     for (auto &refreshInfoPair : m_refreshInfos) {
-        Poco::JSON::Object refreshInfoJsonObj;
-        refreshInfoJsonObj.set("VideoType", VIDEO_TYPE_TO_STR.at(refreshInfoPair.first));
+        writer.StartObject();
+        writer.Field("VideoType", VIDEO_TYPE_TO_STR.at(refreshInfoPair.first));
         auto                        &refreshInfo = refreshInfoPair.second;
         std::unique_lock<std::mutex> locker(refreshInfo.lock, std::try_to_lock);
         if (!locker.owns_lock()) { // 避免原子性问题
-            refreshInfoJsonObj.set("RefreshStatus", static_cast<int>(REFRESHING));
-            refreshInfoJsonObj.set("RefreshBeginTime",
-                                   Poco::DateTimeFormatter::format(refreshInfo.refreshBeginTime, "%Y-%m-%d %H:%M:%S"));
+            writer.Field("RefreshStatus", static_cast<int>(REFRESHING));
+            writer.Field("RefreshBeginTime",
+                         Poco::DateTimeFormatter::format(refreshInfo.refreshBeginTime, "%Y-%m-%d %H:%M:%S"));
         } else if (refreshInfo.refreshStatus == NEVER_REFRESHED) {
-            refreshInfoJsonObj.set("RefreshStatus", static_cast<int>(refreshInfo.refreshStatus));
+            writer.Field("RefreshStatus", static_cast<int>(refreshInfo.refreshStatus));
         } else {
-            refreshInfoJsonObj.set("RefreshStatus", static_cast<int>(refreshInfo.refreshStatus));
-            refreshInfoJsonObj.set("RefreshBeginTime",
-                                   Poco::DateTimeFormatter::format(refreshInfo.refreshBeginTime, "%Y-%m-%d %H:%M:%S"));
-            refreshInfoJsonObj.set("RefreshEndTime",
-                                   Poco::DateTimeFormatter::format(refreshInfo.refreshEndTime, "%Y-%m-%d %H:%M:%S"));
-            refreshInfoJsonObj.set("TotalVideoNum",
-                                   static_cast<std::size_t>(m_videoInfos.at(refreshInfoPair.first).size()));
+            writer.Field("RefreshStatus", static_cast<int>(refreshInfo.refreshStatus));
+            writer.Field("RefreshBeginTime",
+                         Poco::DateTimeFormatter::format(refreshInfo.refreshBeginTime, "%Y-%m-%d %H:%M:%S"));
+            writer.Field("RefreshEndTime",
+                         Poco::DateTimeFormatter::format(refreshInfo.refreshEndTime, "%Y-%m-%d %H:%M:%S"));
+            writer.Field("TotalVideoNum", m_library.Snapshot(refreshInfoPair.first)->videoInfos.size());
+        }
+        writer.EndObject();
+    }
+    writer.EndArray();
+}
+
+/**
+ * @brief 获取电视剧本地最新剧集文件的修改时间
+ *
+ * @param videoInfo 电视剧的视频信息
+ * @return std::time_t 修改时间, 没有剧集时为0
+ */
+static std::time_t LatestEpisodeTime(const VideoInfo &videoInfo)
+{
+    std::time_t latestTime = 0;
+    for (const auto &compactPath : videoInfo.videoDetail.episodePaths) {
+        const std::string episodePath = compactPath.str();
+        try {
+            latestTime = std::max(latestTime, Poco::File(episodePath).getLastModified().epochTime());
+        } catch (Poco::Exception &e) {
+            LOG_WARN("Get modified time failed for {}: {}", episodePath, e.displayText());
         }
-        outJsonArr.add(refreshInfoJsonObj);
     }
+    return latestTime;
+}
 
-    outJsonArr.stringify(out);
+bool ApiManager::SubmitAutoUpdate()
+{
+    uint64_t jobId = 0;
+    return m_jobScheduler.Submit("auto update " + VIDEO_TYPE_TO_STR.at(TV),
+                                 "library:" + VIDEO_TYPE_TO_STR.at(TV),
+                                 JOB_BACKGROUND,
+                                 [this](const JobScheduler::CancelFlag &cancelled) {
+                                     ProcessScan(TV, false);
+                                     if (!cancelled.load()) {
+                                         AutoUpdateTV(cancelled);
+                                     }
+                                 },
+                                 jobId);
 }
 
-void ApiManager::AutoUpdateTV()
+void ApiManager::AutoUpdateTV(const JobScheduler::CancelFlag &cancelled)
 {
-    if (m_videoInfos.at(TV).empty()) {
+    LibrarySnapshotPtr snapshot = m_library.Snapshot(TV);
+    if (snapshot->videoInfos.empty()) {
         LOG_WARN("Empty tv show in datasource, scan first or add new!");
         return;
     }
 
-    std::unique_lock<std::mutex> locker(m_scanInfos.at(TV).lock, std::try_to_lock);
+    // 同步扫描结果: 本地出现新剧集或者缺失剧集NFO的剧立即检查, 其余的按照播出计划检查
+    const std::time_t                  now = std::time(nullptr);
+    std::map<std::string, std::size_t> tvIds;
+    for (std::size_t i = 0; i < snapshot->videoInfos.size(); i++) {
+        const VideoInfo &videoInfo = *snapshot->videoInfos[i];
+        if (videoInfo.nfoStatus != FILE_FORMAT_MATCH || videoInfo.videoDetail.uniqueid.count("tmdb") == 0) {
+            continue;
+        }
+        const VideoDetail &videoDetail = videoInfo.videoDetail;
+        tvIds[videoInfo.videoPath]     = i;
+        m_tvUpdateScheduler.Observe(videoInfo.videoPath,
+                                    videoDetail.episodePaths.size(),
+                                    videoDetail.episodeNfoCount != videoDetail.episodePaths.size(),
+                                    now);
+    }
 
     TMDBAPI api;
     LOG_DEBUG("Search for new episodes...");
-    for (auto &videoInfo : m_videoInfos.at(TV)) {
-        // TODO: 当前无法正确判断剧集是否连载/完结
-        if (videoInfo.nfoStatus == FILE_FORMAT_MATCH &&
-            videoInfo.videoDetail.episodeNfoCount != videoInfo.videoDetail.episodePaths.size()) {
-            LOG_INFO("Try to auto update tv info {}...", videoInfo.videoPath);
-            if (!api.UpdateTV(videoInfo)) {
-                LOG_ERROR("Failed to update TV: {}", videoInfo.videoPath);
-            }
+    for (const auto &path : m_tvUpdateScheduler.PopDue(now)) {
+        auto iter = tvIds.find(path);
+        if (iter == tvIds.end()) {
+            m_tvUpdateScheduler.Remove(path);
+            continue;
+        }
+
+        // 任务取消时剩余的剧保持到期状态, 下次立即检查
+        if (cancelled.load()) {
+            m_tvUpdateScheduler.Reschedule(path, now);
+            continue;
+        }
+
+        // 上游不可用或者更新失败时稍后重试
+        if (!TMDBAPI::IsUpstreamAvailable()) {
+            m_tvUpdateScheduler.Reschedule(path, now + TVUpdateScheduler::MIN_INTERVAL);
+            continue;
+        }
+
+        // 与同一部剧的手动刮削互斥, 在锁内读取最新的信息
+        const VideoId                id = snapshot->IdAt(iter->second);
+        std::unique_lock<std::mutex> entryLocker(m_entryLocks.Of(id));
+        VideoInfo                    videoInfo;
+        AiringInfo                   airingInfo;
+        if (!LatestVideoInfo(TV, id, videoInfo) || videoInfo.videoDetail.uniqueid.count("tmdb") == 0) {
+            m_tvUpdateScheduler.Remove(path);
+            continue;
+        }
+        LOG_INFO("Try to auto update tv info {}...", path);
+        if (!api.UpdateTV(videoInfo) || !api.GetAiringInfo(videoInfo.videoDetail.uniqueid.at("tmdb"), airingInfo)) {
+            LOG_ERROR("Failed to update TV: {}", path);
+            m_tvUpdateScheduler.Reschedule(path, now + TVUpdateScheduler::MIN_INTERVAL);
+            continue;
+        }
+
+        videoInfo.videoDetail.isEnded = airingInfo.isEnded;
+        UpdateLibrary(TV, id, videoInfo);
+        entryLocker.unlock();
+
+        std::time_t nextCheckTime = TVUpdateScheduler::NextCheckTime(airingInfo, LatestEpisodeTime(videoInfo), now);
+        m_tvUpdateScheduler.Reschedule(path, nextCheckTime);
+        if (nextCheckTime > 0) {
+            LOG_DEBUG("Next check of {} after {}s ({})", path, nextCheckTime - now, airingInfo.status);
+        } else {
+            LOG_INFO("TV {} is {}, stop checking until new episodes appear", path, airingInfo.status);
         }
     }
-    LOG_DEBUG("Search finished.");
+    LOG_DEBUG("Search finished, {} tv shows scheduled.", m_tvUpdateScheduler.ScheduledCount());
 }
 
-void ApiManager::RefreshMovie()
+void ApiManager::RefreshMovie(const JobScheduler::CancelFlag &cancelled)
 {
-    if (m_videoInfos.at(MOVIE).empty()) {
+    LibrarySnapshotPtr snapshot = m_library.Snapshot(MOVIE);
+    if (snapshot->videoInfos.empty()) {
         LOG_WARN("Empty movie in datasource, scan first or add new!");
         return;
     }
 
-    std::unique_lock<std::mutex> locker(m_scanInfos.at(MOVIE).lock, std::try_to_lock);
-
     LOG_DEBUG("Refreshing movie nfos...");
     std::vector<std::string> failedVec;
     std::vector<std::string> nfoMisVec;
@@ -414,7 +1376,8 @@ void ApiManager::RefreshMovie()
     int failedCount = 0;
     int nfoMisCount = 0;
 
-    for (auto &videoInfo : m_videoInfos.at(MOVIE)) {
+    for (std::size_t index = 0; index < snapshot->videoInfos.size(); index++) {
+        VideoInfo videoInfo = *snapshot->videoInfos[index];
         if (videoInfo.nfoStatus != FILE_FORMAT_MATCH) {
             LOG_DEBUG("Nfo file incorrect, skipped: {}", videoInfo.videoPath);
             nfoMisCount++;
@@ -422,19 +1385,40 @@ void ApiManager::RefreshMovie()
             continue;
         }
 
+        if (cancelled.load()) {
+            LOG_WARN("Refresh movie nfos cancelled.");
+            break;
+        }
+
+        // 上游熔断时后续条目必然失败, 提前终止
+        if (!TMDBAPI::IsUpstreamAvailable()) {
+            LOG_WARN("TMDB is unavailable, stop refreshing movie nfos.");
+            break;
+        }
+
+        // 与同一视频的手动刮削互斥, 在锁内重新读取, 刷新开始后手动刮削的结果不会被覆盖
+        const VideoId                id = snapshot->IdAt(index);
+        std::unique_lock<std::mutex> entryLocker(m_entryLocks.Of(id));
+        if (!LatestVideoInfo(MOVIE, id, videoInfo) || videoInfo.videoDetail.uniqueid.count("tmdb") == 0) {
+            failedVec.push_back(videoInfo.videoPath);
+            continue;
+        }
+
         // TODO: API接口调整
         TMDBAPI api;
         if (!api.ScrapeMovie(videoInfo, videoInfo.videoDetail.uniqueid.at("tmdb"))) {
             failedVec.push_back(videoInfo.videoPath);
             continue;
         }
+        UpdateLibrary(MOVIE, id, videoInfo);
+        entryLocker.unlock();
         successCount++;
         std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        LOG_INFO("Progress:\t{}/{}", successCount + failedCount + nfoMisCount, m_videoInfos.at(MOVIE).size());
+        LOG_INFO("Progress:\t{}/{}", successCount + failedCount + nfoMisCount, snapshot->videoInfos.size());
     }
 
     printf("Movie refresh summary:\n\tTotal: %lu\n\tSuccess: %d\n\tFailed: %d\n\tNfoMis: %d\n",
-           m_videoInfos.at(MOVIE).size(),
+           snapshot->videoInfos.size(),
            successCount,
            failedCount,
            nfoMisCount);
@@ -449,15 +1433,14 @@ void ApiManager::RefreshMovie()
     LOG_DEBUG("Refresh movie nfos finished.");
 }
 
-void ApiManager::RefreshTV()
+void ApiManager::RefreshTV(const JobScheduler::CancelFlag &cancelled)
 {
-    if (m_videoInfos.at(TV).empty()) {
+    LibrarySnapshotPtr snapshot = m_library.Snapshot(TV);
+    if (snapshot->videoInfos.empty()) {
         LOG_WARN("Empty tv show in datasource, scan first or add new!");
         return;
     }
 
-    std::unique_lock<std::mutex> locker(m_scanInfos.at(TV).lock, std::try_to_lock);
-
     LOG_DEBUG("Refreshing tv nfos...");
     std::vector<std::string> failedVec;
     std::vector<std::string> nfoMisVec;
@@ -465,7 +1448,8 @@ void ApiManager::RefreshTV()
     int                      failedCount  = 0;
     int                      nfoMisCount  = 0;
 
-    for (auto &videoInfo : m_videoInfos.at(TV)) {
+    for (std::size_t index = 0; index < snapshot->videoInfos.size(); index++) {
+        VideoInfo videoInfo = *snapshot->videoInfos[index];
         if (videoInfo.nfoStatus != FILE_FORMAT_MATCH) {
             LOG_DEBUG("Nfo file incorrect, skipped: {}", videoInfo.videoPath);
             nfoMisCount++;
@@ -473,22 +1457,42 @@ void ApiManager::RefreshTV()
             continue;
         }
 
+        if (cancelled.load()) {
+            LOG_WARN("Refresh tv nfos cancelled.");
+            break;
+        }
+
+        if (!TMDBAPI::IsUpstreamAvailable()) {
+            LOG_WARN("TMDB is unavailable, stop refreshing tv nfos.");
+            break;
+        }
+
         LOG_DEBUG("Refreshing TV nfo: {}", videoInfo.videoPath);
 
+        // 与同一部剧的手动刮削互斥, 在锁内重新读取
+        const VideoId                id = snapshot->IdAt(index);
+        std::unique_lock<std::mutex> entryLocker(m_entryLocks.Of(id));
+        if (!LatestVideoInfo(TV, id, videoInfo)) {
+            failedVec.push_back(videoInfo.videoPath);
+            continue;
+        }
+
         // TODO: API接口调整
         TMDBAPI api;
         if (!api.ScrapeTV(videoInfo, videoInfo.videoDetail.uniqueid["tmdb"], videoInfo.videoDetail.seasonNumber, true)) {
             failedVec.push_back(videoInfo.videoPath);
             continue;
         }
+        UpdateLibrary(TV, id, videoInfo);
+        entryLocker.unlock();
 
         successCount++;
         std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        LOG_INFO("\nProgress:\t{}/{}", successCount + failedCount + nfoMisCount, m_videoInfos.at(TV).size());
+        LOG_INFO("\nProgress:\t{}/{}", successCount + failedCount + nfoMisCount, snapshot->videoInfos.size());
     }
 
     printf("TV refresh summary:\n\tTotal: %lu\n\tSuccess: %d\n\tFailed: %d\n\tNfoMis: %d\n",
-           m_videoInfos.at(TV).size(),
+           snapshot->videoInfos.size(),
            successCount,
            failedCount,
            nfoMisCount);
@@ -508,21 +1512,93 @@ void ApiManager::RefreshTV()
 }
 
 void ApiManager::InterLog(const Poco::JSON::Object&, std::ostream& out)
+{
+    JsonWriter writer(out);
+    writer.StartObject();
+    writer.Field("success", true);
+    writer.Key("interlog").StartArray();
+    for (const auto &log : Logger::Instance().GetInterLog()) {
+        writer.Value(log);
+    }
+    writer.EndArray();
+    writer.EndObject();
+}
+
+void ApiManager::Version(const Poco::JSON::Object &, std::ostream &out)
 {
     Poco::JSON::Object jsonObj;
     jsonObj.set("success", true);
-    jsonObj.set("interlog", Logger::Instance().GetInterLog());
+    jsonObj.set("version", VERSION);
     jsonObj.stringify(out);
 }
 
-void ApiManager::Version(const Poco::JSON::Object &, std::ostream &out)
+void ApiManager::UpstreamStats(const Poco::JSON::Object &, std::ostream &out)
 {
     Poco::JSON::Object jsonObj;
+    Poco::JSON::Object statsObj;
+    for (const auto &item : API_URL_TYPE_TO_STR) {
+        const LatencyHistogram &histogram = TMDBAPI::GetLatencyHistogram(item.first);
+
+        Poco::JSON::Object statObj;
+        statObj.set("count", histogram.Count());
+        statObj.set("p50", histogram.Percentile(50));
+        statObj.set("p95", histogram.Percentile(95));
+        statObj.set("p99", histogram.Percentile(99));
+        statsObj.set(item.second, statObj);
+    }
+    Poco::JSON::Object circuitObj;
+    circuitObj.set("api", CircuitBreaker::StateToStr(TMDBAPI::GetCircuitBreaker(GET_MOVIE_DETAIL).GetState()));
+    circuitObj.set("image", CircuitBreaker::StateToStr(TMDBAPI::GetCircuitBreaker(IMAGE_DOWNLOAD).GetState()));
     jsonObj.set("success", true);
-    jsonObj.set("version", VERSION);
+    jsonObj.set("stats", statsObj);
+    jsonObj.set("circuit", circuitObj);
+    jsonObj.set("notFoundCacheSize", TMDBAPI::GetNegativeCache().Size());
     jsonObj.stringify(out);
 }
 
+void ApiManager::MemoryStats(const Poco::JSON::Object &, std::ostream &out)
+{
+    JsonWriter writer(out);
+    writer.StartObject();
+    writer.Field("success", true);
+    writer.Key("library").StartArray();
+    for (auto videoType : {MOVIE, MOVIE_SET, TV}) {
+        LibraryMemoryStats stats = m_library.MemoryStats(videoType);
+        writer.StartObject();
+        writer.Field("VideoType", VIDEO_TYPE_TO_STR.at(videoType));
+        writer.Field("Titles", stats.titles);
+        writer.Field("Bytes", stats.bytes);
+        writer.Field("BytesPerTitle", stats.titles == 0 ? 0 : stats.bytes / stats.titles);
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    std::size_t poolCount = 0;
+    std::size_t poolBytes = 0;
+    StringPool::Instance().Stats(poolCount, poolBytes);
+    writer.Key("stringPool").StartObject();
+    writer.Field("Count", poolCount);
+    writer.Field("Bytes", poolBytes);
+    writer.EndObject();
+
+    std::size_t nodeCount = 0;
+    std::size_t nodeBytes = 0;
+    PathTable::Instance().Stats(nodeCount, nodeBytes);
+    writer.Key("pathTable").StartObject();
+    writer.Field("Count", nodeCount);
+    writer.Field("Bytes", nodeBytes);
+    writer.EndObject();
+
+    std::size_t detailCount = 0;
+    std::size_t detailBytes = 0;
+    m_detailCache.Stats(detailCount, detailBytes);
+    writer.Key("detailCache").StartObject();
+    writer.Field("Count", detailCount);
+    writer.Field("Bytes", detailBytes);
+    writer.EndObject();
+    writer.EndObject();
+}
+
 void ApiManager::Quit(const Poco::JSON::Object &, std::ostream &out)
 {
     Poco::JSON::Object jsonObj;
@@ -534,3 +1610,73 @@ bool ApiManager::IsQuitting()
 {
     return m_isQuitting.load();
 }
+
+void ApiManager::Drain()
+{
+    // 唤醒/api/events的订阅者, 释放其占用的HTTP工作线程
+    EventBus::Instance().Close();
+    m_jobScheduler.Drain();
+    TMDBAPI::Drain();
+}
+
+Poco::JSON::Object ApiManager::JobInfoToJson(const JobInfo &info)
+{
+    auto formatTime = [](std::time_t time) {
+        Poco::LocalDateTime localTime(Poco::DateTime(Poco::Timestamp::fromEpochTime(time)));
+        return Poco::DateTimeFormatter::format(localTime, "%Y-%m-%d %H:%M:%S");
+    };
+
+    Poco::JSON::Object jobJsonObj;
+    jobJsonObj.set("id", info.id);
+    jobJsonObj.set("name", info.name);
+    jobJsonObj.set("priority", JobScheduler::PriorityToStr(info.priority));
+    jobJsonObj.set("status", JobScheduler::StatusToStr(info.status));
+    jobJsonObj.set("submitTime", formatTime(info.submitTime));
+    if (info.beginTime != 0) {
+        jobJsonObj.set("beginTime", formatTime(info.beginTime));
+    }
+    if (info.endTime != 0) {
+        jobJsonObj.set("endTime", formatTime(info.endTime));
+    }
+    if (info.cancelling && info.status == JOB_RUNNING) {
+        jobJsonObj.set("cancelling", true);
+    }
+    if (!info.msg.empty()) {
+        jobJsonObj.set("msg", info.msg);
+    }
+    return jobJsonObj;
+}
+
+void ApiManager::Jobs(const Poco::JSON::Object &param, std::ostream &out)
+{
+    Poco::JSON::Object outJsonObj;
+    if (param.isNull("id")) {
+        Poco::JSON::Array jobsJsonArr;
+        for (const auto &info : m_jobScheduler.List()) {
+            jobsJsonArr.add(JobInfoToJson(info));
+        }
+        outJsonObj.set("success", true);
+        outJsonObj.set("list", jobsJsonArr);
+        outJsonObj.stringify(out);
+        return;
+    }
+
+    Poco::UInt64 jobId = 0;
+    if (!Poco::NumberParser::tryParseUnsigned64(param.getValue<std::string>("id"), jobId)) {
+        out << R"({"success": false, "msg": "Job id is invalid!"})";
+        return;
+    }
+    if (param.optValue("cancel", false) && !m_jobScheduler.Cancel(jobId)) {
+        out << R"({"success": false, "msg": "Job is not found or already finished!"})";
+        return;
+    }
+
+    JobInfo info;
+    if (!m_jobScheduler.Get(jobId, info)) {
+        out << R"({"success": false, "msg": "Job is not found or expired!"})";
+        return;
+    }
+    outJsonObj.set("success", true);
+    outJsonObj.set("job", JobInfoToJson(info));
+    outJsonObj.stringify(out);
+}
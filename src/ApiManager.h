@@ -3,12 +3,22 @@
 #include <atomic>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <mutex>
 
 #include <Poco/JSON/Object.h>
 #include <Poco/LocalDateTime.h>
 
+#include "AutoMatcher.h"
+#include "DataConvert.h"
 #include "DataSource.h"
+#include "DetailCache.h"
+#include "JobScheduler.h"
+#include "JsonFragmentCache.h"
+#include "Library.h"
+#include "LibraryQuery.h"
+#include "StripedMutex.h"
+#include "TVUpdateScheduler.h"
 
 class ApiManager
 {
@@ -23,19 +33,21 @@ class ApiManager
      *
      */
     struct ScanInfo {
-        ScanInfo() : scanStatus(NEVER_SCANNED)
+        ScanInfo() : scanStatus(NEVER_SCANNED), foundVideoNum(0), processedVideoNum(0)
         {
             // non-param constructor
         }
 
         ScanInfo(const ScanInfo &other)
-            : scanStatus(other.scanStatus), scanBeginTime(other.scanBeginTime), scanEndTime(other.scanEndTime),
-              clientAddr(other.clientAddr)
+            : scanStatus(other.scanStatus), foundVideoNum(other.foundVideoNum.load()),
+              processedVideoNum(other.processedVideoNum.load()), scanBeginTime(other.scanBeginTime),
+              scanEndTime(other.scanEndTime), clientAddr(other.clientAddr)
         {
             // copy constructor
         }
 
         ScanSatus                scanStatus;
+        std::atomic<std::size_t> foundVideoNum;
         std::atomic<std::size_t> processedVideoNum;
         Poco::LocalDateTime      scanBeginTime;
         Poco::LocalDateTime      scanEndTime;
@@ -72,9 +84,58 @@ class ApiManager
         std::mutex          lock;
     };
 
+    enum BatchItemStatus {
+        BATCH_ITEM_PENDING,
+        BATCH_ITEM_RUNNING,
+        BATCH_ITEM_SUCCESS,
+        BATCH_ITEM_FAILED,
+        BATCH_ITEM_REVIEW, // 自动匹配的置信度不足, 等待人工确认
+    };
+
+    /**
+     * @brief 批量刮削中的单个条目
+     *
+     */
+    struct BatchItem {
+        VideoType       videoType            = UNKNOWN_TYPE;       // 视频类型
+        VideoId         id                   = 0;                  // 视频ID
+        int             tmdbId               = 0;                  // TMDB的ID
+        int             seasonId             = 0;                  // 季编号, 仅电视剧有效
+        bool            forceUseOnlineTvMeta = false;              // 是否强制使用在线的剧集信息
+        BatchItemStatus status               = BATCH_ITEM_PENDING; // 刮削状态
+        std::string     msg;                                       // 刮削结果的说明
+        std::string     videoPath;                                 // 视频路径, 仅自动匹配时记录
+    };
+
+    /**
+     * @brief 批量刮削任务
+     *
+     */
+    struct BatchJob {
+        uint64_t               jobId       = 0; // 任务ID, 即调度器中的任务ID
+        std::size_t            finishedNum = 0; // 已完成的条目数
+        std::vector<BatchItem> items;           // 所有条目
+        Poco::LocalDateTime    beginTime;       // 开始时间
+        Poco::LocalDateTime    endTime;         // 结束时间
+        std::string            clientAddr;      // 客户端地址
+        std::mutex             lock;            // 任务状态的锁
+    };
+
+    /**
+     * @brief 待人工确认的自动匹配结果
+     *
+     */
+    struct ReviewEntry {
+        VideoType           videoType = UNKNOWN_TYPE; // 视频类型
+        VideoId             id        = 0;            // 视频ID
+        MatchResult         matchResult;              // 自动匹配的结果
+        Poco::LocalDateTime addTime;                  // 加入队列的时间
+    };
+
 public:
 
     using ApiHandler = std::function<void(const Poco::JSON::Object &, std::ostream &)>;
+    using ExportFunc = std::function<void(std::ostream &)>;
 
     static ApiManager &Instance()
     {
@@ -89,19 +150,147 @@ public:
     bool IsQuitting();
 
     void ProcessScan(VideoType videoType, bool forceDetectHdr);
+
+    /**
+     * @brief 提交扫描任务到任务调度器, 同一视频类型的扫描/刷新任务同时只能有一个
+     *
+     * @param param API请求参数, 需要videoType, 可选forceDetectHdr
+     * @param out API响应回填输出流, 成功时包含任务ID
+     */
     void Scan(const Poco::JSON::Object &param, std::ostream &out);
     void ScanResult(const Poco::JSON::Object&, std::ostream &out);
+
+    /**
+     * @brief 获取视频列表, 支持过滤, 排序与分页
+     *
+     * @param param API请求参数, 需要videoType; 可选status(all/complete/incomplete), hdr(HDR类型), genre(分类),
+     *              country(国家), studio(制片厂), hasArtwork(是否有海报), sort(id/title/premiered/rating/added),
+     *              order(asc/desc), limit(单页条目数, 不指定时返回所有条目), cursor(上一页返回的nextCursor)
+     * @param out API响应回填输出流, 包含满足过滤条件的总数total, 有下一页时包含nextCursor
+     */
     void List(const Poco::JSON::Object &param, std::ostream &out);
+
+    /**
+     * @brief 获取分面统计: 满足过滤条件的视频中, 各个字段(status, nfoStatus, posterStatus, hdr, genre, country,
+     *        studio)的每个取值对应的视频数量
+     *
+     * @param param API请求参数, 需要videoType; 过滤参数与List相同
+     * @param out API响应回填输出流
+     */
+    void Facets(const Poco::JSON::Object &param, std::ostream &out);
+
+    /**
+     * @brief 全文搜索标题, 原始标题, 演员, 导演和制片厂
+     *
+     * @param param API请求参数, 需要videoType和q(查询字符串); 可选limit(返回的条目数, 默认20)
+     * @param out API响应回填输出流, 包含命中的总数total, list按相关度降序排列
+     */
+    void Search(const Poco::JSON::Object &param, std::ostream &out);
+
+    /**
+     * @brief 获取客户端已同步的版本之后变化的视频, 用于增量同步列表
+     *
+     * 客户端以List返回的epoch与version作为起点, 之后以本接口返回的epoch与version继续同步.
+     * 返回的每个视频包含id与removed, 未删除的视频另外包含completed(元数据是否完整)与List中的简要信息.
+     * 版本号已超出变更日志保留的范围, 或者epoch不一致(服务重启)时, resync为true, 客户端需要重新获取List.
+     *
+     * @param param API请求参数, 需要videoType和since(已同步到的版本号); 可选epoch
+     * @param out API响应回填输出流
+     */
+    void Changes(const Poco::JSON::Object &param, std::ostream &out);
     void Detail(const Poco::JSON::Object &param, std::ostream &out);
+
+    /**
+     * @brief 准备导出视频的完整详情, 每个视频一行JSON(NDJSON), 内容与Detail相同
+     *
+     * 参数在返回前校验, 导出的视频取自调用时的快照. 导出函数逐条从NFO加载并写入, 内存占用与视频数无关.
+     *
+     * @param param API请求参数, 需要videoType; 过滤参数与List相同
+     * @param out 参数无效时回填错误响应
+     * @return ExportFunc 向输出流写入NDJSON的函数, 参数无效时为空
+     */
+    ExportFunc Export(const Poco::JSON::Object &param, std::ostream &out);
+
+    /**
+     * @brief 获取媒体库当前快照的ETag, 用于List与Detail的304响应
+     *
+     * 快照发布(扫描/刮削)后ETag随版本号变化, 未变化时客户端缓存的响应仍然有效.
+     *
+     * @param param API请求参数, 需要videoType
+     * @return std::string ETag, 参数无效时为空
+     */
+    std::string LibraryETag(const Poco::JSON::Object &param);
     void Scrape(const Poco::JSON::Object &param, std::ostream &out);
+
+    /**
+     * @brief 提交批量刮削任务, 立即返回任务ID, 条目在后台执行
+     *
+     * @param param API请求参数, items为条目数组(POST的JSON内容)或者条目数组的JSON字符串(查询参数)
+     * @param out API响应回填输出流
+     */
+    void ScrapeBatch(const Poco::JSON::Object &param, std::ostream &out);
+
+    /**
+     * @brief 查询批量刮削任务的进度与各条目的结果
+     *
+     * @param param API请求参数, 需要jobId
+     * @param out API响应回填输出流
+     */
+    void ScrapeBatchResult(const Poco::JSON::Object &param, std::ostream &out);
+
+    /**
+     * @brief 对没有NFO的视频自动匹配TMDB条目, 置信度足够时直接刮削, 否则加入待确认队列
+     *
+     * 任务在后台执行, 返回的任务ID可以通过ScrapeBatchResult查询进度.
+     *
+     * @param param API请求参数, 需要videoType
+     * @param out API响应回填输出流
+     */
+    void AutoMatch(const Poco::JSON::Object &param, std::ostream &out);
+
+    /**
+     * @brief 获取待人工确认的自动匹配结果, 通过Scrape指定TMDB ID刮削成功后自动移出队列
+     *
+     * @param param API请求参数, 可选videoType过滤视频类型, 可选dismiss指定要移出队列的视频路径
+     * @param out API响应回填输出流
+     */
+    void ReviewQueue(const Poco::JSON::Object &param, std::ostream &out);
     void Refresh(const Poco::JSON::Object &param, std::ostream &out);
     void Quit(const Poco::JSON::Object &, std::ostream &out);
-    void AutoUpdateTV();
 
-    void ProcessRefresh(VideoType videoType);
+    /**
+     * @brief 查询或取消后台任务(扫描/刷新/自动更新)
+     *
+     * @param param API请求参数, 不指定id时列出所有任务; 指定id时返回该任务, 同时指定cancel=true时取消该任务
+     * @param out API响应回填输出流
+     */
+    void Jobs(const Poco::JSON::Object &param, std::ostream &out);
+
+    /**
+     * @brief 以后台优先级提交电视剧的自动更新任务(扫描后检查新剧集)
+     *
+     * @return true 提交成功
+     * @return false 电视剧正在扫描/刷新, 或者任务队列已满
+     */
+    bool SubmitAutoUpdate();
+
+    /**
+     * @brief 停止接收新任务, 等待正在执行的任务在安全的位置退出, 退出前调用
+     *
+     */
+    void Drain();
+
+    /**
+     * @brief 检查到期的电视剧是否有新剧集, 检查时间由TVUpdateScheduler按照播出计划安排
+     *
+     * @param cancelled 任务的取消标记, 在两部剧之间检查
+     */
+    void AutoUpdateTV(const JobScheduler::CancelFlag &cancelled);
+
+    void ProcessRefresh(VideoType videoType, const JobScheduler::CancelFlag &cancelled);
     void RefreshResult(const Poco::JSON::Object &, std::ostream &out);
-    void RefreshMovie();
-    void RefreshTV();
+    void RefreshMovie(const JobScheduler::CancelFlag &cancelled);
+    void RefreshTV(const JobScheduler::CancelFlag &cancelled);
 
     /**
      * @brief 获取内部日志
@@ -113,17 +302,165 @@ public:
 
     void Version(const Poco::JSON::Object &param, std::ostream &out);
 
+    /**
+     * @brief 获取TMDB各个API的请求耗时统计(毫秒), 没有样本时分位数为-1
+     *
+     * @param param API请求参数
+     * @param out API响应回填输出流
+     */
+    void UpstreamStats(const Poco::JSON::Object &param, std::ostream &out);
+
+    /**
+     * @brief 获取媒体库的内存占用(估算): 各类型的视频数, 总字节数与每个视频的平均字节数, 以及驻留字符串池, 目录表与详情缓存的大小
+     *
+     * @param param API请求参数
+     * @param out API响应回填输出流
+     */
+    void MemoryStats(const Poco::JSON::Object &param, std::ostream &out);
+
 private:
 
+    /**
+     * @brief 从NFO加载视频的完整详情, 用于详情缓存
+     *
+     * @param videoInfo 简要信息的副本, 加载成功时填写完整详情
+     * @return true 加载成功
+     * @return false 没有格式匹配的NFO或者解析失败, 使用简要信息
+     */
+    static bool LoadVideoDetail(VideoInfo &videoInfo);
+
+    /**
+     * @brief 解析List, Facets与Export共用的过滤参数
+     *
+     * @param param API请求参数
+     * @param query 输出过滤条件
+     * @param out 参数无效时回填错误响应
+     * @return true 解析成功
+     * @return false 参数无效
+     */
+    bool ParseListFilter(const Poco::JSON::Object &param, ListQuery &query, std::ostream &out);
+
+    /**
+     * @brief 刮削单个视频, 在副本上刮削, 成功后发布到媒体库的新快照
+     *
+     * @param videoType 视频类型
+     * @param id 视频ID
+     * @param tmdbId TMDB的ID
+     * @param seasonId 季编号, 仅电视剧有效
+     * @param forceUseOnlineTvMeta 是否强制使用在线的剧集信息
+     * @param msg 成功时为视频标题, 失败时为失败原因
+     * @return true 刮削成功
+     * @return false 刮削失败
+     */
+    bool ScrapeOne(VideoType    videoType,
+                   VideoId      id,
+                   int          tmdbId,
+                   int          seasonId,
+                   bool         forceUseOnlineTvMeta,
+                   std::string &msg);
+
+    /**
+     * @brief 将批量任务中尚未开始的条目标记为失败, 全部条目结束时记录结束时间
+     *
+     * @param job 批量任务
+     * @param msg 失败原因
+     */
+    static void FailPendingItems(BatchJob &job, const std::string &msg);
+
+    /**
+     * @brief 在后台线程中执行批量刮削的单个条目
+     *
+     * @param job 批量刮削任务
+     * @param index 条目的下标
+     */
+    void ProcessBatchItem(std::shared_ptr<BatchJob> job, std::size_t index);
+
+    /**
+     * @brief 在后台线程中执行自动匹配的单个条目
+     *
+     * @param job 自动匹配任务
+     * @param index 条目的下标
+     * @param firstEpisodePath 电视剧第一集的路径, 电影为空
+     */
+    void ProcessAutoMatchItem(std::shared_ptr<BatchJob> job, std::size_t index, const std::string &firstEpisodePath);
+
+    /**
+     * @brief 将批量任务提交到任务调度器并登记, 任务执行时由独立的执行器并发执行条目, 被取消时其余条目标记为失败
+     *
+     * @param name 任务名称
+     * @param job 批量任务, 成功时设置其ID
+     * @param process 单个条目的执行函数, 参数为条目的下标
+     * @return true 提交成功
+     * @return false 同时进行的批量任务过多或者调度器的队列已满
+     */
+    bool SubmitBatchJob(const std::string                      &name,
+                        std::shared_ptr<BatchJob>               job,
+                        const std::function<void(std::size_t)> &process);
+
+    /**
+     * @brief 提交媒体库的任务, 同一视频类型的扫描/刷新/自动更新任务互斥
+     *
+     * @param name 任务名称
+     * @param videoType 视频类型
+     * @param priority 优先级
+     * @param func 执行函数
+     * @param out API响应回填输出流
+     */
+    void SubmitLibraryJob(const std::string    &name,
+                          VideoType             videoType,
+                          JobPriority           priority,
+                          JobScheduler::JobFunc func,
+                          std::ostream         &out);
+
+    static Poco::JSON::Object JobInfoToJson(const JobInfo &info);
+
+    /**
+     * @brief 推送扫描进度事件, 内容与ScanResult的条目相同
+     *
+     * @param videoType 视频类型
+     * @param scanStatus 扫描状态
+     */
+    void PublishScanProgress(VideoType videoType, ScanSatus scanStatus);
+
+    /**
+     * @brief 推送媒体库变化事件, 包含新快照的epoch与version, 客户端据此通过Changes增量同步
+     *
+     * @param videoType 视频类型
+     */
+    void PublishLibraryChange(VideoType videoType);
+
+    /**
+     * @brief 推送任务状态变化事件, 由任务调度器在状态变化时回调
+     *
+     * @param info 任务的状态
+     */
+    static void PublishJobStatus(const JobInfo &info);
+
+    /**
+     * @brief 从当前快照中读取视频的最新信息, 刮削前应先持有该视频的条目锁
+     *
+     * @param videoType 视频类型
+     * @param id 视频ID
+     * @param videoInfo 输出视频信息的副本
+     * @return true 读取成功
+     * @return false 视频已被重新扫描移除
+     */
+    bool LatestVideoInfo(VideoType videoType, VideoId id, VideoInfo &videoInfo);
+
+    /**
+     * @brief 发布单个视频的刮削/更新结果到媒体库, 并推送媒体库变化事件
+     *
+     * @param videoType 视频类型
+     * @param id 视频ID
+     * @param videoInfo 完整的视频信息
+     * @return true 发布成功
+     * @return false 视频已被重新扫描移除
+     */
+    bool UpdateLibrary(VideoType videoType, VideoId id, const VideoInfo &videoInfo);
+
     ApiManager()
     {
         // 初始化map
-        m_videoInfos = {
-            {MOVIE, std::vector<VideoInfo>()},
-            {MOVIE_SET, std::vector<VideoInfo>()},
-            {TV, std::vector<VideoInfo>()},
-        };
-
         m_scanInfos = {
             {MOVIE, ScanInfo()},
             {MOVIE_SET, ScanInfo()},
@@ -140,9 +477,44 @@ private:
 private:
 
     std::map<VideoType, std::vector<std::string>> m_paths;
-    std::map<VideoType, std::vector<VideoInfo>>   m_videoInfos;
     std::map<VideoType, ScanInfo>                 m_scanInfos;
     std::map<VideoType, RefreshInfo>              m_refreshInfos;
+    Library                                       m_library; // 媒体库的快照, 读取无需加锁
+
+    // 视频信息序列化后的JSON片段, 视频信息被替换后自动失效
+    JsonFragmentCache m_fragmentCache{VideoInfoToBriefJsonStr, VideoInfoToDetailedJsonStr};
+
+    // 按需从NFO加载的完整详情, 快照中只保存简要信息
+    DetailCache m_detailCache{LoadVideoDetail, DETAIL_CACHE_BYTES};
 
     std::atomic<bool> m_isQuitting{false}; // 是否正在退出
+
+    static const std::size_t BATCH_MAX_ITEMS      = 200;             // 单个批量任务的最大条目数
+    static const std::size_t BATCH_MAX_JOBS       = 32;              // 保留的批量任务记录数
+    static const std::size_t BATCH_WORKER_NUM     = 4;               // 单个批量任务并发执行的条目数
+    static const std::size_t BATCH_MAX_ACTIVE     = 2;               // 同时排队或执行的批量任务数
+    static const std::size_t JOB_WORKER_NUM       = 4;               // 扫描/刷新/批量刮削任务的线程数
+    static const std::size_t JOB_QUEUE_SIZE       = 32;              // 扫描/刷新/批量刮削任务的队列容量
+    static const std::size_t LIST_MAX_LIMIT       = 500;             // 列表单页的最大条目数
+    static const std::size_t SEARCH_DEFAULT_LIMIT = 20;              // 搜索默认返回的条目数
+    static const std::size_t DETAIL_CACHE_BYTES   = 8 * 1024 * 1024; // 详情缓存的容量(字节)
+
+    static const int SCAN_PROGRESS_INTERVAL_MS = 500; // 推送扫描进度的间隔(毫秒)
+
+    std::map<uint64_t, std::shared_ptr<BatchJob>> m_batchJobs; // 批量刮削任务, 保存条目的状态
+    std::mutex                                    m_batchLock; // 批量任务记录的锁
+
+    std::map<std::string, ReviewEntry> m_reviewQueue; // 待人工确认的自动匹配结果, 视频路径 -> 匹配结果
+    std::mutex                         m_reviewLock;  // 待确认队列的锁
+
+    TVUpdateScheduler m_tvUpdateScheduler; // 电视剧更新检查的调度
+
+    // 视频条目的分段锁, 以视频ID映射, 同一视频的刮削/刷新/自动更新串行执行, 不同视频互不阻塞.
+    // 类型级别的扫描锁只在扫描(替换整个类型的视频)时持有
+    StripedMutex m_entryLocks;
+
+    // 扫描/刷新/批量刮削/自动匹配等所有后台任务的调度器, 最后声明以保证最先析构,
+    // 析构时取消排队中的任务并等待正在执行的任务退出. 批量任务只占用调度器的一个线程, 其条目由任务内的
+    // TaskExecutor并发执行; TMDB的对冲请求不经过调度器, 由TMDBAPI的执行器发出, 以免排在长任务之后
+    JobScheduler m_jobScheduler{JOB_WORKER_NUM, JOB_QUEUE_SIZE, PublishJobStatus};
 };
\ No newline at end of file
@@ -0,0 +1,347 @@
+#include "ArtworkStore.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include <Poco/DigestStream.h>
+#include <Poco/File.h>
+#include <Poco/FileStream.h>
+#include <Poco/JSON/Object.h>
+#include <Poco/JSON/Parser.h>
+#include <Poco/Path.h>
+#include <Poco/SHA1Engine.h>
+#include <Poco/TemporaryFile.h>
+
+#include "Config.h"
+#include "Logger.h"
+
+const std::string MANIFEST_FILE_NAME  = "manifest.json"; // 仓库记录文件的名称
+const std::string JOURNAL_FILE_NAME   = "manifest.log";  // 仓库日志文件的名称
+const std::string OBJECTS_DIR_NAME    = "objects";       // 仓库对象的目录名称
+const std::size_t JOURNAL_COMPACT_MIN = 256;             // 日志的记录数不少于该值且不少于目标文件数时合并
+
+ArtworkStore& ArtworkStore::Instance()
+{
+    static ArtworkStore inst;
+    return inst;
+}
+
+void ArtworkStore::LoadManifest()
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded    = true;
+    m_storePath = Poco::Path::forDirectory(Config::Instance().GetArtworkStorePath()).toString();
+
+    try {
+        Poco::File(m_storePath + OBJECTS_DIR_NAME).createDirectories();
+    } catch (Poco::Exception& e) {
+        LOG_ERROR("Create artwork store {} failed: {}", m_storePath, e.displayText());
+        return;
+    }
+
+    ReadManifest();
+    ReplayJournal();
+    if (m_journalSize > 0) {
+        Compact();
+    }
+
+    LOG_DEBUG("Artwork store {} loaded, {} objects, {} targets", m_storePath, m_sources.size(), m_targets.size());
+}
+
+void ArtworkStore::ReadManifest()
+{
+    const std::string manifestPath = m_storePath + MANIFEST_FILE_NAME;
+    if (!Poco::File(manifestPath).exists()) {
+        return;
+    }
+
+    try {
+        Poco::FileInputStream   fis(manifestPath);
+        Poco::JSON::Parser      parser;
+        Poco::JSON::Object::Ptr jsonPtr = parser.parse(fis).extract<Poco::JSON::Object::Ptr>();
+
+        auto sourcesJsonPtr = jsonPtr->getObject("sources");
+        if (!sourcesJsonPtr.isNull()) {
+            for (const auto& pair : *sourcesJsonPtr) {
+                m_sources[pair.first] = pair.second.toString();
+            }
+        }
+
+        auto targetsJsonPtr = jsonPtr->getObject("targets");
+        if (!targetsJsonPtr.isNull()) {
+            for (const auto& pair : *targetsJsonPtr) {
+                m_targets[pair.first] = RecordFromJson(pair.second.extract<Poco::JSON::Object::Ptr>());
+            }
+        }
+    } catch (Poco::Exception& e) {
+        LOG_ERROR("Parse artwork manifest {} failed: {}", manifestPath, e.displayText());
+        m_sources.clear();
+        m_targets.clear();
+    }
+}
+
+bool ArtworkStore::SaveManifest()
+{
+    Poco::JSON::Object sourcesJson;
+    for (const auto& pair : m_sources) {
+        sourcesJson.set(pair.first, pair.second);
+    }
+
+    Poco::JSON::Object targetsJson;
+    for (const auto& pair : m_targets) {
+        targetsJson.set(pair.first, RecordToJson(pair.second));
+    }
+
+    Poco::JSON::Object jsonObj;
+    jsonObj.set("sources", sourcesJson);
+    jsonObj.set("targets", targetsJson);
+
+    // 先写临时文件再重命名, 避免写入中途退出导致记录文件损坏
+    const std::string manifestPath = m_storePath + MANIFEST_FILE_NAME;
+    const std::string tempPath     = manifestPath + ".tmp";
+    try {
+        {
+            Poco::FileOutputStream fos(tempPath);
+            jsonObj.stringify(fos);
+        }
+        Poco::File(tempPath).renameTo(manifestPath);
+    } catch (Poco::Exception& e) {
+        LOG_ERROR("Save artwork manifest {} failed: {}", manifestPath, e.displayText());
+        return false;
+    }
+
+    return true;
+}
+
+void ArtworkStore::ReplayJournal()
+{
+    const std::string journalPath = m_storePath + JOURNAL_FILE_NAME;
+    std::ifstream     ifs(journalPath);
+    if (!ifs.is_open()) {
+        return;
+    }
+
+    // 每行一条记录, 后面的记录覆盖前面的记录
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        try {
+            Poco::JSON::Parser      parser;
+            Poco::JSON::Object::Ptr jsonPtr    = parser.parse(line).extract<Poco::JSON::Object::Ptr>();
+            const std::string       targetPath = jsonPtr->getValue<std::string>("target");
+            TargetRecord            record     = RecordFromJson(jsonPtr);
+            m_sources[record.source] = record.hash;
+            m_targets[targetPath]    = record;
+            m_journalSize++;
+        } catch (Poco::Exception& e) {
+            LOG_WARN("Incomplete record in artwork journal {} is ignored: {}", journalPath, e.displayText());
+            break;
+        }
+    }
+}
+
+bool ArtworkStore::AppendJournal(const std::string& targetPath, const TargetRecord& record)
+{
+    Poco::JSON::Object::Ptr recordJsonPtr = RecordToJson(record);
+    recordJsonPtr->set("target", targetPath);
+
+    const std::string journalPath = m_storePath + JOURNAL_FILE_NAME;
+    std::ofstream     ofs(journalPath, std::ios::app);
+    if (!ofs.is_open()) {
+        LOG_ERROR("Failed to open artwork journal {}!", journalPath);
+        return false;
+    }
+    recordJsonPtr->stringify(ofs);
+    ofs << '\n';
+    ofs.flush();
+    if (!ofs.good()) {
+        LOG_ERROR("Write artwork journal {} failed!", journalPath);
+        return false;
+    }
+
+    m_journalSize++;
+    return true;
+}
+
+void ArtworkStore::Compact()
+{
+    // 记录文件保存成功后才清空日志; 两步之间退出时, 重放日志的结果与记录文件相同
+    if (!SaveManifest()) {
+        return;
+    }
+    try {
+        Poco::File journalFile(m_storePath + JOURNAL_FILE_NAME);
+        if (journalFile.exists()) {
+            journalFile.remove();
+        }
+    } catch (Poco::Exception& e) {
+        LOG_ERROR("Remove artwork journal failed: {}", e.displayText());
+        return;
+    }
+    m_journalSize = 0;
+}
+
+ArtworkStore::TargetRecord ArtworkStore::RecordFromJson(const Poco::JSON::Object::Ptr& recordJsonPtr)
+{
+    TargetRecord record;
+    record.source = recordJsonPtr->getValue<std::string>("source");
+    record.hash   = recordJsonPtr->getValue<std::string>("hash");
+    record.size   = recordJsonPtr->getValue<uint64_t>("size");
+    record.mtime  = recordJsonPtr->optValue<int64_t>("mtime", 0); // 旧的记录没有修改时间
+    return record;
+}
+
+Poco::JSON::Object::Ptr ArtworkStore::RecordToJson(const TargetRecord& record)
+{
+    Poco::JSON::Object::Ptr recordJsonPtr = new Poco::JSON::Object;
+    recordJsonPtr->set("source", record.source);
+    recordJsonPtr->set("hash", record.hash);
+    recordJsonPtr->set("size", record.size);
+    recordJsonPtr->set("mtime", record.mtime);
+    return recordJsonPtr;
+}
+
+std::string ArtworkStore::ObjectPath(const std::string& hash, const std::string& extension)
+{
+    // 按照哈希的前两位分目录, 防止单个目录下文件过多
+    return m_storePath + OBJECTS_DIR_NAME + Poco::Path::separator() + hash.substr(0, 2) + Poco::Path::separator() +
+           hash + extension;
+}
+
+bool ArtworkStore::LinkToTarget(const std::string& objectPath, const std::string& targetPath)
+{
+    try {
+        Poco::File targetFile(targetPath);
+        if (targetFile.exists()) {
+            targetFile.remove();
+        }
+        Poco::File(objectPath).linkTo(targetPath, Poco::File::LINK_HARD);
+    } catch (Poco::Exception& e) {
+        LOG_DEBUG("Hard link {} to {} failed({}), fallback to copy", objectPath, targetPath, e.displayText());
+        try {
+            Poco::File(objectPath).copyTo(targetPath);
+        } catch (Poco::Exception& copyErr) {
+            LOG_ERROR("Copy {} to {} failed: {}", objectPath, targetPath, copyErr.displayText());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::string ArtworkStore::Fetch(const std::string& source, const Downloader& downloader, std::string& hash)
+{
+    const std::string tempPath = Poco::TemporaryFile::tempName(m_storePath + OBJECTS_DIR_NAME);
+
+    // 边下载边计算哈希, 无需再次读取文件
+    Poco::SHA1Engine sha1;
+    {
+        std::ofstream ofs(tempPath, std::ios::binary);
+        if (!ofs.is_open()) {
+            LOG_ERROR("Failed to open file {} to write artwork!", tempPath);
+            return "";
+        }
+        Poco::DigestOutputStream dos(sha1, ofs);
+        if (!downloader(dos, source)) {
+            ofs.close();
+            Poco::File(tempPath).remove();
+            return "";
+        }
+        dos.flush();
+    }
+    hash = Poco::DigestEngine::digestToHex(sha1.digest());
+
+    const std::string objectPath = ObjectPath(hash, Poco::Path(source).getExtension().empty()
+                                                        ? ""
+                                                        : "." + Poco::Path(source).getExtension());
+    try {
+        Poco::File(Poco::Path(objectPath).parent()).createDirectories();
+        if (Poco::File(objectPath).exists()) { // 不同来源的相同内容, 仅保留一份
+            Poco::File(tempPath).remove();
+        } else {
+            Poco::File(tempPath).renameTo(objectPath);
+        }
+    } catch (Poco::Exception& e) {
+        LOG_ERROR("Store artwork {} failed: {}", objectPath, e.displayText());
+        return "";
+    }
+
+    return objectPath;
+}
+
+bool ArtworkStore::Sync(const std::string& targetPath, const std::string& source, const Downloader& downloader)
+{
+    if (source.empty()) {
+        LOG_WARN("Image uri for {} is empty!", targetPath);
+        return false;
+    }
+
+    const std::string extension = Poco::Path(source).getExtension().empty()
+                                      ? ""
+                                      : "." + Poco::Path(source).getExtension();
+    std::string       hash;
+    {
+        std::lock_guard<std::mutex> locker(m_lock);
+        LoadManifest();
+
+        // 目标文件来源未变化且文件未被修改, 直接跳过
+        auto targetIter = m_targets.find(targetPath);
+        if (targetIter != m_targets.end() && targetIter->second.source == source) {
+            Poco::File targetFile(targetPath);
+            if (targetFile.exists() && targetFile.getSize() == targetIter->second.size &&
+                targetFile.getLastModified().epochMicroseconds() == targetIter->second.mtime) {
+                LOG_DEBUG("Artwork {} unchanged, skip downloading {}", targetPath, source);
+                return true;
+            }
+        }
+
+        auto sourceIter = m_sources.find(source);
+        if (sourceIter != m_sources.end() && Poco::File(ObjectPath(sourceIter->second, extension)).exists()) {
+            hash = sourceIter->second;
+        }
+    }
+
+    // 仓库中不存在时才下载, 下载期间不持有锁
+    std::string objectPath;
+    if (hash.empty()) {
+        LOG_DEBUG("Download artwork {} to {}", source, targetPath);
+        objectPath = Fetch(source, downloader, hash);
+        if (objectPath.empty()) {
+            return false;
+        }
+    } else {
+        LOG_DEBUG("Artwork {} found in store, link to {}", source, targetPath);
+        objectPath = ObjectPath(hash, extension);
+    }
+
+    if (!LinkToTarget(objectPath, targetPath)) {
+        return false;
+    }
+
+    // 记录目标文件本身的大小与修改时间, 目标文件被替换(即使大小相同)时重新同步
+    TargetRecord record;
+    record.source = source;
+    record.hash   = hash;
+    try {
+        Poco::File targetFile(targetPath);
+        record.size  = targetFile.getSize();
+        record.mtime = targetFile.getLastModified().epochMicroseconds();
+    } catch (Poco::Exception& e) {
+        LOG_ERROR("Stat artwork {} failed: {}", targetPath, e.displayText());
+        return false;
+    }
+
+    // 只追加日志, 日志的记录数超过目标文件数时才重写记录文件, 使重写的开销均摊为常数
+    std::lock_guard<std::mutex> locker(m_lock);
+    m_sources[source]     = hash;
+    m_targets[targetPath] = record;
+    if (!AppendJournal(targetPath, record) || m_journalSize >= std::max(m_targets.size(), JOURNAL_COMPACT_MIN)) {
+        Compact();
+    }
+
+    return true;
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <Poco/JSON/Object.h>
+
+/**
+ * @brief 按内容寻址的本地图片仓库
+ *
+ * 仓库目录下的objects子目录按照图片内容的SHA1保存图片, 媒体目录中的海报/剧照/标志通过硬链接指向仓库中的对象,
+ * 同一张图片(例如同一部剧的多个季, 或者共用图片的电影)只会下载和存储一次.
+ * manifest.json记录了每个目标文件的来源地址, 内容哈希, 大小与修改时间, 来源和文件均未变化时跳过下载.
+ * 每次同步只向manifest.log追加一条记录, 日志的记录数超过目标文件数时才合并到manifest.json,
+ * 批量刮削时写记录文件的开销均摊到每张图片上为常数.
+ */
+class ArtworkStore
+{
+    /**
+     * @brief 目标文件的同步记录
+     *
+     */
+    struct TargetRecord {
+        std::string source; // 图片的来源地址
+        std::string hash;   // 图片内容的SHA1
+        uint64_t    size;   // 图片的文件大小
+        int64_t     mtime;  // 图片的修改时间, 单位: 微秒
+    };
+
+public:
+
+    /**
+     * @brief 下载函数, 将来源地址的内容写入给定的输出流
+     *
+     */
+    using Downloader = std::function<bool(std::ostream&, const std::string&)>;
+
+    /**
+     * @brief 获取单例
+     *
+     * @return ArtworkStore& 单例
+     */
+    static ArtworkStore& Instance();
+
+    /**
+     * @brief 将来源地址的图片同步到目标文件
+     *
+     * 目标文件已经是同一来源的图片且大小与修改时间均未变化时直接跳过; 仓库中已存在同一来源的图片时硬链接到目标文件;
+     * 否则调用下载函数下载到仓库, 再硬链接到目标文件.
+     *
+     * @param targetPath 目标文件路径
+     * @param source 图片的来源地址
+     * @param downloader 下载函数
+     * @return true 同步成功
+     * @return false 同步失败
+     */
+    bool Sync(const std::string& targetPath, const std::string& source, const Downloader& downloader);
+
+private:
+
+    ArtworkStore() : m_loaded(false), m_journalSize(0) {}
+
+    /**
+     * @brief 加载仓库的记录文件并重放日志(仅首次调用时加载)
+     *
+     */
+    void LoadManifest();
+
+    /**
+     * @brief 读取仓库的记录文件, 文件损坏时清空所有记录
+     *
+     */
+    void ReadManifest();
+
+    /**
+     * @brief 保存仓库的记录文件
+     *
+     * @return true 保存成功
+     * @return false 保存失败
+     */
+    bool SaveManifest();
+
+    /**
+     * @brief 重放日志中的同步记录, 末尾不完整的记录(写入中途退出)被忽略
+     *
+     */
+    void ReplayJournal();
+
+    /**
+     * @brief 向日志追加一条同步记录
+     *
+     * @param targetPath 目标文件路径
+     * @param record 同步记录
+     * @return true 追加成功
+     * @return false 追加失败
+     */
+    bool AppendJournal(const std::string& targetPath, const TargetRecord& record);
+
+    /**
+     * @brief 将所有记录保存到记录文件并清空日志
+     *
+     */
+    void Compact();
+
+    /**
+     * @brief 从JSON对象中读取同步记录, 缺少字段时抛出异常
+     *
+     * @param recordJsonPtr 同步记录的JSON对象
+     * @return TargetRecord 同步记录
+     */
+    static TargetRecord RecordFromJson(const Poco::JSON::Object::Ptr& recordJsonPtr);
+
+    /**
+     * @brief 将同步记录转换为JSON对象
+     *
+     * @param record 同步记录
+     * @return Poco::JSON::Object::Ptr 同步记录的JSON对象
+     */
+    static Poco::JSON::Object::Ptr RecordToJson(const TargetRecord& record);
+
+    /**
+     * @brief 获取仓库中对象的路径
+     *
+     * @param hash 图片内容的SHA1
+     * @param extension 图片的扩展名(含".")
+     * @return std::string 对象的路径
+     */
+    std::string ObjectPath(const std::string& hash, const std::string& extension);
+
+    /**
+     * @brief 将仓库中的对象链接到目标文件, 无法硬链接(如跨文件系统)时复制
+     *
+     * @param objectPath 仓库中对象的路径
+     * @param targetPath 目标文件路径
+     * @return true 成功
+     * @return false 失败
+     */
+    bool LinkToTarget(const std::string& objectPath, const std::string& targetPath);
+
+    /**
+     * @brief 下载图片到仓库中
+     *
+     * @param source 图片的来源地址
+     * @param downloader 下载函数
+     * @param hash 输出图片内容的SHA1
+     * @return std::string 仓库中对象的路径, 失败时为空
+     */
+    std::string Fetch(const std::string& source, const Downloader& downloader, std::string& hash);
+
+private:
+
+    bool                                m_loaded;      // 记录文件是否已加载
+    std::string                         m_storePath;   // 仓库的根目录
+    std::map<std::string, std::string>  m_sources;     // 来源地址 -> 内容SHA1
+    std::map<std::string, TargetRecord> m_targets;     // 目标文件 -> 同步记录
+    std::size_t                         m_journalSize; // 日志中尚未合并的记录数
+    std::mutex                          m_lock;        // 记录的读写锁
+};
@@ -0,0 +1,134 @@
+#include "AutoMatcher.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include "Config.h"
+#include "HDRToolKit.h"
+#include "Logger.h"
+#include "TMDBAPI.h"
+
+const std::size_t MATCH_MAX_CANDIDATES = 5;    // 保留的候选条目数
+const std::size_t MATCH_RUNTIME_CHECKS = 3;    // 需要比较时长的候选条目数
+const double      MATCH_MIN_MARGIN     = 0.1;  // 最佳候选需要领先第二名的得分
+const double      TITLE_WEIGHT         = 0.6;  // 标题相似度的权重
+const double      YEAR_WEIGHT          = 0.25; // 年份的权重
+const double      RUNTIME_WEIGHT       = 0.15; // 时长的权重
+
+double AutoMatcher::YearScore(int parsedYear, int candidateYear)
+{
+    int diff = std::abs(parsedYear - candidateYear);
+    // 上映年份与发布年份可能相差一年
+    return diff == 0 ? 1.0 : (diff == 1 ? 0.5 : 0.0);
+}
+
+double AutoMatcher::RuntimeScore(int durationSec, int runtimeMin)
+{
+    double diffRatio = std::fabs(durationSec / 60.0 - runtimeMin) / runtimeMin;
+    return diffRatio <= 0.1 ? 1.0 : (diffRatio <= 0.25 ? 0.5 : 0.0);
+}
+
+void AutoMatcher::Score(const ParsedMediaName& parsed, int durationSec, MatchCandidate& candidate)
+{
+    double titleScore = 0.0;
+    for (const auto& name : {parsed.title, parsed.altTitle}) {
+        if (!name.empty()) {
+            titleScore = std::max(titleScore, MediaNameParser::TitleSimilarity(name, candidate.title));
+            titleScore = std::max(titleScore, MediaNameParser::TitleSimilarity(name, candidate.originalTitle));
+        }
+    }
+
+    // 未知的项不参与计算, 其余项按照权重归一化
+    double totalScore  = TITLE_WEIGHT * titleScore;
+    double totalWeight = TITLE_WEIGHT;
+    if (parsed.year > 0 && candidate.year > 0) {
+        totalScore += YEAR_WEIGHT * YearScore(parsed.year, candidate.year);
+        totalWeight += YEAR_WEIGHT;
+    }
+    if (durationSec > 0 && candidate.runtime > 0) {
+        totalScore += RUNTIME_WEIGHT * RuntimeScore(durationSec, candidate.runtime);
+        totalWeight += RUNTIME_WEIGHT;
+    }
+    candidate.score = totalScore / totalWeight;
+}
+
+bool AutoMatcher::Match(VideoType          videoType,
+                        const std::string& videoPath,
+                        const std::string& firstEpisodePath,
+                        MatchResult&       result)
+{
+    result        = MatchResult();
+    result.parsed = videoType == TV ? MediaNameParser::ParseTV(videoPath, firstEpisodePath)
+                                    : MediaNameParser::ParseMovie(videoPath);
+    if (result.parsed.title.empty()) {
+        LOG_WARN("No title parsed from {}", videoPath);
+        return false;
+    }
+
+    // 标题和备选标题分别搜索, 带年份搜索无结果时去掉年份重试
+    TMDBAPI                              api;
+    std::map<int, TMDBAPI::SearchResult> searchResults;
+    bool                                 isSearched = false;
+    for (const auto& keywords : {result.parsed.title, result.parsed.altTitle}) {
+        if (keywords.empty()) {
+            continue;
+        }
+        std::vector<TMDBAPI::SearchResult> results;
+        bool                               isSuccess = api.Search(videoType, keywords, result.parsed.year, results);
+        if (isSuccess && results.empty() && result.parsed.year > 0) {
+            isSuccess = api.Search(videoType, keywords, 0, results);
+        }
+        isSearched = isSearched || isSuccess;
+        for (const auto& item : results) {
+            searchResults.insert(std::make_pair(item.tmdbId, item));
+        }
+    }
+    if (!isSearched) {
+        return false;
+    }
+
+    for (const auto& pair : searchResults) {
+        MatchCandidate candidate;
+        candidate.tmdbId        = pair.second.tmdbId;
+        candidate.title         = pair.second.title;
+        candidate.originalTitle = pair.second.originalTitle;
+        candidate.year          = pair.second.year;
+        Score(result.parsed, 0, candidate);
+        result.candidates.push_back(candidate);
+    }
+
+    auto CompareScore = [](const MatchCandidate& a, const MatchCandidate& b) { return a.score > b.score; };
+    std::stable_sort(result.candidates.begin(), result.candidates.end(), CompareScore);
+    if (result.candidates.size() > MATCH_MAX_CANDIDATES) {
+        result.candidates.resize(MATCH_MAX_CANDIDATES);
+    }
+
+    // 用视频时长区分同名的候选条目(如翻拍的电影), 仅对得分靠前的条目查询时长
+    const std::string& probePath   = videoType == TV ? firstEpisodePath : videoPath;
+    int                durationSec = result.candidates.empty() ? -1 : HDRToolKit::GetDurationFromFile(probePath);
+    if (durationSec > 0) {
+        for (std::size_t i = 0; i < result.candidates.size() && i < MATCH_RUNTIME_CHECKS; i++) {
+            auto& candidate = result.candidates[i];
+            if (api.GetRuntime(videoType, candidate.tmdbId, candidate.runtime)) {
+                Score(result.parsed, durationSec, candidate);
+            }
+        }
+        std::stable_sort(result.candidates.begin(), result.candidates.end(), CompareScore);
+    }
+
+    if (!result.candidates.empty()) {
+        double bestScore   = result.candidates[0].score;
+        double secondScore = result.candidates.size() > 1 ? result.candidates[1].score : 0.0;
+        result.isConfident = bestScore >= Config::Instance().GetAutoMatchThreshold() &&
+                             bestScore - secondScore >= MATCH_MIN_MARGIN;
+    }
+
+    LOG_DEBUG("Matched {} candidates for {}, title: {}, year: {}, confident: {}",
+              result.candidates.size(),
+              videoPath,
+              result.parsed.title,
+              result.parsed.year,
+              result.isConfident);
+    return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "CommonType.h"
+#include "MediaNameParser.h"
+
+/**
+ * @brief 自动匹配的候选条目
+ *
+ */
+struct MatchCandidate {
+    int         tmdbId  = 0;   // TMDB的ID
+    std::string title;         // 标题
+    std::string originalTitle; // 原始标题
+    int         year    = 0;   // 上映/首播年份, 0表示未知
+    int         runtime = 0;   // 时长, 单位: 分钟, 0表示未知
+    double      score   = 0.0; // 匹配得分, 取值范围[0, 1]
+};
+
+/**
+ * @brief 自动匹配的结果
+ *
+ */
+struct MatchResult {
+    ParsedMediaName             parsed;              // 从名称中解析出的信息
+    std::vector<MatchCandidate> candidates;          // 按照得分从高到低排序的候选条目
+    bool                        isConfident = false; // 最佳候选是否达到直接刮削的置信度
+};
+
+/**
+ * @brief 根据文件/目录名称自动匹配TMDB条目
+ *
+ * 解析名称中的标题和年份后搜索TMDB, 按照标题相似度, 年份, 时长(与ffprobe读取的视频时长比较)对候选条目打分.
+ * 最佳候选的得分不低于阈值, 且明显高于第二名时, 认为匹配可信.
+ */
+class AutoMatcher
+{
+public:
+
+    /**
+     * @brief 匹配单个视频
+     *
+     * @param videoType 视频类型
+     * @param videoPath 电影文件路径或者电视剧目录
+     * @param firstEpisodePath 电视剧第一集的路径, 电影为空
+     * @param result 输出匹配结果
+     * @return true 搜索成功(候选条目可能为空)
+     * @return false 名称无法解析或者搜索失败
+     */
+    static bool Match(VideoType          videoType,
+                      const std::string& videoPath,
+                      const std::string& firstEpisodePath,
+                      MatchResult&       result);
+
+private:
+
+    static double YearScore(int parsedYear, int candidateYear);
+    static double RuntimeScore(int durationSec, int runtimeMin);
+    static void   Score(const ParsedMediaName& parsed, int durationSec, MatchCandidate& candidate);
+};
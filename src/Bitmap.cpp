@@ -0,0 +1,337 @@
+#include "Bitmap.h"
+
+#include <algorithm>
+#include <iterator>
+
+const std::size_t Bitmap::ARRAY_MAX_SIZE;
+
+static const std::size_t BITSET_WORD_NUM = 65536 / 64; // 位图容器的字数
+
+void Bitmap::Add(uint32_t value)
+{
+    const uint16_t key  = static_cast<uint16_t>(value >> 16);
+    const uint16_t low  = static_cast<uint16_t>(value & 0xFFFF);
+    auto           iter = Find(key);
+    if (iter == m_containers.end() || iter->key != key) {
+        Container container;
+        container.key = key;
+        iter          = m_containers.insert(iter, container);
+    }
+
+    if (!iter->bits.empty()) {
+        uint64_t& word = iter->bits[low / 64];
+        if ((word & (1ULL << (low % 64))) == 0) {
+            word |= 1ULL << (low % 64);
+            iter->cardinality++;
+        }
+        return;
+    }
+
+    auto pos = std::lower_bound(iter->array.begin(), iter->array.end(), low);
+    if (pos != iter->array.end() && *pos == low) {
+        return;
+    }
+    iter->array.insert(pos, low);
+    iter->cardinality++;
+    if (iter->array.size() > ARRAY_MAX_SIZE) {
+        ToBitset(*iter);
+    }
+}
+
+void Bitmap::Remove(uint32_t value)
+{
+    const uint16_t key  = static_cast<uint16_t>(value >> 16);
+    const uint16_t low  = static_cast<uint16_t>(value & 0xFFFF);
+    auto           iter = Find(key);
+    if (iter == m_containers.end() || iter->key != key || !ContainerContains(*iter, low)) {
+        return;
+    }
+
+    if (!iter->bits.empty()) {
+        iter->bits[low / 64] &= ~(1ULL << (low % 64));
+        iter->cardinality--;
+        Normalize(*iter);
+    } else {
+        iter->array.erase(std::lower_bound(iter->array.begin(), iter->array.end(), low));
+        iter->cardinality--;
+    }
+    if (iter->cardinality == 0) {
+        m_containers.erase(iter);
+    }
+}
+
+bool Bitmap::Contains(uint32_t value) const
+{
+    const uint16_t key  = static_cast<uint16_t>(value >> 16);
+    auto           iter = Find(key);
+    return iter != m_containers.end() && iter->key == key &&
+           ContainerContains(*iter, static_cast<uint16_t>(value & 0xFFFF));
+}
+
+std::size_t Bitmap::Count() const
+{
+    std::size_t count = 0;
+    for (const auto& container : m_containers) {
+        count += container.cardinality;
+    }
+    return count;
+}
+
+bool Bitmap::Empty() const
+{
+    return m_containers.empty();
+}
+
+Bitmap Bitmap::And(const Bitmap& lhs, const Bitmap& rhs)
+{
+    Bitmap result;
+    auto   lhsIter = lhs.m_containers.begin();
+    auto   rhsIter = rhs.m_containers.begin();
+    while (lhsIter != lhs.m_containers.end() && rhsIter != rhs.m_containers.end()) {
+        if (lhsIter->key < rhsIter->key) {
+            ++lhsIter;
+        } else if (rhsIter->key < lhsIter->key) {
+            ++rhsIter;
+        } else {
+            Container container = ContainerAnd(*lhsIter++, *rhsIter++);
+            if (container.cardinality > 0) {
+                result.m_containers.push_back(std::move(container));
+            }
+        }
+    }
+    return result;
+}
+
+Bitmap Bitmap::Or(const Bitmap& lhs, const Bitmap& rhs)
+{
+    Bitmap result;
+    auto   lhsIter = lhs.m_containers.begin();
+    auto   rhsIter = rhs.m_containers.begin();
+    while (lhsIter != lhs.m_containers.end() || rhsIter != rhs.m_containers.end()) {
+        if (rhsIter == rhs.m_containers.end() || (lhsIter != lhs.m_containers.end() && lhsIter->key < rhsIter->key)) {
+            result.m_containers.push_back(*lhsIter++);
+        } else if (lhsIter == lhs.m_containers.end() || rhsIter->key < lhsIter->key) {
+            result.m_containers.push_back(*rhsIter++);
+        } else {
+            result.m_containers.push_back(ContainerOr(*lhsIter++, *rhsIter++));
+        }
+    }
+    return result;
+}
+
+Bitmap Bitmap::AndNot(const Bitmap& lhs, const Bitmap& rhs)
+{
+    Bitmap result;
+    auto   rhsIter = rhs.m_containers.begin();
+    for (const auto& container : lhs.m_containers) {
+        while (rhsIter != rhs.m_containers.end() && rhsIter->key < container.key) {
+            ++rhsIter;
+        }
+        if (rhsIter == rhs.m_containers.end() || rhsIter->key != container.key) {
+            result.m_containers.push_back(container);
+            continue;
+        }
+        Container diff = ContainerAndNot(container, *rhsIter);
+        if (diff.cardinality > 0) {
+            result.m_containers.push_back(std::move(diff));
+        }
+    }
+    return result;
+}
+
+std::size_t Bitmap::AndCount(const Bitmap& lhs, const Bitmap& rhs)
+{
+    std::size_t count   = 0;
+    auto        lhsIter = lhs.m_containers.begin();
+    auto        rhsIter = rhs.m_containers.begin();
+    while (lhsIter != lhs.m_containers.end() && rhsIter != rhs.m_containers.end()) {
+        if (lhsIter->key < rhsIter->key) {
+            ++lhsIter;
+        } else if (rhsIter->key < lhsIter->key) {
+            ++rhsIter;
+        } else {
+            count += ContainerAndCount(*lhsIter++, *rhsIter++);
+        }
+    }
+    return count;
+}
+
+void Bitmap::ToBitset(Container& container)
+{
+    container.bits.assign(BITSET_WORD_NUM, 0);
+    for (auto low : container.array) {
+        container.bits[low / 64] |= 1ULL << (low % 64);
+    }
+    container.array.clear();
+    container.array.shrink_to_fit();
+}
+
+void Bitmap::Normalize(Container& container)
+{
+    // 位图容器的元素减少到数组容器的上限以内时转回数组容器
+    if (container.bits.empty() || container.cardinality > ARRAY_MAX_SIZE) {
+        return;
+    }
+    container.array.clear();
+    container.array.reserve(container.cardinality);
+    for (std::size_t i = 0; i < container.bits.size(); i++) {
+        for (uint64_t word = container.bits[i]; word != 0; word &= word - 1) {
+            container.array.push_back(static_cast<uint16_t>(i * 64 + CountTrailingZeros64(word)));
+        }
+    }
+    container.bits.clear();
+    container.bits.shrink_to_fit();
+}
+
+bool Bitmap::ContainerContains(const Container& container, uint16_t low)
+{
+    if (!container.bits.empty()) {
+        return (container.bits[low / 64] & (1ULL << (low % 64))) != 0;
+    }
+    return std::binary_search(container.array.begin(), container.array.end(), low);
+}
+
+Bitmap::Container Bitmap::ContainerAnd(const Container& lhs, const Container& rhs)
+{
+    Container result;
+    result.key = lhs.key;
+    if (!lhs.bits.empty() && !rhs.bits.empty()) {
+        result.bits.resize(BITSET_WORD_NUM);
+        for (std::size_t i = 0; i < BITSET_WORD_NUM; i++) {
+            result.bits[i] = lhs.bits[i] & rhs.bits[i];
+            result.cardinality += PopCount64(result.bits[i]);
+        }
+        Normalize(result);
+    } else if (lhs.bits.empty() && rhs.bits.empty()) {
+        std::set_intersection(lhs.array.begin(),
+                              lhs.array.end(),
+                              rhs.array.begin(),
+                              rhs.array.end(),
+                              std::back_inserter(result.array));
+        result.cardinality = result.array.size();
+    } else {
+        const Container& arrayContainer  = lhs.bits.empty() ? lhs : rhs;
+        const Container& bitsetContainer = lhs.bits.empty() ? rhs : lhs;
+        for (auto low : arrayContainer.array) {
+            if (ContainerContains(bitsetContainer, low)) {
+                result.array.push_back(low);
+            }
+        }
+        result.cardinality = result.array.size();
+    }
+    return result;
+}
+
+Bitmap::Container Bitmap::ContainerOr(const Container& lhs, const Container& rhs)
+{
+    Container result;
+    result.key = lhs.key;
+    if (lhs.bits.empty() && rhs.bits.empty()) {
+        std::set_union(lhs.array.begin(),
+                       lhs.array.end(),
+                       rhs.array.begin(),
+                       rhs.array.end(),
+                       std::back_inserter(result.array));
+        result.cardinality = result.array.size();
+        if (result.array.size() > ARRAY_MAX_SIZE) {
+            ToBitset(result);
+        }
+        return result;
+    }
+
+    // 任意一方为位图容器时结果必然超过数组容器的上限
+    result.bits.assign(BITSET_WORD_NUM, 0);
+    for (const Container* container : {&lhs, &rhs}) {
+        if (container->bits.empty()) {
+            for (auto low : container->array) {
+                result.bits[low / 64] |= 1ULL << (low % 64);
+            }
+        } else {
+            for (std::size_t i = 0; i < BITSET_WORD_NUM; i++) {
+                result.bits[i] |= container->bits[i];
+            }
+        }
+    }
+    for (auto word : result.bits) {
+        result.cardinality += PopCount64(word);
+    }
+    return result;
+}
+
+Bitmap::Container Bitmap::ContainerAndNot(const Container& lhs, const Container& rhs)
+{
+    Container result;
+    result.key = lhs.key;
+    if (lhs.bits.empty()) {
+        for (auto low : lhs.array) {
+            if (!ContainerContains(rhs, low)) {
+                result.array.push_back(low);
+            }
+        }
+        result.cardinality = result.array.size();
+        return result;
+    }
+
+    result.bits = lhs.bits;
+    if (rhs.bits.empty()) {
+        for (auto low : rhs.array) {
+            result.bits[low / 64] &= ~(1ULL << (low % 64));
+        }
+    } else {
+        for (std::size_t i = 0; i < BITSET_WORD_NUM; i++) {
+            result.bits[i] &= ~rhs.bits[i];
+        }
+    }
+    for (auto word : result.bits) {
+        result.cardinality += PopCount64(word);
+    }
+    Normalize(result);
+    return result;
+}
+
+std::size_t Bitmap::ContainerAndCount(const Container& lhs, const Container& rhs)
+{
+    std::size_t count = 0;
+    if (!lhs.bits.empty() && !rhs.bits.empty()) {
+        for (std::size_t i = 0; i < BITSET_WORD_NUM; i++) {
+            count += PopCount64(lhs.bits[i] & rhs.bits[i]);
+        }
+    } else if (lhs.bits.empty() && rhs.bits.empty()) {
+        auto lhsIter = lhs.array.begin();
+        auto rhsIter = rhs.array.begin();
+        while (lhsIter != lhs.array.end() && rhsIter != rhs.array.end()) {
+            if (*lhsIter < *rhsIter) {
+                ++lhsIter;
+            } else if (*rhsIter < *lhsIter) {
+                ++rhsIter;
+            } else {
+                count++;
+                ++lhsIter;
+                ++rhsIter;
+            }
+        }
+    } else {
+        const Container& arrayContainer  = lhs.bits.empty() ? lhs : rhs;
+        const Container& bitsetContainer = lhs.bits.empty() ? rhs : lhs;
+        for (auto low : arrayContainer.array) {
+            count += ContainerContains(bitsetContainer, low) ? 1 : 0;
+        }
+    }
+    return count;
+}
+
+std::vector<Bitmap::Container>::iterator Bitmap::Find(uint16_t key)
+{
+    return std::lower_bound(m_containers.begin(),
+                            m_containers.end(),
+                            key,
+                            [](const Container& container, uint16_t target) { return container.key < target; });
+}
+
+std::vector<Bitmap::Container>::const_iterator Bitmap::Find(uint16_t key) const
+{
+    return std::lower_bound(m_containers.begin(),
+                            m_containers.end(),
+                            key,
+                            [](const Container& container, uint16_t target) { return container.key < target; });
+}
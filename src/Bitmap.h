@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * @brief 统计64位字中1的个数
+ *
+ * @param word 64位字
+ * @return int 1的个数
+ */
+inline int PopCount64(uint64_t word)
+{
+#if defined(_MSC_VER)
+#if defined(_M_X64)
+    return static_cast<int>(__popcnt64(word));
+#else  // _M_X64
+    // 32位目标没有64位的内建函数, 分为高低两半计算
+    return static_cast<int>(__popcnt(static_cast<unsigned int>(word)) +
+                            __popcnt(static_cast<unsigned int>(word >> 32)));
+#endif // _M_X64
+#else  // _MSC_VER
+    return __builtin_popcountll(word);
+#endif // _MSC_VER
+}
+
+/**
+ * @brief 获取64位字最低的1所在的位置
+ *
+ * @param word 64位字, 不能为0
+ * @return int 最低的1所在的位置(0~63)
+ */
+inline int CountTrailingZeros64(uint64_t word)
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+#if defined(_M_X64)
+    _BitScanForward64(&index, word);
+#else  // _M_X64
+    if (!_BitScanForward(&index, static_cast<unsigned long>(word))) {
+        _BitScanForward(&index, static_cast<unsigned long>(word >> 32));
+        index += 32;
+    }
+#endif // _M_X64
+    return static_cast<int>(index);
+#else  // _MSC_VER
+    return __builtin_ctzll(word);
+#endif // _MSC_VER
+}
+
+/**
+ * @brief 压缩位图(roaring bitmap的简化实现)
+ *
+ * 按高16位将整数分到不同的容器中, 容器内只记录低16位: 元素较少时为有序数组, 超过ARRAY_MAX_SIZE时转为定长的位图.
+ * 稀疏集合只占用与元素个数成正比的内存, 稠密集合的交并差与计数按64位字进行.
+ */
+class Bitmap
+{
+public:
+
+    static const std::size_t ARRAY_MAX_SIZE = 4096; // 数组容器的最大元素个数, 超过后转为位图容器
+
+    void        Add(uint32_t value);
+    void        Remove(uint32_t value);
+    bool        Contains(uint32_t value) const;
+    std::size_t Count() const;
+    bool        Empty() const;
+
+    /**
+     * @brief 集合运算
+     *
+     * @param lhs 左操作数
+     * @param rhs 右操作数
+     * @return Bitmap 交集/并集/差集(lhs中不属于rhs的元素)
+     */
+    static Bitmap And(const Bitmap& lhs, const Bitmap& rhs);
+    static Bitmap Or(const Bitmap& lhs, const Bitmap& rhs);
+    static Bitmap AndNot(const Bitmap& lhs, const Bitmap& rhs);
+
+    /**
+     * @brief 计算交集的元素个数, 不构造交集
+     *
+     * @param lhs 左操作数
+     * @param rhs 右操作数
+     * @return std::size_t 交集的元素个数
+     */
+    static std::size_t AndCount(const Bitmap& lhs, const Bitmap& rhs);
+
+    /**
+     * @brief 按升序遍历所有元素
+     *
+     * @param func 对每个元素调用的函数, 参数为uint32_t
+     */
+    template <typename Func>
+    void ForEach(Func func) const
+    {
+        for (const auto& container : m_containers) {
+            const uint32_t high = static_cast<uint32_t>(container.key) << 16;
+            if (container.bits.empty()) {
+                for (auto low : container.array) {
+                    func(high | low);
+                }
+                continue;
+            }
+            for (std::size_t i = 0; i < container.bits.size(); i++) {
+                for (uint64_t word = container.bits[i]; word != 0; word &= word - 1) {
+                    func(high | static_cast<uint32_t>(i * 64 + CountTrailingZeros64(word)));
+                }
+            }
+        }
+    }
+
+private:
+
+    /**
+     * @brief 高16位相同的元素的容器, bits非空时为位图容器, 否则为数组容器
+     *
+     */
+    struct Container {
+        uint16_t              key         = 0; // 元素的高16位
+        uint32_t              cardinality = 0; // 元素个数
+        std::vector<uint16_t> array;           // 数组容器: 有序的低16位
+        std::vector<uint64_t> bits;            // 位图容器: 65536位
+    };
+
+    static void        ToBitset(Container& container);
+    static void        Normalize(Container& container);
+    static bool        ContainerContains(const Container& container, uint16_t low);
+    static Container   ContainerAnd(const Container& lhs, const Container& rhs);
+    static Container   ContainerOr(const Container& lhs, const Container& rhs);
+    static Container   ContainerAndNot(const Container& lhs, const Container& rhs);
+    static std::size_t ContainerAndCount(const Container& lhs, const Container& rhs);
+
+    std::vector<Container>::iterator       Find(uint16_t key);
+    std::vector<Container>::const_iterator Find(uint16_t key) const;
+
+private:
+
+    std::vector<Container> m_containers; // 按高16位升序排列的容器
+};
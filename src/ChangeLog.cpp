@@ -0,0 +1,52 @@
+#include "ChangeLog.h"
+
+#include <algorithm>
+
+const std::size_t ChangeLog::MAX_ENTRIES;
+
+ChangeLog::ChangeLog() : m_floor(0) {}
+
+void ChangeLog::Append(uint64_t version, const std::vector<VideoId>& ids)
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+
+    // 单次变化超过上限(如首次扫描), 直接要求所有客户端全量同步
+    if (ids.size() > MAX_ENTRIES) {
+        Truncate(version);
+        return;
+    }
+    for (auto id : ids) {
+        m_entries.push_back(Entry{version, id});
+    }
+    while (m_entries.size() > MAX_ENTRIES) {
+        Truncate(m_entries.front().version);
+    }
+}
+
+bool ChangeLog::Since(uint64_t since, uint64_t version, std::vector<VideoId>& ids) const
+{
+    ids.clear();
+
+    std::lock_guard<std::mutex> locker(m_lock);
+    if (since < m_floor || since > version) {
+        return false;
+    }
+    auto iter = std::upper_bound(m_entries.begin(), m_entries.end(), since, [](uint64_t target, const Entry& entry) {
+        return target < entry.version;
+    });
+    for (; iter != m_entries.end() && iter->version <= version; ++iter) {
+        ids.push_back(iter->id);
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return true;
+}
+
+void ChangeLog::Truncate(uint64_t version)
+{
+    // 丢弃整个版本的条目, 使日志覆盖的范围保持完整
+    while (!m_entries.empty() && m_entries.front().version <= version) {
+        m_entries.pop_front();
+    }
+    m_floor = std::max(m_floor, version);
+}
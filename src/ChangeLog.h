@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "Library.h"
+
+/**
+ * @brief 媒体库的变更日志, 以快照版本号为序号记录每次发布中变化的视频ID
+ *
+ * 日志只记录ID, 不记录变化的内容: 客户端同步时以当前快照中的状态为准, 不在快照中的即为已删除.
+ * 日志的长度有上限, 超出时从最旧的版本开始整版本丢弃, 早于保留范围的同步请求需要全量同步.
+ */
+class ChangeLog
+{
+public:
+
+    static const std::size_t MAX_ENTRIES = 4096; // 保留的最大条目数
+
+    ChangeLog();
+
+    ChangeLog(const ChangeLog&)            = delete;
+    ChangeLog& operator=(const ChangeLog&) = delete;
+
+    /**
+     * @brief 记录一次发布, 需要在发布快照之前调用, 保证读取者看到的快照版本已全部记入日志
+     *
+     * @param version 发布的快照版本号, 必须大于之前记录的版本号
+     * @param ids 变化(新增, 修改, 删除)的视频ID
+     */
+    void Append(uint64_t version, const std::vector<VideoId>& ids);
+
+    /**
+     * @brief 获取两个版本之间变化的视频ID
+     *
+     * @param since 客户端已同步到的版本号
+     * @param version 读取者持有的快照版本号, 晚于该版本的变化不返回
+     * @param ids 输出(since, version]之间变化的视频ID, 已去重
+     * @return true 成功
+     * @return false since早于日志保留的范围或者晚于version, 需要全量同步
+     */
+    bool Since(uint64_t since, uint64_t version, std::vector<VideoId>& ids) const;
+
+private:
+
+    /**
+     * @brief 日志条目
+     *
+     */
+    struct Entry {
+        uint64_t version; // 快照版本号
+        VideoId  id;      // 变化的视频ID
+    };
+
+    void Truncate(uint64_t version);
+
+private:
+
+    std::deque<Entry>  m_entries; // 按版本号升序的条目
+    uint64_t           m_floor;   // 日志完整覆盖(m_floor, 最新版本]之间的变化
+    mutable std::mutex m_lock;    // 日志的锁
+};
@@ -0,0 +1,92 @@
+#include "CircuitBreaker.h"
+
+#include "Logger.h"
+
+CircuitBreaker::CircuitBreaker(int failureThreshold, int openSec)
+    : m_failureThreshold(failureThreshold), m_openDuration(openSec), m_state(CLOSED), m_failures(0),
+      m_probing(false)
+{
+}
+
+bool CircuitBreaker::Allow()
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    switch (m_state) {
+    case CLOSED:
+        return true;
+    case OPEN:
+        if (std::chrono::steady_clock::now() < m_openUntil) {
+            return false;
+        }
+        LOG_INFO("Circuit breaker half-open, probing upstream");
+        m_state   = HALF_OPEN;
+        m_probing = true;
+        return true;
+    case HALF_OPEN:
+        // 探测请求返回前其余请求直接失败
+        if (m_probing) {
+            return false;
+        }
+        m_probing = true;
+        return true;
+    }
+    return true;
+}
+
+void CircuitBreaker::OnSuccess()
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    if (m_state != CLOSED) {
+        LOG_INFO("Circuit breaker closed, upstream recovered");
+    }
+    m_state    = CLOSED;
+    m_failures = 0;
+    m_probing  = false;
+}
+
+void CircuitBreaker::OnFailure()
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    if (m_failureThreshold <= 0) {
+        return;
+    }
+
+    if (m_state == HALF_OPEN) {
+        Open();
+    } else if (m_state == CLOSED && ++m_failures >= m_failureThreshold) {
+        Open();
+    }
+}
+
+void CircuitBreaker::Open()
+{
+    LOG_WARN("Circuit breaker open for {}s after {} failures", m_openDuration.count(), m_failures);
+    m_state     = OPEN;
+    m_probing   = false;
+    m_openUntil = std::chrono::steady_clock::now() + m_openDuration;
+}
+
+bool CircuitBreaker::IsOpen()
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    return m_state == OPEN && std::chrono::steady_clock::now() < m_openUntil;
+}
+
+CircuitBreaker::State CircuitBreaker::GetState()
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    return m_state;
+}
+
+std::string CircuitBreaker::StateToStr(State state)
+{
+    switch (state) {
+    case CLOSED:
+        return "closed";
+    case OPEN:
+        return "open";
+    case HALF_OPEN:
+        return "half-open";
+    }
+    return "unknown";
+}
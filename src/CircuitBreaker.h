@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief 熔断器
+ *
+ * 连续失败达到阈值后熔断(OPEN), 熔断期间的请求直接失败; 冷却时间过后进入半开状态(HALF_OPEN),
+ * 只放行一个探测请求, 探测成功则恢复(CLOSED), 失败则重新熔断.
+ */
+class CircuitBreaker
+{
+public:
+
+    enum State {
+        CLOSED,
+        OPEN,
+        HALF_OPEN,
+    };
+
+    /**
+     * @brief 构造熔断器
+     *
+     * @param failureThreshold 触发熔断的连续失败次数, 不大于0时不熔断
+     * @param openSec 熔断后的冷却时间, 单位: 秒
+     */
+    CircuitBreaker(int failureThreshold, int openSec);
+
+    /**
+     * @brief 判断是否允许发起请求, 允许时调用者必须通过OnSuccess()或者OnFailure()报告结果
+     *
+     * @return true 允许
+     * @return false 熔断中, 应直接失败
+     */
+    bool Allow();
+
+    /**
+     * @brief 报告请求成功(上游可用)
+     *
+     */
+    void OnSuccess();
+
+    /**
+     * @brief 报告请求失败(网络错误或服务端错误)
+     *
+     */
+    void OnFailure();
+
+    /**
+     * @brief 判断当前是否处于熔断中(不改变状态, 用于批量任务提前终止)
+     *
+     * @return true 熔断中且冷却时间未到
+     * @return false 可以发起请求
+     */
+    bool IsOpen();
+
+    /**
+     * @brief 获取当前的状态
+     *
+     * @return State 状态
+     */
+    State GetState();
+
+    /**
+     * @brief 获取状态的名称
+     *
+     * @param state 状态
+     * @return std::string 名称
+     */
+    static std::string StateToStr(State state);
+
+private:
+
+    void Open();
+
+private:
+
+    int                                   m_failureThreshold; // 触发熔断的连续失败次数
+    std::chrono::seconds                  m_openDuration;     // 熔断后的冷却时间
+    State                                 m_state;            // 当前的状态
+    int                                   m_failures;         // 连续失败的次数
+    bool                                  m_probing;          // 半开状态下是否已有探测请求
+    std::chrono::steady_clock::time_point m_openUntil;        // 冷却结束的时间
+    std::mutex                            m_lock;             // 状态的锁
+};
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <ctime>
 #include <map>
 #include <string>
 #include <vector>
 
 #include "HDRToolKit.h"
+#include "PathTable.h"
+#include "StringPool.h"
 
 const std::vector<std::string> VIDEO_SUFFIX = {"mkv", "mp4", "iso", "ts"}; // 视频文件的后缀名集合
 
@@ -56,10 +59,10 @@ static std::map<VideoType, std::string> VIDEO_TYPE_TO_STR = {
  *
  */
 struct ActorDetail {
-    std::string name;  // 演员名称
-    std::string role;  // 演员扮演的角色
-    int         order; // 演员的排序顺序
-    std::string thumb; // 演员的预览图
+    InternedString name;  // 演员名称
+    InternedString role;  // 演员扮演的角色
+    int            order; // 演员的排序顺序
+    std::string    thumb; // 演员的预览图
 };
 
 /**
@@ -76,6 +79,7 @@ struct RatingDetail {
  *
  */
 struct EpisodeDetail {
+    int         seasonNumber;  // 电视剧的季编号
     int         episodeNumber; // 电视剧的集数
     std::string fullPath;      // 电视剧的全路径
     std::string title;         // 电视剧的标题
@@ -97,30 +101,42 @@ struct SeasonDetail {
     std::vector<EpisodeDetail> episodeDetails; // 季的所有电视剧详情
 };
 
+/**
+ * @brief 电视剧的播出计划
+ *
+ */
+struct AiringInfo {
+    std::string status;      // TMDB的播出状态, 如"Returning Series", "Ended"
+    std::string lastAirDate; // 最近一集的播出日期(YYYY-MM-DD)
+    std::string nextAirDate; // 下一集的播出日期(YYYY-MM-DD), 没有计划时为空
+    bool        isEnded;     // 是否已完结或者被取消
+};
+
 /**
  * @brief 公共详情
  *
  */
 struct VideoDetail {
-    VideoDetail() : episodeNfoCount(0) {}
-
-    std::string                title;         // 视频的标题
-    std::string                originaltitle; // 视频的原始标题
-    RatingDetail               ratings;       // 视频的用户评分
-    std::string                plot;          // 视频的剧情介绍
-    std::map<std::string, int> uniqueid;      // 不同API类型下, 视频的唯一ID
-    std::vector<std::string>   genre;         // 视频的分类
-    std::vector<std::string>   countries;     // 视频的国家
-    std::vector<std::string>   credits;       // 视频的编剧
-    std::string                director;      // 视频的导演
-    std::string                premiered;     // 视频的首播日期
-    std::vector<std::string>   studio;        // 视频的制片厂
-    std::vector<ActorDetail>   actors;        // 视频的演员信息
+    VideoDetail() : episodeNfoCount(0), isEnded(false) {}
+
+    // 分类, 国家, 制片厂与演职人员在视频之间大量重复, 使用驻留字符串
+    std::string                 title;         // 视频的标题
+    std::string                 originaltitle; // 视频的原始标题
+    RatingDetail                ratings;       // 视频的用户评分
+    std::string                 plot;          // 视频的剧情介绍
+    std::map<std::string, int>  uniqueid;      // 不同API类型下, 视频的唯一ID
+    std::vector<InternedString> genre;         // 视频的分类
+    std::vector<InternedString> countries;     // 视频的国家
+    std::vector<InternedString> credits;       // 视频的编剧
+    InternedString              director;      // 视频的导演
+    std::string                 premiered;     // 视频的首播日期
+    std::vector<InternedString> studio;        // 视频的制片厂
+    std::vector<ActorDetail>    actors;        // 视频的演员信息
 
     // 电视剧专属
     int                      seasonNumber;    // 季编号
     size_t                   episodeNfoCount; // 电视剧剧集完整的NFO文件个数
-    std::vector<std::string> episodePaths;    // 电视剧剧集路径
+    std::vector<CompactPath> episodePaths;    // 电视剧剧集路径, 同一目录下的剧集共用目录表中的节点
     bool                     isEnded;         // 是否已完结
 
     std::string posterUrl;    // 视频的海报图片地址(短地址, 仅包含服务器上的文件名称)
@@ -139,16 +155,17 @@ struct VideoInfo {
     std::string    videoPath;                     // 视频所在路径
     VideoRangeType hdrType = VideoRangeType::SDR; // HDR的类型
     VideoFileType  videoFiletype;
+    std::time_t    addedTime = 0;                 // 加入媒体库的时间(视频文件或电视剧目录的创建时间)
 
     MetaFileStatus nfoStatus;       // NFO文件状态
     MetaFileStatus posterStatus;    // 海报文件状态
     MetaFileStatus fanartStatus;    // 剧照文件状态
     MetaFileStatus clearlogoStatus; // 标志文件状态
 
-    std::string nfoPath;       // NFO文件路径
-    std::string posterPath;    // 海报路径
-    std::string fanartPath;    // 剧照路径
-    std::string clearlogoPath; // logo路径
+    // NFO与图片的路径由视频路径按命名规则推导, 不单独保存, 见DataSource::GetNfoPath等
 
     VideoDetail videoDetail;
+
+    // 剧情切分得到的检索词(已去重), 由扫描时的简要解析填充, 发布扫描结果时移交给搜索索引, 剧情原文不常驻内存
+    std::vector<std::string> plotTerms;
 };
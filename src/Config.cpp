@@ -1,5 +1,6 @@
 #include "Config.h"
 
+#include <algorithm>
 #include <fstream>
 
 #include <Poco/File.h>
@@ -14,12 +15,32 @@
 
 const std::string CONF_FILE_NAME           = "ScraperServer.json"; // 默认的配置文件名称
 
+const std::map<ApiUrlType, std::string> API_URL_TYPE_TO_STR = {
+    {SEARCH_MOVIE, "SearchMovie"},
+    {SEARCH_TV, "SearchTV"},
+    {GET_MOVIE_CREDITS, "GetMovieCredits"},
+    {GET_MOVIE_DETAIL, "GetMovieDetail"},
+    {GET_MOVIE_IMAGES, "GetMovieImages"},
+    {GET_TV_CREDITS, "GetTVCredits"},
+    {GET_TV_DETAIL, "GetTVDetail"},
+    {GET_TV_IMAGES, "GetTVImages"},
+    {GET_SEASON_DETAIL, "GetSeasonDetail"},
+    {GET_SEASON_IMAGES, "GetSeasonImages"},
+    {IMAGE_DOWNLOAD, "ImageDownload"},
+};
+
 Config& Config::Instance()
 {
     static Config singleton;
     return singleton;
 }
 
+std::string Config::DefaultArtworkStorePath()
+{
+    return Poco::Path::configHome() + "ScraperServer" + Poco::Path::separator() + "artwork" +
+           Poco::Path::separator();
+}
+
 void Config::GetConfFile()
 {
     static const std::vector<std::string> confPaths = {
@@ -118,6 +139,11 @@ std::string Config::GetffprobePath()
     return m_appConf.ffprobePath;
 }
 
+std::string Config::GetArtworkStorePath()
+{
+    return m_appConf.artworkStorePath;
+}
+
 const std::map<VideoType, std::vector<std::string>>& Config::GetPaths()
 {
     return m_appConf.dataSourceConf.paths;
@@ -133,6 +159,40 @@ const std::string& Config::GetApiKey()
     return m_appConf.apiConf.apiKey;
 }
 
+RequestPolicyConf Config::GetRequestPolicy(ApiUrlType apiUrlType)
+{
+    auto iter = m_appConf.apiConf.requestPolicies.find(apiUrlType);
+    if (iter != m_appConf.apiConf.requestPolicies.end()) {
+        return iter->second;
+    }
+
+    // 未解析配置文件时, 图像下载使用下载超时, 其余使用JSON超时
+    RequestPolicyConf policy;
+    policy.readTimeout =
+        apiUrlType == IMAGE_DOWNLOAD ? m_appConf.apiConf.downloadTimeout : m_appConf.apiConf.jsonTimeout;
+    return policy;
+}
+
+double Config::GetRateLimit()
+{
+    return m_appConf.apiConf.rateLimit;
+}
+
+FailurePolicyConf Config::GetFailurePolicy()
+{
+    return m_appConf.apiConf.failurePolicy;
+}
+
+std::string Config::GetFixtureRecordPath()
+{
+    return m_appConf.apiConf.fixtureRecordPath;
+}
+
+double Config::GetAutoMatchThreshold()
+{
+    return m_appConf.autoMatchThreshold;
+}
+
 bool Config::ParseConfFile()
 {
     // 如果命令行参数解析时没有设置配置文件, 则按照预设规则搜索配置文件
@@ -192,6 +252,43 @@ bool Config::ParseConfFile()
         m_appConf.apiConf.downloadTimeout = apiTimeoutJson->getValue<int>("Download");
         m_appConf.apiConf.jsonTimeout     = apiTimeoutJson->getValue<int>("Json");
 
+        // 超时与重试策略: 先读取通用配置, 再使用"Endpoints"中同名API的配置覆盖
+        auto ParsePolicy = [](const Poco::JSON::Object::Ptr& policyJson, RequestPolicyConf& policy) {
+            policy.connectTimeout  = policyJson->optValue<int>("Connect", policy.connectTimeout);
+            policy.readTimeout     = policyJson->optValue<int>("Read", policy.readTimeout);
+            policy.totalTimeout    = policyJson->optValue<int>("Total", policy.totalTimeout);
+            policy.maxRetries      = policyJson->optValue<int>("Retries", policy.maxRetries);
+            policy.backoffBaseMs   = policyJson->optValue<int>("BackoffMs", policy.backoffBaseMs);
+            policy.backoffMaxMs    = policyJson->optValue<int>("BackoffMaxMs", policy.backoffMaxMs);
+            policy.hedgePercentile = policyJson->optValue<int>("HedgePercentile", policy.hedgePercentile);
+        };
+        auto endpointsJson = apiTimeoutJson->getObject("Endpoints");
+        for (const auto& pair : API_URL_TYPE_TO_STR) {
+            RequestPolicyConf policy;
+            if (pair.first == IMAGE_DOWNLOAD) {
+                policy.readTimeout  = m_appConf.apiConf.downloadTimeout;
+                policy.totalTimeout = std::max(policy.totalTimeout, m_appConf.apiConf.downloadTimeout * 4);
+            } else {
+                policy.readTimeout = m_appConf.apiConf.jsonTimeout;
+            }
+            ParsePolicy(apiTimeoutJson, policy);
+            if (!endpointsJson.isNull() && endpointsJson->has(pair.second)) {
+                ParsePolicy(endpointsJson->getObject(pair.second), policy);
+            }
+            m_appConf.apiConf.requestPolicies[pair.first] = policy;
+        }
+
+        m_appConf.apiConf.rateLimit         = apiConfJson->optValue<double>("RateLimit", API_RATE_LIMIT);
+        m_appConf.apiConf.fixtureRecordPath = apiConfJson->optValue<std::string>("RecordFixtures", "");
+
+        auto failureJson = apiConfJson->getObject("Failure");
+        if (!failureJson.isNull()) {
+            FailurePolicyConf& failure = m_appConf.apiConf.failurePolicy;
+            failure.breakerThreshold   = failureJson->optValue<int>("BreakerThreshold", failure.breakerThreshold);
+            failure.breakerOpenSec     = failureJson->optValue<int>("BreakerOpenSec", failure.breakerOpenSec);
+            failure.notFoundTtl        = failureJson->optValue<int>("NotFoundTTL", failure.notFoundTtl);
+        }
+
         auto apiQualityJson                    = apiConfJson->getObject("Quality");
         m_appConf.apiConf.imageDownloadQuality = apiQualityJson->getValue<std::string>("ImageDownload");
         m_appConf.apiConf.imagePreviewQuality  = apiQualityJson->getValue<std::string>("ImagePreview");
@@ -206,6 +303,11 @@ bool Config::ParseConfFile()
         }
 
         m_appConf.ffprobePath = jsonPtr->optValue<std::string>("ffprobePath", "");
+
+        // 图片仓库与媒体目录位于同一文件系统时才能使用硬链接, 否则退化为复制
+        m_appConf.artworkStorePath = jsonPtr->optValue<std::string>("ArtworkStore", m_appConf.artworkStorePath);
+
+        m_appConf.autoMatchThreshold = jsonPtr->optValue<double>("AutoMatchThreshold", AUTO_MATCH_THRESHOLD);
     } catch (Poco::Exception& e) {
         LOG_ERROR("Parse conf file {} failed: {}", m_confFile, e.displayText());
         return false;
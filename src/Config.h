@@ -9,8 +9,10 @@
 
 #include "CommonType.h"
 
-const int DEFAULT_HTTP_SERVER_PORT = 54250; // 默认的HTTP服务器监听端口
-const int AUTO_INTERVAL            = 300;   // 默认的自动刮削间隔, 单位: 秒
+const int    DEFAULT_HTTP_SERVER_PORT = 54250; // 默认的HTTP服务器监听端口
+const int    AUTO_INTERVAL            = 300;   // 默认的自动刮削间隔, 单位: 秒
+const double API_RATE_LIMIT           = 20;    // 默认的API请求速率上限, 单位: 次/秒
+const double AUTO_MATCH_THRESHOLD     = 0.85;  // 默认的自动匹配置信度阈值
 
 /**
  * @brief 与网络相关的配置项
@@ -40,17 +42,51 @@ enum ApiUrlType {
     IMAGE_DOWNLOAD,
 };
 
+/**
+ * @brief API的URL类型与配置文件中名称的映射
+ *
+ */
+extern const std::map<ApiUrlType, std::string> API_URL_TYPE_TO_STR;
+
+/**
+ * @brief 单个API的超时与重试策略
+ *
+ */
+struct RequestPolicyConf {
+    int connectTimeout  = 5;    // 建立连接的超时时间, 单位: 秒
+    int readTimeout     = 5;    // 单次读取的超时时间, 单位: 秒
+    int totalTimeout    = 30;   // 包含重试在内的总超时时间, 单位: 秒
+    int maxRetries      = 2;    // 最大重试次数
+    int backoffBaseMs   = 500;  // 退避的基础时间, 单位: 毫秒, 每次重试翻倍并加入随机抖动
+    int backoffMaxMs    = 8000; // 退避的最大时间, 单位: 毫秒
+    int hedgePercentile = 95;   // 耗时超过该分位数时发起对冲请求, 0表示关闭
+};
+
+/**
+ * @brief 上游故障的处理策略
+ *
+ */
+struct FailurePolicyConf {
+    int breakerThreshold = 5;     // 触发熔断的连续失败次数, 0表示关闭熔断
+    int breakerOpenSec   = 30;    // 熔断后探测恢复前的冷却时间, 单位: 秒
+    int notFoundTtl      = 86400; // TMDB返回404的请求在该时间内直接跳过, 单位: 秒, 0表示不缓存
+};
+
 /**
  * @brief API相关的配置项
  *
  */
 struct ApiConf {
-    std::string                       apiKey;               // API秘钥
-    std::map<ApiUrlType, std::string> apiUrls;              // API的URL
-    int                               downloadTimeout;      // 图像下载的超时时间
-    int                               jsonTimeout;          // 获取JSON的超时时间
-    std::string                       imageDownloadQuality; // 图像下载的质量
-    std::string                       imagePreviewQuality;  // 图像预览的质量
+    std::string                             apiKey;               // API秘钥
+    std::map<ApiUrlType, std::string>       apiUrls;              // API的URL
+    int                                     downloadTimeout;      // 图像下载的超时时间
+    int                                     jsonTimeout;          // 获取JSON的超时时间
+    std::map<ApiUrlType, RequestPolicyConf> requestPolicies;      // 各个API的超时与重试策略
+    double                                  rateLimit;            // API请求速率上限(不含图像下载), 单位: 次/秒
+    FailurePolicyConf                       failurePolicy;        // 上游故障的处理策略
+    std::string                             fixtureRecordPath;    // 录制响应的目录, 为空时不录制
+    std::string                             imageDownloadQuality; // 图像下载的质量
+    std::string                             imagePreviewQuality;  // 图像预览的质量
 };
 
 /**
@@ -72,9 +108,11 @@ struct AppConf {
     std::string    logFile;
     ApiConf        apiConf;
     DataSourceConf dataSourceConf;
-    int            autoInterval = AUTO_INTERVAL; // 自动刮削的间隔
-    bool           isAuto;                       // 是否为自动刮削模式
-    std::string    ffprobePath;                  // ffprobe的路径, 用于读取视频元数据(HDR等)
+    int            autoInterval       = AUTO_INTERVAL;        // 自动刮削的间隔
+    bool           isAuto;                                    // 是否为自动刮削模式
+    std::string    ffprobePath;                               // ffprobe的路径, 用于读取视频元数据(HDR等)
+    std::string    artworkStorePath;                          // 本地图片仓库的路径
+    double         autoMatchThreshold = AUTO_MATCH_THRESHOLD; // 自动匹配直接刮削的置信度阈值
 };
 
 class Config
@@ -201,11 +239,54 @@ public:
      */
     std::string GetffprobePath();
 
+    /**
+     * @brief 获取本地图片仓库的路径
+     *
+     * @return std::string 本地图片仓库的路径
+     */
+    std::string GetArtworkStorePath();
+
     const std::map<VideoType, std::vector<std::string>>& GetPaths();
 
     const std::string& GetApiUrl(ApiUrlType apiUrlType);
     const std::string& GetApiKey();
 
+    /**
+     * @brief 获取API的超时与重试策略
+     *
+     * @param apiUrlType API的URL类型
+     * @return RequestPolicyConf 超时与重试策略
+     */
+    RequestPolicyConf GetRequestPolicy(ApiUrlType apiUrlType);
+
+    /**
+     * @brief 获取API请求速率上限
+     *
+     * @return double 每秒最多发起的请求数
+     */
+    double GetRateLimit();
+
+    /**
+     * @brief 获取上游故障的处理策略(熔断与失败缓存)
+     *
+     * @return FailurePolicyConf 处理策略
+     */
+    FailurePolicyConf GetFailurePolicy();
+
+    /**
+     * @brief 获取录制TMDB响应的目录, 录制的响应可由模拟TMDB服务器回放
+     *
+     * @return std::string 录制响应的目录, 为空时不录制
+     */
+    std::string GetFixtureRecordPath();
+
+    /**
+     * @brief 获取自动匹配的置信度阈值, 高于该值时直接刮削, 否则进入待确认队列
+     *
+     * @return double 置信度阈值, 取值范围[0, 1]
+     */
+    double GetAutoMatchThreshold();
+
     /**
      * @brief 保存配置到配置文件
      *
@@ -225,8 +306,17 @@ private:
         m_appConf.logLevel                = 2; // spdlog::level::info
         m_appConf.apiConf.downloadTimeout = 15;
         m_appConf.apiConf.jsonTimeout     = 5;
+        m_appConf.apiConf.rateLimit       = API_RATE_LIMIT;
+        m_appConf.artworkStorePath        = DefaultArtworkStorePath();
     };
 
+    /**
+     * @brief 获取默认的本地图片仓库路径
+     *
+     * @return std::string 默认的本地图片仓库路径
+     */
+    static std::string DefaultArtworkStorePath();
+
     /**
      * @brief 获取配置文件的路径
      *
@@ -1,6 +1,8 @@
 #include "DataConvert.h"
 
 #include <fstream>
+#include <set>
+#include <sstream>
 
 #include <Poco/AutoPtr.h>
 #include <Poco/DOM/DOMParser.h>
@@ -8,98 +10,122 @@
 #include <Poco/DOM/Document.h>
 #include <Poco/DOM/NodeList.h>
 #include <Poco/DOM/Text.h>
+#include <Poco/DigestEngine.h>
+#include <Poco/Exception.h>
 #include <Poco/JSON/Parser.h>
 #include <Poco/Path.h>
+#include <Poco/SAX/Attributes.h>
+#include <Poco/SAX/DefaultHandler.h>
+#include <Poco/SAX/InputSource.h>
+#include <Poco/SAX/SAXParser.h>
+#include <Poco/SHA1Engine.h>
 #include <Poco/StreamCopier.h>
 #include <Poco/XML/XMLWriter.h>
 
+#include "DataSource.h"
 #include "HDRToolKit.h"
+#include "JsonWriter.h"
 #include "Logger.h"
+#include "SearchIndex.h"
 
 using Poco::AutoPtr;
 using namespace Poco::XML;
 using namespace Poco::JSON;
 
-void VideoInfoToBriefJson(const VideoInfo& videoInfo, Object& outJson)
+const std::string EPISODE_NFO_HASH_PREFIX = "content-sha1:"; // 剧集NFO中内容哈希注释的前缀
+
+void VideoInfoToBriefJson(const VideoInfo& videoInfo, JsonWriter& writer)
+{
+    writer.Field("VideoType", VIDEO_TYPE_TO_STR.at(videoInfo.videoType));
+    writer.Field("VideoPath", videoInfo.videoPath);
+    writer.Field("NfoStatus", static_cast<int>(videoInfo.nfoStatus));
+    writer.Field("PosterStatus", static_cast<int>(videoInfo.posterStatus));
+    writer.Field("HDRType", VIDEO_RANGE_TYPE_TO_STR_MAP.at(videoInfo.hdrType));
+}
+
+template <typename Str>
+static void WriteStrArray(JsonWriter& writer, const char* key, const std::vector<Str>& strs)
 {
-    outJson.set("VideoType", VIDEO_TYPE_TO_STR.at(videoInfo.videoType));
-    outJson.set("VideoPath", videoInfo.videoPath);
-    outJson.set("NfoStatus", static_cast<int>(videoInfo.nfoStatus));
-    outJson.set("PosterStatus", static_cast<int>(videoInfo.posterStatus));
-    outJson.set("HDRType", VIDEO_RANGE_TYPE_TO_STR_MAP.at(videoInfo.hdrType));
+    writer.Key(key).StartArray();
+    for (const std::string& str : strs) {
+        writer.Value(str);
+    }
+    writer.EndArray();
 }
 
-void VideoInfoToDetailedJson(const VideoInfo& videoInfo, Object& outJson)
+void VideoInfoToDetailedJson(const VideoInfo& videoInfo, JsonWriter& writer)
 {
-    VideoInfoToBriefJson(videoInfo, outJson);
-    outJson.set("VideoPath", videoInfo.videoPath);
-    outJson.set("NfoPath", videoInfo.nfoPath);
-    outJson.set("PosterPath", videoInfo.posterPath);
+    VideoInfoToBriefJson(videoInfo, writer);
+    writer.Field("NfoPath", DataSource::GetNfoPath(videoInfo));
+    writer.Field("PosterPath", DataSource::GetPosterPath(videoInfo));
 
-    Object videoDetailJson;
+    writer.Key("VideoDetail").StartObject();
     if (videoInfo.videoType == TV) {
-        videoDetailJson.set("EpisodeNfoCount", videoInfo.videoDetail.episodeNfoCount);
-        videoDetailJson.set("EpisodeCount", videoInfo.videoDetail.episodePaths.size());
-        Array episodePathsArrJson;
-        for (const auto& episodePath : videoInfo.videoDetail.episodePaths) {
-            episodePathsArrJson.add(episodePath);
-        }
-        videoDetailJson.set("EpisodePaths", episodePathsArrJson);
+        writer.Field("EpisodeNfoCount", videoInfo.videoDetail.episodeNfoCount);
+        writer.Field("EpisodeCount", videoInfo.videoDetail.episodePaths.size());
+        WriteStrArray(writer, "EpisodePaths", videoInfo.videoDetail.episodePaths);
     }
 
     // 如果NFO文件格式匹配, 则额外填写NFO的信息
     if (videoInfo.nfoStatus == FILE_FORMAT_MATCH) {
-        videoDetailJson.set("Title", videoInfo.videoDetail.title);
-        videoDetailJson.set("OriginalTitle", videoInfo.videoDetail.originaltitle);
-
-        Object ratingsJson;
-        ratingsJson.set("Rating", videoInfo.videoDetail.ratings.rating);
-        ratingsJson.set("Votes", videoInfo.videoDetail.ratings.votes);
-        videoDetailJson.set("Ratings", ratingsJson);
-
-        videoDetailJson.set("Plot", videoInfo.videoDetail.plot);
-        videoDetailJson.set("Uniqueid", videoInfo.videoDetail.uniqueid.at("tmdb"));
-
-        Array genreArrJson;
-        for (const auto& genre : videoInfo.videoDetail.genre) {
-            genreArrJson.add(genre);
+        const VideoDetail& videoDetail = videoInfo.videoDetail;
+        writer.Field("Title", videoDetail.title);
+        writer.Field("OriginalTitle", videoDetail.originaltitle);
+
+        writer.Key("Ratings").StartObject();
+        writer.Field("Rating", videoDetail.ratings.rating);
+        writer.Field("Votes", videoDetail.ratings.votes);
+        writer.EndObject();
+
+        writer.Field("Plot", videoDetail.plot);
+        auto tmdbIter = videoDetail.uniqueid.find("tmdb");
+        if (tmdbIter != videoDetail.uniqueid.end()) {
+            writer.Field("Uniqueid", tmdbIter->second);
         }
-        videoDetailJson.set("Genre", genreArrJson);
-
-        Array contriesArrJson;
-        for (const auto& country : videoInfo.videoDetail.countries) {
-            contriesArrJson.add(country);
+        WriteStrArray(writer, "Genre", videoDetail.genre);
+        WriteStrArray(writer, "Countries", videoDetail.countries);
+        WriteStrArray(writer, "Credits", videoDetail.credits);
+        writer.Field("Director", videoDetail.director);
+        writer.Field("Premiered", videoDetail.premiered);
+        WriteStrArray(writer, "Studio", videoDetail.studio);
+
+        writer.Key("Actors").StartArray();
+        for (const auto& actor : videoDetail.actors) {
+            writer.StartObject();
+            writer.Field("name", actor.name);
+            writer.Field("role", actor.role);
+            writer.Field("thumb", actor.thumb);
+            writer.EndObject();
         }
-        videoDetailJson.set("Countries", contriesArrJson);
-
-        Array creditsArrJson;
-        for (const auto& credit : videoInfo.videoDetail.credits) {
-            creditsArrJson.add(credit);
-        }
-        videoDetailJson.set("Credits", creditsArrJson);
-
-        videoDetailJson.set("Director", videoInfo.videoDetail.director);
-        videoDetailJson.set("Premiered", videoInfo.videoDetail.premiered);
-        videoDetailJson.set("Studio", videoInfo.videoDetail.studio);
-
-        Array actorsArrJson;
-        for (const auto& actor : videoInfo.videoDetail.actors) {
-            Object actorJson;
-            actorJson.set("name", actor.name);
-            actorJson.set("role", actor.role);
-            // actorJson.set("order", actor.order);
-            actorJson.set("thumb", actor.thumb);
-            actorsArrJson.add(actorJson);
-        }
-        videoDetailJson.set("Actors", actorsArrJson);
+        writer.EndArray();
 
         // 电视剧额外填写剧集相关的信息
         if (videoInfo.videoType == TV) {
-            videoDetailJson.set("SeasonNumber", videoInfo.videoDetail.seasonNumber);
-            videoDetailJson.set("Status", videoInfo.videoDetail.isEnded ? "Ended" : "Continuing");
+            writer.Field("SeasonNumber", videoDetail.seasonNumber);
+            writer.Field("Status", videoDetail.isEnded ? "Ended" : "Continuing");
         }
     }
-    outJson.set("VideoDetail", videoDetailJson);
+    writer.EndObject();
+}
+
+std::string VideoInfoToBriefJsonStr(const VideoInfo& videoInfo)
+{
+    std::ostringstream oss;
+    JsonWriter         writer(oss);
+    writer.StartObject();
+    VideoInfoToBriefJson(videoInfo, writer);
+    writer.EndObject();
+    return oss.str();
+}
+
+std::string VideoInfoToDetailedJsonStr(const VideoInfo& videoInfo)
+{
+    std::ostringstream oss;
+    JsonWriter         writer(oss);
+    writer.StartObject();
+    VideoInfoToDetailedJson(videoInfo, writer);
+    writer.EndObject();
+    return oss.str();
 }
 
 bool VideoInfoToNfo(const VideoInfo&   videoInfo,
@@ -238,18 +264,45 @@ std::string GetNodeValByPath(Node* parentNode, const std::string& nodePath, std:
     return val;
 };
 
+/**
+ * @brief 清空从NFO解析的字段, 重复解析时覆盖而不是追加
+ *
+ * @param videoInfo 视频信息
+ */
+static void ClearNfoFields(VideoInfo& videoInfo)
+{
+    VideoDetail& videoDetail  = videoInfo.videoDetail;
+    videoDetail.title         = std::string();
+    videoDetail.originaltitle = std::string();
+    videoDetail.ratings       = RatingDetail{0.0, 0};
+    videoDetail.plot          = std::string();
+    videoDetail.director      = InternedString();
+    videoDetail.premiered     = std::string();
+    videoDetail.uniqueid.clear();
+    videoDetail.genre.clear();
+    videoDetail.countries.clear();
+    videoDetail.studio.clear();
+    videoDetail.actors.clear();
+    videoInfo.plotTerms.clear();
+    if (videoInfo.videoType == TV) {
+        videoDetail.seasonNumber = 1;
+        videoDetail.isEnded      = true;
+    }
+}
+
 bool ParseNfoToVideoInfo(VideoInfo& videoInfo)
 {
     // NFO文件的状态必须是格式匹配的
     if (videoInfo.nfoStatus != FILE_FORMAT_MATCH) {
-        LOG_ERROR("Nfo format mismatch: {}", videoInfo.nfoPath);
+        LOG_ERROR("Nfo format mismatch: {}", DataSource::GetNfoPath(videoInfo));
         return false;
     }
 
     // 获取根节点
     DOMParser         parser;
-    AutoPtr<Document> dom         = parser.parse(videoInfo.nfoPath);
+    AutoPtr<Document> dom         = parser.parse(DataSource::GetNfoPath(videoInfo));
     auto              rootElement = dom->documentElement();
+    ClearNfoFields(videoInfo);
 
     videoInfo.videoDetail.title         = GetNodeValByPath<std::string>(rootElement, "/title");
     videoInfo.videoDetail.originaltitle = GetNodeValByPath<std::string>(rootElement, "/originaltitle");
@@ -309,31 +362,200 @@ bool ParseNfoToVideoInfo(VideoInfo& videoInfo)
     return true;
 }
 
-bool WriteEpisodeNfo(const Array::Ptr                jsonArrPtr,
-                     const std::vector<std::string>& episodePaths,
-                     int                             seasonId,
-                     bool                            forceUseOnlineTvMeta)
+/**
+ * @brief 与GetNodeValByPath相同的规则转换节点的文本
+ *
+ * @param text 节点的文本
+ * @param defaultVal 转换失败时的默认值
+ * @return T 转换结果
+ */
+template <typename T>
+static T ParseNodeText(const std::string& text, T defaultVal)
+{
+    T                  val = defaultVal;
+    std::istringstream iSS(text);
+    iSS >> val;
+    return val;
+}
+
+/**
+ * @brief 提取NFO简要信息的SAX处理器, 字段的取值规则与ParseNfoToVideoInfo一致:
+ *        根节点下的单值字段取第一个, 分类, 国家, 制片厂, 演员与ID不限层级; 剧情只保留切分后的检索词
+ */
+class BriefNfoHandler : public DefaultHandler
+{
+public:
+
+    explicit BriefNfoHandler(VideoInfo& videoInfo) : m_videoInfo(videoInfo) {}
+
+    bool IsRootMatch() const
+    {
+        return m_isRootMatch;
+    }
+
+    void startElement(const XMLString&,
+                      const XMLString&  localName,
+                      const XMLString&  qname,
+                      const Attributes& attrs) override
+    {
+        m_path.push_back(localName.empty() ? qname : localName);
+        m_text.clear();
+
+        const std::string& name = m_path.back();
+        if (m_path.size() == 1) {
+            m_isRootMatch = DataSource::IsNfoRootName(name);
+        } else if (name == "uniqueid") {
+            m_idType = attrs.getValue("type");
+        } else if (name == "actor") {
+            m_actor       = ActorDetail();
+            m_actor.order = m_actorNum++;
+        }
+    }
+
+    void endElement(const XMLString&, const XMLString&, const XMLString&) override
+    {
+        VideoDetail&       videoDetail = m_videoInfo.videoDetail;
+        const std::string& name        = m_path.back();
+        const bool         inActor     = m_path.size() >= 2 && m_path[m_path.size() - 2] == "actor";
+
+        if (name == "uniqueid") {
+            // FIXME: IMDB的ID包含字母"tt", 暂时只解析"themoviedb"的ID
+            if (m_idType == "tmdb") {
+                videoDetail.uniqueid[m_idType] = std::stoi(m_text);
+            }
+        } else if (name == "genre") {
+            videoDetail.genre.push_back(m_text);
+        } else if (name == "country") {
+            videoDetail.countries.push_back(m_text);
+        } else if (name == "studio") {
+            videoDetail.studio.push_back(m_text);
+        } else if (name == "actor") {
+            videoDetail.actors.push_back(m_actor);
+        } else if (inActor && name == "name") {
+            m_actor.name = m_text;
+        } else if (inActor && name == "order") {
+            m_actor.order = ParseNodeText<int>(m_text, m_actor.order);
+        } else if (m_path.size() == 2 && m_seen.insert(name).second) {
+            if (name == "title") {
+                videoDetail.title = m_text;
+            } else if (name == "originaltitle") {
+                videoDetail.originaltitle = m_text;
+            } else if (name == "director") {
+                videoDetail.director = m_text;
+            } else if (name == "premiered") {
+                videoDetail.premiered = m_text;
+            } else if (name == "plot") {
+                // 剧情只切分为检索词, 不保留原文
+                SearchIndex::CollectPlotTerms(m_text, m_videoInfo.plotTerms);
+            } else if (name == "season" && m_videoInfo.videoType == TV) {
+                videoDetail.seasonNumber = ParseNodeText<int>(m_text, 1);
+            } else if (name == "status" && m_videoInfo.videoType == TV) {
+                videoDetail.isEnded = m_text == "Ended";
+            }
+        } else if (m_path.size() == 4 && m_path[1] == "ratings" && m_path[2] == "rating" &&
+                   m_seen.insert("ratings/rating/" + name).second) {
+            if (name == "value") {
+                videoDetail.ratings.rating = ParseNodeText<double>(m_text, 0.0);
+            } else if (name == "votes") {
+                videoDetail.ratings.votes = ParseNodeText<int>(m_text, 0);
+            }
+        }
+
+        m_path.pop_back();
+        m_text.clear();
+    }
+
+    void characters(const XMLChar ch[], int start, int length) override
+    {
+        m_text.append(ch + start, length);
+    }
+
+private:
+
+    VideoInfo&               m_videoInfo;           // 保存解析结果
+    std::vector<std::string> m_path;                // 从根节点到当前节点的名称
+    std::string              m_text;                // 当前节点的文本
+    std::string              m_idType;              // 当前uniqueid节点的类型
+    std::set<std::string>    m_seen;                // 已经解析过的单值字段
+    ActorDetail              m_actor;               // 当前的演员
+    int                      m_actorNum    = 0;     // 已遇到的演员数, 作为默认的排序顺序
+    bool                     m_isRootMatch = false; // 根节点名称是否匹配
+};
+
+bool ParseNfoBriefToVideoInfo(VideoInfo& videoInfo)
+{
+    const std::string nfoPath = DataSource::GetNfoPath(videoInfo);
+    std::ifstream     ifs(nfoPath, std::ios::binary);
+    if (!ifs.is_open()) {
+        LOG_ERROR("Can't open file {} for read.", nfoPath);
+        return false;
+    }
+
+    // 解析到副本中, 失败时不修改原视频信息
+    VideoInfo brief(videoInfo);
+    ClearNfoFields(brief);
+    try {
+        BriefNfoHandler handler(brief);
+        SAXParser       parser;
+        parser.setContentHandler(&handler);
+        InputSource source(ifs);
+        parser.parse(&source);
+        if (!handler.IsRootMatch()) {
+            LOG_DEBUG("Nfo root node's name doesn't match, path: {}", nfoPath);
+            return false;
+        }
+    } catch (Poco::Exception& e) {
+        LOG_ERROR("Nfo parsed failed, reason: {}, path: {}", e.displayText(), nfoPath);
+        return false;
+    } catch (std::exception& e) {
+        LOG_ERROR("Nfo parsed failed, reason: {}, path: {}", e.what(), nfoPath);
+        return false;
+    }
+
+    videoInfo = std::move(brief);
+    return true;
+}
+
+/**
+ * @brief 读取剧集NFO文件中记录的内容哈希
+ *
+ * @param nfoPath NFO文件路径
+ * @return std::string 内容哈希, 文件不存在或者没有记录时为空
+ */
+static std::string ReadEpisodeNfoHash(const std::string& nfoPath)
+{
+    std::ifstream ifs(nfoPath);
+    std::string   line;
+    // 哈希注释紧跟在XML声明之后
+    for (int i = 0; i < 2 && std::getline(ifs, line); i++) {
+        auto pos = line.find(EPISODE_NFO_HASH_PREFIX);
+        if (pos != std::string::npos) {
+            auto begin = pos + EPISODE_NFO_HASH_PREFIX.size();
+            auto end   = line.find(' ', begin);
+            return line.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+        }
+    }
+    return "";
+}
+
+bool WriteEpisodeNfo(const std::vector<EpisodeDetail>& episodeDetails,
+                     const std::vector<CompactPath>&   episodePaths,
+                     int                               seasonId,
+                     bool                              forceUseOnlineTvMeta)
 {
     // TODO: 如果TMDB提供的剧集数量与本地数量不符, 是否使用内置规则生成默认标题
     bool isEpisodeCountMatch = false;
-    if (jsonArrPtr->size() == episodePaths.size()) {
+    if (episodeDetails.size() == episodePaths.size()) {
         isEpisodeCountMatch = true;
     } else {
         LOG_WARN(
-            "TMDB API returns mismatched episode count! api: {}, local: {}", jsonArrPtr->size(), episodePaths.size());
+            "TMDB API returns mismatched episode count! api: {}, local: {}", episodeDetails.size(), episodePaths.size());
     }
 
+    size_t writtenCount = 0;
     for (size_t i = 0; i < episodePaths.size(); i++) {
-        const std::string& episodeNfoPath =
-            Poco::Path(episodePaths.at(i)).parent().toString() + Poco::Path(episodePaths.at(i)).getBaseName() + ".nfo";
-        std::ofstream ofs(episodeNfoPath);
-        if (!ofs.is_open()) {
-            LOG_ERROR("Can't open file {} for write.", episodeNfoPath);
-            return false;
-        }
-
-        // TODO: 使用XML方式写入process instruction
-        ofs << R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)" << std::endl;
+        const Poco::Path   episodePath(episodePaths.at(i).str());
+        const std::string& episodeNfoPath = episodePath.parent().toString() + episodePath.getBaseName() + ".nfo";
 
         AutoPtr<Document> dom     = new Document();
         AutoPtr<Element>  rootEle = dom->createElement("episodedetails");
@@ -346,22 +568,20 @@ bool WriteEpisodeNfo(const Array::Ptr                jsonArrPtr,
             parent->appendChild(ele);
         };
 
-        auto episodeJsonPtr = jsonArrPtr->getObject(i);
         if (isEpisodeCountMatch) {
-            std::string title = episodeJsonPtr->getValue<std::string>("name");
-            createAndAppendText(rootEle, "title", title);
-            createAndAppendText(rootEle, "season", std::to_string(episodeJsonPtr->getValue<int>("season_number")));
-            createAndAppendText(rootEle, "episode", std::to_string(episodeJsonPtr->getValue<int>("episode_number")));
-            createAndAppendText(rootEle, "plot", episodeJsonPtr->getValue<std::string>("overview"));
+            const auto& episodeDetail = episodeDetails.at(i);
+            createAndAppendText(rootEle, "title", episodeDetail.title);
+            createAndAppendText(rootEle, "season", std::to_string(episodeDetail.seasonNumber));
+            createAndAppendText(rootEle, "episode", std::to_string(episodeDetail.episodeNumber));
+            createAndAppendText(rootEle, "plot", episodeDetail.plot);
         } else {
             // 强制使用在线剧集元数据时, 大于在线集数的使用生成的元数据
-            if (forceUseOnlineTvMeta && i < jsonArrPtr->size()) {
-                std::string title = episodeJsonPtr->getValue<std::string>("name");
-                createAndAppendText(rootEle, "title", title);
-                createAndAppendText(rootEle, "season", std::to_string(episodeJsonPtr->getValue<int>("season_number")));
-                createAndAppendText(
-                    rootEle, "episode", std::to_string(episodeJsonPtr->getValue<int>("episode_number")));
-                createAndAppendText(rootEle, "plot", episodeJsonPtr->getValue<std::string>("overview"));
+            if (forceUseOnlineTvMeta && i < episodeDetails.size()) {
+                const auto& episodeDetail = episodeDetails.at(i);
+                createAndAppendText(rootEle, "title", episodeDetail.title);
+                createAndAppendText(rootEle, "season", std::to_string(episodeDetail.seasonNumber));
+                createAndAppendText(rootEle, "episode", std::to_string(episodeDetail.episodeNumber));
+                createAndAppendText(rootEle, "plot", episodeDetail.plot);
             } else {
                 createAndAppendText(rootEle, "title", "第" + std::to_string(i + 1) + "集");
                 createAndAppendText(rootEle, "season", std::to_string(seasonId));
@@ -371,12 +591,38 @@ bool WriteEpisodeNfo(const Array::Ptr                jsonArrPtr,
         }
 
         // TODO: 添加更多详细标签
-        DOMWriter writer;
+        std::ostringstream oss;
+        DOMWriter          writer;
         writer.setNewLine("\n");
         writer.setOptions(XMLWriter::PRETTY_PRINT);
-        writer.writeNode(ofs, dom);
+        writer.writeNode(oss, dom);
+        const std::string content = oss.str();
+
+        // 内容未变化的NFO不再写入, 避免媒体库重新导入所有剧集
+        Poco::SHA1Engine sha1;
+        sha1.update(content);
+        const std::string hash = Poco::DigestEngine::digestToHex(sha1.digest());
+        if (ReadEpisodeNfoHash(episodeNfoPath) == hash) {
+            continue;
+        }
+
+        std::ofstream ofs(episodeNfoPath);
+        if (!ofs.is_open()) {
+            LOG_ERROR("Can't open file {} for write.", episodeNfoPath);
+            return false;
+        }
+
+        // TODO: 使用XML方式写入process instruction
+        ofs << R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)" << std::endl;
+        ofs << "<!-- " << EPISODE_NFO_HASH_PREFIX << hash << " -->" << std::endl;
+        ofs << content;
+        writtenCount++;
     }
 
+    LOG_DEBUG("Episode nfos of season {}: {} written, {} unchanged",
+              seasonId,
+              writtenCount,
+              episodePaths.size() - writtenCount);
     return true;
 }
 
@@ -3,12 +3,41 @@
 #include <Poco/JSON/Object.h>
 
 #include "CommonType.h"
+#include "JsonWriter.h"
 
 // TODO: 接口设计上优化形参, 部分接口设置不够合理
 
-void VideoInfoToBriefJson(const VideoInfo& videoInfo, Poco::JSON::Object& outJson);
+/**
+ * @brief 将视频的简要信息作为成员写入当前的JSON对象
+ *
+ * @param videoInfo 视频信息
+ * @param writer JSON生成器, 当前位于对象中
+ */
+void VideoInfoToBriefJson(const VideoInfo& videoInfo, JsonWriter& writer);
 
-void VideoInfoToDetailedJson(const VideoInfo& videoInfo, Poco::JSON::Object& outJson);
+/**
+ * @brief 将视频的详细信息作为成员写入当前的JSON对象
+ *
+ * @param videoInfo 视频信息
+ * @param writer JSON生成器, 当前位于对象中
+ */
+void VideoInfoToDetailedJson(const VideoInfo& videoInfo, JsonWriter& writer);
+
+/**
+ * @brief 将视频的简要信息序列化为JSON对象的文本, 用于JSON片段缓存
+ *
+ * @param videoInfo 视频信息
+ * @return std::string JSON对象的文本
+ */
+std::string VideoInfoToBriefJsonStr(const VideoInfo& videoInfo);
+
+/**
+ * @brief 将视频的详细信息序列化为JSON对象的文本, 用于JSON片段缓存
+ *
+ * @param videoInfo 视频信息
+ * @return std::string JSON对象的文本
+ */
+std::string VideoInfoToDetailedJsonStr(const VideoInfo& videoInfo);
 
 /**
  * @brief 
@@ -21,7 +50,7 @@ void VideoInfoToDetailedJson(const VideoInfo& videoInfo, Poco::JSON::Object& out
 bool VideoInfoToNfo(const VideoInfo& videoInfo, const std::string& nfoPath, bool setHDRTitle, const std::string& defaultIdType);
 
 /**
- * @brief 解析NFO文件
+ * @brief 完整解析NFO文件, 用于按需加载视频详情
  * 
  * @param videoInfo 保存解析结果的结构体引用
  * @return true 解析成功
@@ -30,15 +59,33 @@ bool VideoInfoToNfo(const VideoInfo& videoInfo, const std::string& nfoPath, bool
 bool ParseNfoToVideoInfo(VideoInfo& videoInfo);
 
 /**
- * @brief 
- * 
- * @param jsonObj 
- * @return true 
- * @return false 
+ * @brief 以SAX方式解析NFO文件的简要信息, 用于扫描
+ *
+ * 不构造DOM树, 同时校验根节点. 只提取列表, 过滤, 排序与搜索需要的字段: ID, 标题, 原始标题, 季编号, 完结状态,
+ * 评分, 首播日期, 分类, 国家, 导演, 制片厂与演员姓名; 剧情只切分为检索词存入plotTerms, 原文与编剧, 演员的角色与头像
+ * 只在详情中显示, 由ParseNfoToVideoInfo按需解析.
+ *
+ * @param videoInfo 保存解析结果的结构体引用, 失败时不修改
+ * @return true 根节点匹配且解析成功
+ * @return false 文件无法解析或者根节点不匹配
+ */
+bool ParseNfoBriefToVideoInfo(VideoInfo& videoInfo);
+
+/**
+ * @brief 写入剧集的NFO文件
+ *
+ * 每个NFO的开头以注释记录内容的SHA1, 与现有文件记录的哈希一致时跳过, 只写入缺失或者变化的NFO.
+ *
+ * @param episodeDetails 在线获取的剧集详情
+ * @param episodePaths 本地的剧集路径
+ * @param seasonId 季编号
+ * @param forceUseOnlineTvMeta 剧集数量不匹配时是否仍使用在线的剧集详情
+ * @return true 写入成功
+ * @return false 写入失败
  */
-bool WriteEpisodeNfo(const Poco::JSON::Array::Ptr    jsonArrPtr,
-                     const std::vector<std::string>& episodePaths,
-                     int                             seasonId,
-                     bool                            forceUseOnlineTvMeta);
+bool WriteEpisodeNfo(const std::vector<EpisodeDetail>& episodeDetails,
+                     const std::vector<CompactPath>&   episodePaths,
+                     int                               seasonId,
+                     bool                              forceUseOnlineTvMeta);
 
 bool SetTVEnded(const std::string& nfoPath);
@@ -11,6 +11,7 @@
 #include <Poco/DOM/DOMParser.h>
 #include <Poco/DOM/Document.h>
 #include <Poco/DirectoryIterator.h>
+#include <Poco/Exception.h>
 #include <Poco/File.h>
 #include <Poco/Path.h>
 #include <Poco/SortedDirectoryIterator.h>
@@ -38,7 +39,7 @@ bool DataSource::IsVideo(const std::string& suffix)
     return false;
 }
 
-bool DataSource::IsNfoFormatMatch(const std::string& nfoPath)
+bool DataSource::IsNfoRootName(const std::string& nodeName)
 {
     static const std::set<std::string> nodeNames = {
         "tvshow",
@@ -46,13 +47,18 @@ bool DataSource::IsNfoFormatMatch(const std::string& nfoPath)
         "episodedetails",
     };
 
+    return nodeNames.find(nodeName) != nodeNames.end();
+}
+
+bool DataSource::IsNfoFormatMatch(const std::string& nfoPath)
+{
     // 获取根节点
     try {
         DOMParser         parser;
         AutoPtr<Document> dom         = parser.parse(nfoPath);
         auto              rootElement = dom->documentElement();
         // 根节点名称必须在指定范围内
-        if (nodeNames.find(rootElement->nodeName()) == nodeNames.end()) {
+        if (!IsNfoRootName(rootElement->nodeName())) {
             LOG_DEBUG("Nfo root node's name({}) doesn't match, path: {}", rootElement->nodeName(), nfoPath);
             return false;
         } else {
@@ -137,7 +143,7 @@ void GetHdrFormat(VideoInfo& videoInfo)
             break;
         }
         case VideoType::TV: {
-            videoPath = videoInfo.videoDetail.episodePaths.front(); // 电视剧取第一集来检测HDR格式
+            videoPath = videoInfo.videoDetail.episodePaths.front().str(); // 电视剧取第一集来检测HDR格式
             break;
         }
         default: {
@@ -153,12 +159,10 @@ void GetHdrFormat(VideoInfo& videoInfo)
 // TODO: 检查是否有多个匹配的海报和nfo文件(依据Kodi的wiki说明)
 void DataSource::CheckVideoStatus(VideoInfo& videoInfo, bool forceDetectHdr)
 {
-    // 检查NFO文件是否存在
+    // 检查NFO文件是否存在, 扫描时只解析简要信息, 完整的详情在查看时按需解析
     auto CheckNfo = [&](const std::string& nfoName) {
         if (Poco::File(nfoName).exists()) {
-            videoInfo.nfoStatus = IsNfoFormatMatch(nfoName) == true ? FILE_FORMAT_MATCH : FILE_FORMAT_MISMATCH;
-            videoInfo.nfoPath   = nfoName;
-            ParseNfoToVideoInfo(videoInfo);
+            videoInfo.nfoStatus = ParseNfoBriefToVideoInfo(videoInfo) ? FILE_FORMAT_MATCH : FILE_FORMAT_MISMATCH;
         } else {
             videoInfo.nfoStatus = FILE_NOT_FOUND;
         }
@@ -168,7 +172,6 @@ void DataSource::CheckVideoStatus(VideoInfo& videoInfo, bool forceDetectHdr)
     auto CheckPoster = [&](const std::string& posterName) {
         if (Poco::File(posterName).exists()) {
             videoInfo.posterStatus = IsJpgCompleted(posterName) == true ? FILE_FORMAT_MATCH : FILE_FORMAT_MISMATCH;
-            videoInfo.posterPath   = posterName;
         } else {
             videoInfo.posterStatus = FILE_NOT_FOUND;
         }
@@ -177,7 +180,6 @@ void DataSource::CheckVideoStatus(VideoInfo& videoInfo, bool forceDetectHdr)
     auto CheckFanart = [&](const std::string& fanartPath) {
         if (Poco::File(fanartPath).exists()) {
             videoInfo.fanartStatus = IsJpgCompleted(fanartPath) == true ? FILE_FORMAT_MATCH : FILE_FORMAT_MISMATCH;
-            videoInfo.fanartPath   = fanartPath;
         } else {
             videoInfo.fanartStatus = FILE_NOT_FOUND;
         }
@@ -187,45 +189,38 @@ void DataSource::CheckVideoStatus(VideoInfo& videoInfo, bool forceDetectHdr)
         if (Poco::File(clearlogoPath).exists()) {
             videoInfo.clearlogoStatus =
                 IsPNGCompleted(clearlogoPath) == true ? FILE_FORMAT_MATCH : FILE_FORMAT_MISMATCH;
-            videoInfo.clearlogoPath = clearlogoPath;
         } else {
             videoInfo.clearlogoStatus = FILE_NOT_FOUND;
         }
     };
 
+    // 以视频文件(电视剧为目录)的创建时间作为加入媒体库的时间, 用于列表排序
+    auto CheckAddedTime = [&]() {
+        try {
+            videoInfo.addedTime = Poco::File(videoInfo.videoPath).created().epochTime();
+        } catch (Poco::Exception& e) {
+            LOG_WARN("Get created time failed for {}: {}", videoInfo.videoPath, e.displayText());
+        }
+    };
+
     auto CheckEpisodes = [&]() {
         const auto& episodePaths = videoInfo.videoDetail.episodePaths;
         for (const auto& episodePath : episodePaths) {
-            const std::string& baseNameWithDir =
-                Poco::Path(episodePath).parent().toString() + Poco::Path(episodePath).getBaseName();
+            const Poco::Path   path(episodePath.str());
+            const std::string& baseNameWithDir = path.parent().toString() + path.getBaseName();
             if (Poco::File(baseNameWithDir + ".nfo").exists() && IsNfoFormatMatch(baseNameWithDir + ".nfo")) {
                 videoInfo.videoDetail.episodeNfoCount++;
             }
         }
     };
 
+    CheckAddedTime();
     switch (videoInfo.videoType) {
         case MOVIE: {
-            const std::string& baseNameWithDir =
-                Poco::Path(videoInfo.videoPath).parent().toString() + Poco::Path(videoInfo.videoPath).getBaseName();
-            videoInfo.posterPath    = baseNameWithDir + "-poster.jpg";
-            videoInfo.fanartPath    = baseNameWithDir + "-fanart.jpg";
-            videoInfo.clearlogoPath = baseNameWithDir + "-clearlogo.jpg";
-            switch (videoInfo.videoFiletype) {
-                case IN_FOLDER: {
-                    const std::string& dirName = Poco::Path(videoInfo.videoPath).parent().toString();
-                    videoInfo.nfoPath          = dirName + "movie.nfo";
-                    break;
-                }
-                case NO_FOLDER: {
-                    videoInfo.nfoPath = baseNameWithDir + ".nfo";
-                    break;
-                }
-            };
-            CheckNfo(videoInfo.nfoPath);
-            CheckPoster(videoInfo.posterPath);
-            CheckFanart(videoInfo.fanartPath);
-            CheckClearlogo(videoInfo.clearlogoPath);
+            CheckNfo(GetNfoPath(videoInfo));
+            CheckPoster(GetPosterPath(videoInfo));
+            CheckFanart(GetFanartPath(videoInfo));
+            CheckClearlogo(GetClearlogoPath(videoInfo));
             if (m_ffprobeReady && forceDetectHdr) {
                 GetHdrFormat(videoInfo);
             } else {
@@ -236,15 +231,10 @@ void DataSource::CheckVideoStatus(VideoInfo& videoInfo, bool forceDetectHdr)
 
         // TODO: 支持TV的HDR检测
         case TV: {
-            const std::string& dirName = videoInfo.videoPath + Poco::Path::separator();
-            videoInfo.nfoPath          = dirName + "tvshow.nfo";
-            videoInfo.posterPath       = dirName + "poster.jpg";
-            videoInfo.fanartPath       = dirName + "fanart.jpg";
-            videoInfo.clearlogoPath    = dirName + "clearlogo.jpg";
-            CheckNfo(videoInfo.nfoPath);
-            CheckPoster(videoInfo.posterPath);
-            CheckFanart(videoInfo.fanartPath);
-            CheckClearlogo(videoInfo.clearlogoPath);
+            CheckNfo(GetNfoPath(videoInfo));
+            CheckPoster(GetPosterPath(videoInfo));
+            CheckFanart(GetFanartPath(videoInfo));
+            CheckClearlogo(GetClearlogoPath(videoInfo));
             CheckEpisodes();
             if (m_ffprobeReady && forceDetectHdr) {
                 GetHdrFormat(videoInfo);
@@ -280,6 +270,56 @@ bool DataSource::IsMetaCompleted(const VideoInfo& videoInfo)
     return true;
 }
 
+std::string DataSource::GetNfoPath(const VideoInfo& videoInfo)
+{
+    switch (videoInfo.videoType) {
+        case MOVIE: {
+            const Poco::Path path(videoInfo.videoPath);
+            switch (videoInfo.videoFiletype) {
+                case IN_FOLDER:
+                    return path.parent().toString() + "movie.nfo";
+                case NO_FOLDER:
+                    return path.parent().toString() + path.getBaseName() + ".nfo";
+                default:
+                    return "";
+            }
+        }
+        case TV:
+            return videoInfo.videoPath + Poco::Path::separator() + "tvshow.nfo";
+        default:
+            return "";
+    }
+}
+
+std::string DataSource::GetPosterPath(const VideoInfo& videoInfo)
+{
+    return GetArtworkPath(videoInfo, "poster.jpg");
+}
+
+std::string DataSource::GetFanartPath(const VideoInfo& videoInfo)
+{
+    return GetArtworkPath(videoInfo, "fanart.jpg");
+}
+
+std::string DataSource::GetClearlogoPath(const VideoInfo& videoInfo)
+{
+    return GetArtworkPath(videoInfo, "clearlogo.jpg");
+}
+
+std::string DataSource::GetArtworkPath(const VideoInfo& videoInfo, const std::string& fileName)
+{
+    switch (videoInfo.videoType) {
+        case MOVIE: {
+            const Poco::Path path(videoInfo.videoPath);
+            return path.parent().toString() + path.getBaseName() + "-" + fileName;
+        }
+        case TV:
+            return videoInfo.videoPath + Poco::Path::separator() + fileName;
+        default:
+            return "";
+    }
+}
+
 std::string DataSource::GetLargestFile(const std::string& path)
 {
     // 遍历文件
@@ -345,10 +385,12 @@ void DataSource::GetVideoPathesFromMovieSet(const std::string& path, std::vector
 
 bool DataSource::ScanMovie(const std::vector<std::string>& paths,
                            std::vector<VideoInfo>&         videoInfos,
+                           std::atomic<std::size_t>&       foundVideoNum,
                            std::atomic<std::size_t>&       processedVideoNum,
                            bool                            forceDetectHdr)
 {
     // 清除历史数据
+    foundVideoNum     = 0;
     processedVideoNum = 0;
 
     // 遍历所有电影数据源
@@ -394,6 +436,7 @@ bool DataSource::ScanMovie(const std::vector<std::string>& paths,
         }
     }
 
+    foundVideoNum = videoInfos.size();
     for (auto& videoInfo : videoInfos) {
         if (m_isCancel) {
             return false;
@@ -481,7 +524,7 @@ void DataSource::GetVideoPathesFromTVSet(const std::string& path, std::vector<Vi
             auto episodePaths = GetEpisodePaths(iter->path());
             if (!episodePaths.empty()) {
                 VideoInfo videoInfo(TV, iter->path());
-                videoInfo.videoDetail.episodePaths = episodePaths;
+                videoInfo.videoDetail.episodePaths.assign(episodePaths.begin(), episodePaths.end());
                 tempVideoInfos.push_back(videoInfo);
             } else {
                 LOG_WARN("No episodes found in {}", iter->path());
@@ -520,10 +563,12 @@ std::vector<std::string> DataSource::GetEpisodePaths(const std::string& tvPath)
 
 bool DataSource::ScanTv(const std::vector<std::string>& paths,
                         std::vector<VideoInfo>&         videoInfos,
+                        std::atomic<std::size_t>&       foundVideoNum,
                         std::atomic<std::size_t>&       processedVideoNum,
                         bool                            forceDetectHdr)
 {
     // 清除历史数据
+    foundVideoNum     = 0;
     processedVideoNum = 0;
 
     // 遍历所有电视剧数据源
@@ -548,7 +593,7 @@ bool DataSource::ScanTv(const std::vector<std::string>& paths,
                 auto episodePaths = GetEpisodePaths(iter->path());
                 if (!episodePaths.empty()) {
                     VideoInfo videoInfo(TV, iter->path());
-                    videoInfo.videoDetail.episodePaths = episodePaths;
+                    videoInfo.videoDetail.episodePaths.assign(episodePaths.begin(), episodePaths.end());
                     videoInfo.videoFiletype            = IN_FOLDER;
                     videoInfos.push_back(videoInfo);
                 } else {
@@ -559,6 +604,7 @@ bool DataSource::ScanTv(const std::vector<std::string>& paths,
         }
     }
 
+    foundVideoNum = videoInfos.size();
     for (auto& videoInfo : videoInfos) {
         if (m_isCancel) {
             return false;
@@ -574,6 +620,7 @@ bool DataSource::ScanTv(const std::vector<std::string>& paths,
 bool DataSource::Scan(VideoType                       videoType,
                       const std::vector<std::string>& paths,
                       std::vector<VideoInfo>&         videoInfos,
+                      std::atomic<std::size_t>&       foundVideoNum,
                       std::atomic<std::size_t>&       processedVideoNum,
                       bool                            forceDetectHdr)
 {
@@ -586,15 +633,15 @@ bool DataSource::Scan(VideoType                       videoType,
     /* clang-format off */
     // 扫描视频的函数映射表
     using namespace std::placeholders;
-    static std::map<VideoType, std::function<bool(const std::vector<std::string>&, std::vector<VideoInfo>&, std::atomic<std::size_t>&, bool)>> scanFunc = {
-        {MOVIE,     std::bind(&DataSource::ScanMovie,    _1, _2, _3, _4)},
-        {TV,        std::bind(&DataSource::ScanTv,       _1, _2, _3, _4)},
-        {MOVIE_SET, std::bind(&DataSource::ScanMovieSet, _1, _2, _3, _4)},
+    static std::map<VideoType, std::function<bool(const std::vector<std::string>&, std::vector<VideoInfo>&, std::atomic<std::size_t>&, std::atomic<std::size_t>&, bool)>> scanFunc = {
+        {MOVIE,     std::bind(&DataSource::ScanMovie,    _1, _2, _3, _4, _5)},
+        {TV,        std::bind(&DataSource::ScanTv,       _1, _2, _3, _4, _5)},
+        {MOVIE_SET, std::bind(&DataSource::ScanMovieSet, _1, _2, _3, _4, _5)},
     };
     /* clang-format on */
 
     // TODO: paths索引检测
-    return scanFunc.at(videoType)(paths, videoInfos, processedVideoNum, forceDetectHdr);
+    return scanFunc.at(videoType)(paths, videoInfos, foundVideoNum, processedVideoNum, forceDetectHdr);
 }
 
 void DataSource::Cancel()
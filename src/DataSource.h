@@ -12,9 +12,22 @@ class DataSource
 {
 public:
 
+    /**
+     * @brief 扫描数据源
+     *
+     * @param videoType 视频类型
+     * @param paths 数据源的路径
+     * @param videoInfos 输出扫描到的视频信息
+     * @param foundVideoNum 输出已发现的视频数, 用于在扫描过程中显示进度
+     * @param processedVideoNum 输出已检查状态的视频数
+     * @param forceDetectHdr 是否强制检测HDR类型
+     * @return true 扫描完成
+     * @return false 扫描被取消
+     */
     static bool Scan(VideoType                       videoType,
                      const std::vector<std::string>& paths,
                      std::vector<VideoInfo>&         videoInfos,
+                     std::atomic<std::size_t>&       foundVideoNum,
                      std::atomic<std::size_t>&       processedVideoNum,
                      bool                            forceDetectHdr = false);
 
@@ -24,6 +37,49 @@ public:
 
     static bool IsMetaCompleted(const VideoInfo& videoInfo);
 
+    /**
+     * @brief NFO根节点的名称是否为支持的类型(tvshow, movie, episodedetails)
+     *
+     * @param nodeName 根节点的名称
+     * @return true 支持
+     * @return false 不支持
+     */
+    static bool IsNfoRootName(const std::string& nodeName);
+
+    /**
+     * @brief 按命名规则推导NFO文件的路径
+     *
+     * 电影: 在独立目录中为"movie.nfo", 否则为"<视频文件名>.nfo"; 电视剧: "<目录>/tvshow.nfo"
+     *
+     * @param videoInfo 视频信息
+     * @return std::string NFO文件路径, 不支持的视频类型返回空字符串
+     */
+    static std::string GetNfoPath(const VideoInfo& videoInfo);
+
+    /**
+     * @brief 按命名规则推导海报的路径, 电影为"<视频文件名>-poster.jpg", 电视剧为"<目录>/poster.jpg"
+     *
+     * @param videoInfo 视频信息
+     * @return std::string 海报路径, 不支持的视频类型返回空字符串
+     */
+    static std::string GetPosterPath(const VideoInfo& videoInfo);
+
+    /**
+     * @brief 按命名规则推导剧照的路径, 电影为"<视频文件名>-fanart.jpg", 电视剧为"<目录>/fanart.jpg"
+     *
+     * @param videoInfo 视频信息
+     * @return std::string 剧照路径, 不支持的视频类型返回空字符串
+     */
+    static std::string GetFanartPath(const VideoInfo& videoInfo);
+
+    /**
+     * @brief 按命名规则推导标志的路径, 电影为"<视频文件名>-clearlogo.jpg", 电视剧为"<目录>/clearlogo.jpg"
+     *
+     * @param videoInfo 视频信息
+     * @return std::string 标志路径, 不支持的视频类型返回空字符串
+     */
+    static std::string GetClearlogoPath(const VideoInfo& videoInfo);
+
 private:
 
     static bool IsVideo(const std::string& suffix);
@@ -31,6 +87,15 @@ private:
     static bool IsJpgCompleted(const std::string& posterPath);
     static bool IsPNGCompleted(const std::string& posterPath);
 
+    /**
+     * @brief 推导图片的路径, 电影的图片以视频文件名加"-"作为前缀, 电视剧的图片位于电视剧目录下
+     *
+     * @param videoInfo 视频信息
+     * @param fileName 图片文件名, 如"poster.jpg"
+     * @return std::string 图片路径
+     */
+    static std::string GetArtworkPath(const VideoInfo& videoInfo, const std::string& fileName);
+
     /**
      * @brief 获取电视剧剧集的路径, 即添加给定目录下所有的视频文件
      * 
@@ -47,17 +112,20 @@ private:
 
     static bool ScanMovie(const std::vector<std::string>& path,
                           std::vector<VideoInfo>&         videoInfos,
+                          std::atomic<std::size_t>&       foundVideoNum,
                           std::atomic<std::size_t>&       processedVideoNum,
                           bool                            forceDetectHdr);
     static bool ScanMovieSet(const std::vector<std::string>&,
                              std::vector<VideoInfo>&,
                              std::atomic<std::size_t>&,
+                             std::atomic<std::size_t>&,
                              bool)
     { /*TODO: 实现电影集的扫描*/
         return true;
     };
     static bool ScanTv(const std::vector<std::string>& path,
                        std::vector<VideoInfo>&         videoInfos,
+                       std::atomic<std::size_t>&       foundVideoNum,
                        std::atomic<std::size_t>&       processedVideoNum,
                        bool                            forceDetectHdr);
 
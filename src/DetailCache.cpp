@@ -0,0 +1,63 @@
+#include "DetailCache.h"
+
+#include <iterator>
+
+DetailCache::DetailCache(Loader loader, std::size_t capacity)
+    : m_loader(std::move(loader)), m_capacity(capacity), m_bytes(0)
+{
+}
+
+VideoInfoPtr DetailCache::Get(VideoId id, const VideoInfoPtr& brief)
+{
+    {
+        std::lock_guard<std::mutex> locker(m_lock);
+        auto                        iter = m_index.find(id);
+        if (iter != m_index.end()) {
+            if (iter->second->brief.lock() == brief) {
+                m_entries.splice(m_entries.begin(), m_entries, iter->second);
+                return iter->second->full;
+            }
+            Erase(iter->second);
+        }
+    }
+
+    // 解析在锁外进行, 并发的首次请求可能重复解析, 结果相同
+    VideoInfo full(*brief);
+    if (!m_loader(full)) {
+        return brief;
+    }
+    Entry entry;
+    entry.id    = id;
+    entry.brief = brief;
+    entry.full  = std::make_shared<const VideoInfo>(std::move(full));
+    entry.bytes = Library::EstimateBytes(*entry.full);
+
+    std::lock_guard<std::mutex> locker(m_lock);
+    auto                        iter = m_index.find(id);
+    if (iter != m_index.end()) {
+        Erase(iter->second);
+    }
+    m_entries.push_front(entry);
+    m_index[id] = m_entries.begin();
+    m_bytes += entry.bytes;
+
+    // 至少保留刚加载的条目
+    while (m_bytes > m_capacity && m_entries.size() > 1) {
+        Erase(std::prev(m_entries.end()));
+    }
+    return entry.full;
+}
+
+void DetailCache::Stats(std::size_t& count, std::size_t& bytes)
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    count = m_entries.size();
+    bytes = m_bytes;
+}
+
+void DetailCache::Erase(EntryList::iterator iter)
+{
+    m_bytes -= iter->bytes;
+    m_index.erase(iter->id);
+    m_entries.erase(iter);
+}
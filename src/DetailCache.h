@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "Library.h"
+
+/**
+ * @brief 视频完整详情的LRU缓存
+ *
+ * 媒体库快照中只保存简要信息, 查看详情时从NFO完整解析. 缓存以视频ID索引, 并记录加载时的简要信息对象,
+ * 视频被刮削或者重新扫描后简要信息对象被替换, 旧的详情自然失效. 缓存按估算的字节数限制容量, 超出时淘汰最久未使用的条目.
+ */
+class DetailCache
+{
+public:
+
+    using Loader = std::function<bool(VideoInfo&)>;
+
+    /**
+     * @brief 构造缓存
+     *
+     * @param loader 加载完整详情的函数, 输入为简要信息的副本, 返回false时使用简要信息
+     * @param capacity 缓存的容量(字节, 按Library::EstimateBytes估算)
+     */
+    DetailCache(Loader loader, std::size_t capacity);
+
+    /**
+     * @brief 获取视频的完整详情, 未缓存或者已失效时加载并缓存
+     *
+     * @param id 视频ID
+     * @param brief 快照中的简要信息
+     * @return VideoInfoPtr 完整详情, 加载失败时为简要信息本身
+     */
+    VideoInfoPtr Get(VideoId id, const VideoInfoPtr& brief);
+
+    /**
+     * @brief 获取缓存的条目数与占用的字节数(估算)
+     *
+     * @param count 输出条目数
+     * @param bytes 输出字节数
+     */
+    void Stats(std::size_t& count, std::size_t& bytes);
+
+private:
+
+    /**
+     * @brief 缓存条目
+     *
+     */
+    struct Entry {
+        VideoId                        id;    // 视频ID
+        std::weak_ptr<const VideoInfo> brief; // 加载时的简要信息
+        VideoInfoPtr                   full;  // 完整详情
+        std::size_t                    bytes; // 完整详情占用的字节数
+    };
+
+    using EntryList = std::list<Entry>;
+
+    void Erase(EntryList::iterator iter);
+
+private:
+
+    Loader                                           m_loader;   // 加载完整详情的函数
+    std::size_t                                      m_capacity; // 缓存的容量(字节)
+    std::size_t                                      m_bytes;    // 已占用的字节数
+    EntryList                                        m_entries;  // 缓存条目, 最近使用的在前
+    std::unordered_map<VideoId, EntryList::iterator> m_index;    // 视频ID -> 缓存条目
+    std::mutex                                       m_lock;     // 缓存的锁
+};
@@ -0,0 +1,88 @@
+#include "EventBus.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+const std::size_t EventBus::MAX_SUBSCRIBERS;
+const std::size_t EventBus::QUEUE_CAPACITY;
+
+EventBus& EventBus::Instance()
+{
+    static EventBus inst;
+    return inst;
+}
+
+EventBus::EventBus() : m_subscriberNum(0), m_nextEventId(1), m_closed(false) {}
+
+EventBus::SubscriberPtr EventBus::Subscribe()
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    if (m_closed || m_subscribers.size() >= MAX_SUBSCRIBERS) {
+        return nullptr;
+    }
+    auto subscriber = std::make_shared<Subscriber>();
+    m_subscribers.push_back(subscriber);
+    m_subscriberNum = m_subscribers.size();
+    return subscriber;
+}
+
+void EventBus::Unsubscribe(const SubscriberPtr& subscriber)
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    m_subscribers.erase(std::remove(m_subscribers.begin(), m_subscribers.end(), subscriber), m_subscribers.end());
+    m_subscriberNum = m_subscribers.size();
+}
+
+bool EventBus::HasSubscribers() const
+{
+    return m_subscriberNum.load() > 0;
+}
+
+void EventBus::Publish(const std::string& type, const std::string& data)
+{
+    {
+        std::lock_guard<std::mutex> locker(m_lock);
+        if (m_subscribers.empty()) {
+            return;
+        }
+        Event event;
+        event.id   = m_nextEventId++;
+        event.type = type;
+        event.data = data;
+        for (auto& subscriber : m_subscribers) {
+            // 慢速的订阅者丢弃最旧的事件, 由其根据序号的间断自行重新同步
+            if (subscriber->events.size() >= QUEUE_CAPACITY) {
+                subscriber->events.pop_front();
+            }
+            subscriber->events.push_back(event);
+        }
+    }
+    m_cond.notify_all();
+}
+
+bool EventBus::Wait(const SubscriberPtr& subscriber, std::vector<Event>& events, int timeoutMs)
+{
+    events.clear();
+
+    std::unique_lock<std::mutex> locker(m_lock);
+    m_cond.wait_for(locker, std::chrono::milliseconds(timeoutMs), [this, &subscriber]() {
+        return m_closed || !subscriber->events.empty();
+    });
+    if (m_closed) {
+        return false;
+    }
+    events.assign(std::make_move_iterator(subscriber->events.begin()),
+                  std::make_move_iterator(subscriber->events.end()));
+    subscriber->events.clear();
+    return true;
+}
+
+void EventBus::Close()
+{
+    {
+        std::lock_guard<std::mutex> locker(m_lock);
+        m_closed = true;
+    }
+    m_cond.notify_all();
+}
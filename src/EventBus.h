@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 推送给客户端的事件
+ *
+ */
+struct Event {
+    uint64_t    id = 0; // 事件序号, 全局递增
+    std::string type;   // 事件类型, 如scan, job, log, library
+    std::string data;   // 事件内容, 除log为日志文本外均为JSON
+};
+
+/**
+ * @brief 进程内的事件总线, 将扫描进度, 任务状态, 日志与媒体库变化推送给/api/events的订阅者
+ *
+ * 每个订阅者有独立的有界队列, 队列满时丢弃最旧的事件, 发布者不会因为慢速的客户端而阻塞.
+ * 事件序号全局递增, 订阅者发现序号不连续时说明有事件被丢弃, 需要重新获取完整的状态.
+ * 每个订阅者独占一个HTTP工作线程, 订阅者数量有上限, 避免占满HTTP服务器的线程池.
+ */
+class EventBus
+{
+public:
+
+    static const std::size_t MAX_SUBSCRIBERS = 4;   // 最大订阅者数
+    static const std::size_t QUEUE_CAPACITY  = 256; // 每个订阅者的队列容量
+
+    /**
+     * @brief 订阅者, 只能通过Subscribe创建
+     *
+     */
+    struct Subscriber {
+        std::deque<Event> events; // 待读取的事件
+    };
+
+    using SubscriberPtr = std::shared_ptr<Subscriber>;
+
+    /**
+     * @brief 单例模式
+     *
+     * @return EventBus& 单例
+     */
+    static EventBus& Instance();
+
+    EventBus(const EventBus&)            = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    /**
+     * @brief 订阅事件, 只接收订阅之后发布的事件
+     *
+     * @return SubscriberPtr 订阅者, 订阅者数已达上限或者总线已关闭时为nullptr
+     */
+    SubscriberPtr Subscribe();
+
+    /**
+     * @brief 取消订阅
+     *
+     * @param subscriber 订阅者
+     */
+    void Unsubscribe(const SubscriberPtr& subscriber);
+
+    /**
+     * @brief 是否有订阅者, 发布者可以据此跳过事件内容的构造
+     *
+     * @return true 有订阅者
+     * @return false 没有订阅者
+     */
+    bool HasSubscribers() const;
+
+    /**
+     * @brief 发布事件到所有订阅者
+     *
+     * @param type 事件类型
+     * @param data 事件内容
+     */
+    void Publish(const std::string& type, const std::string& data);
+
+    /**
+     * @brief 等待并取出订阅者的所有待读取事件
+     *
+     * @param subscriber 订阅者
+     * @param events 输出取出的事件, 超时时为空
+     * @param timeoutMs 最长等待时间(毫秒)
+     * @return true 有事件或者等待超时
+     * @return false 总线已关闭, 订阅者应退出
+     */
+    bool Wait(const SubscriberPtr& subscriber, std::vector<Event>& events, int timeoutMs);
+
+    /**
+     * @brief 关闭总线, 唤醒所有等待中的订阅者并拒绝新的订阅, 退出前调用
+     *
+     */
+    void Close();
+
+private:
+
+    EventBus();
+
+private:
+
+    std::vector<SubscriberPtr> m_subscribers;   // 所有订阅者
+    std::atomic<std::size_t>   m_subscriberNum; // 订阅者数, 无锁读取
+    uint64_t                   m_nextEventId;   // 下一个事件的序号
+    bool                       m_closed;        // 是否已关闭
+    mutable std::mutex         m_lock;          // 订阅者与队列的锁
+    std::condition_variable    m_cond;          // 有新事件或者关闭时通知
+};
@@ -0,0 +1,140 @@
+#include "FacetIndex.h"
+
+#include <algorithm>
+
+#include <Poco/String.h>
+
+#include "DataSource.h"
+
+FacetIndex::Ptr FacetIndex::Build(const std::vector<VideoInfoPtr>& videoInfos)
+{
+    Bitmap                        all;
+    std::map<std::string, Bitmap> facets[FACET_FIELD_NUM];
+    for (std::size_t index = 0; index < videoInfos.size(); index++) {
+        all.Add(static_cast<uint32_t>(index));
+        for (int field = 0; field < FACET_FIELD_NUM; field++) {
+            for (const auto& value : ValuesOf(*videoInfos[index], static_cast<FacetField>(field))) {
+                facets[field][value].Add(static_cast<uint32_t>(index));
+            }
+        }
+    }
+
+    auto facetIndex   = std::make_shared<FacetIndex>();
+    facetIndex->m_all = std::make_shared<const Bitmap>(std::move(all));
+    for (int field = 0; field < FACET_FIELD_NUM; field++) {
+        for (auto& facet : facets[field]) {
+            facetIndex->m_facets[field][facet.first] = std::make_shared<const Bitmap>(std::move(facet.second));
+        }
+    }
+    return facetIndex;
+}
+
+FacetIndex::Ptr FacetIndex::Update(std::size_t index, const VideoInfo& oldInfo, const VideoInfo& newInfo) const
+{
+    auto facetIndex = std::make_shared<FacetIndex>(*this);
+    for (int field = 0; field < FACET_FIELD_NUM; field++) {
+        std::vector<std::string> oldValues = ValuesOf(oldInfo, static_cast<FacetField>(field));
+        std::vector<std::string> newValues = ValuesOf(newInfo, static_cast<FacetField>(field));
+        FacetValues&             values    = facetIndex->m_facets[field];
+
+        // 只复制取值发生变化的位图
+        for (const auto& value : oldValues) {
+            if (std::find(newValues.begin(), newValues.end(), value) != newValues.end()) {
+                continue;
+            }
+            auto iter = values.find(value);
+            if (iter == values.end()) {
+                continue;
+            }
+            auto bitmap = std::make_shared<Bitmap>(*iter->second);
+            bitmap->Remove(static_cast<uint32_t>(index));
+            if (bitmap->Empty()) {
+                values.erase(iter);
+            } else {
+                iter->second = bitmap;
+            }
+        }
+        for (const auto& value : newValues) {
+            if (std::find(oldValues.begin(), oldValues.end(), value) != oldValues.end()) {
+                continue;
+            }
+            BitmapPtr& bitmapPtr = values[value];
+            auto       bitmap    = bitmapPtr ? std::make_shared<Bitmap>(*bitmapPtr) : std::make_shared<Bitmap>();
+            bitmap->Add(static_cast<uint32_t>(index));
+            bitmapPtr = bitmap;
+        }
+    }
+    return facetIndex;
+}
+
+const Bitmap& FacetIndex::All() const
+{
+    return *m_all;
+}
+
+const Bitmap& FacetIndex::Get(FacetField field, const std::string& value) const
+{
+    static const Bitmap EMPTY_BITMAP;
+
+    auto iter = m_facets[field].find(value);
+    return iter == m_facets[field].end() ? EMPTY_BITMAP : *iter->second;
+}
+
+const FacetIndex::FacetValues& FacetIndex::Values(FacetField field) const
+{
+    return m_facets[field];
+}
+
+std::string FacetIndex::FieldToStr(FacetField field)
+{
+    static const std::map<FacetField, std::string> FACET_FIELD_TO_STR = {
+        {FACET_STATUS, "status"},
+        {FACET_NFO_STATUS, "nfoStatus"},
+        {FACET_POSTER_STATUS, "posterStatus"},
+        {FACET_HDR, "hdr"},
+        {FACET_GENRE, "genre"},
+        {FACET_COUNTRY, "country"},
+        {FACET_STUDIO, "studio"},
+    };
+
+    return FACET_FIELD_TO_STR.at(field);
+}
+
+std::string FacetIndex::MetaFileStatusToStr(MetaFileStatus status)
+{
+    switch (status) {
+    case FILE_FORMAT_MATCH:
+        return "match";
+    case FILE_FORMAT_MISMATCH:
+        return "mismatch";
+    case FILE_NOT_FOUND:
+    default:
+        return "notFound";
+    }
+}
+
+std::vector<std::string> FacetIndex::ValuesOf(const VideoInfo& videoInfo, FacetField field)
+{
+    const bool hasNfo   = videoInfo.nfoStatus == FILE_FORMAT_MATCH;
+    auto       toValues = [hasNfo](const std::vector<InternedString>& strs) {
+        return hasNfo ? std::vector<std::string>(strs.begin(), strs.end()) : std::vector<std::string>();
+    };
+    switch (field) {
+    case FACET_STATUS:
+        return {DataSource::IsMetaCompleted(videoInfo) ? FACET_COMPLETE : FACET_INCOMPLETE};
+    case FACET_NFO_STATUS:
+        return {MetaFileStatusToStr(videoInfo.nfoStatus)};
+    case FACET_POSTER_STATUS:
+        return {MetaFileStatusToStr(videoInfo.posterStatus)};
+    case FACET_HDR:
+        return {Poco::toLower(VIDEO_RANGE_TYPE_TO_STR_MAP.at(videoInfo.hdrType))};
+    case FACET_GENRE:
+        return toValues(videoInfo.videoDetail.genre);
+    case FACET_COUNTRY:
+        return toValues(videoInfo.videoDetail.countries);
+    case FACET_STUDIO:
+        return toValues(videoInfo.videoDetail.studio);
+    default:
+        return {};
+    }
+}
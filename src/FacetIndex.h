@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Bitmap.h"
+#include "Library.h"
+
+/**
+ * @brief 可过滤/统计的字段
+ *
+ */
+enum FacetField {
+    FACET_STATUS,        // 元数据完整性, complete/incomplete
+    FACET_NFO_STATUS,    // NFO文件状态, match/mismatch/notFound
+    FACET_POSTER_STATUS, // 海报文件状态, match/mismatch/notFound
+    FACET_HDR,           // HDR类型, 小写
+    FACET_GENRE,         // 分类, 仅NFO有效时
+    FACET_COUNTRY,       // 国家, 仅NFO有效时
+    FACET_STUDIO,        // 制片厂, 仅NFO有效时
+    FACET_FIELD_NUM,
+};
+
+const std::string FACET_COMPLETE   = "complete";   // FACET_STATUS: 元数据完整
+const std::string FACET_INCOMPLETE = "incomplete"; // FACET_STATUS: 元数据不完整
+
+/**
+ * @brief 媒体库快照的位图索引
+ *
+ * 每个字段的每个取值对应一个位图, 记录具有该取值的视频在快照中的下标, 组合过滤条件通过位图的交并差求得,
+ * 分面统计只需要计算交集的元素个数, 与媒体库的规模基本无关.
+ * 索引一经构造不再修改, 单个视频更新时只复制取值发生变化的位图, 其余位图在新旧索引间共享.
+ */
+class FacetIndex
+{
+public:
+
+    using Ptr         = std::shared_ptr<const FacetIndex>;
+    using BitmapPtr   = std::shared_ptr<const Bitmap>;
+    using FacetValues = std::map<std::string, BitmapPtr>;
+
+    /**
+     * @brief 为扫描结果构造索引
+     *
+     * @param videoInfos 快照中的所有视频信息
+     * @return Ptr 索引
+     */
+    static Ptr Build(const std::vector<VideoInfoPtr>& videoInfos);
+
+    /**
+     * @brief 构造单个视频更新后的索引, 当前索引保持不变
+     *
+     * @param index 视频在快照中的下标
+     * @param oldInfo 更新前的视频信息
+     * @param newInfo 更新后的视频信息
+     * @return Ptr 新的索引
+     */
+    Ptr Update(std::size_t index, const VideoInfo& oldInfo, const VideoInfo& newInfo) const;
+
+    /**
+     * @brief 获取所有视频的位图
+     *
+     * @return const Bitmap& 位图
+     */
+    const Bitmap& All() const;
+
+    /**
+     * @brief 获取字段取值对应的位图
+     *
+     * @param field 字段
+     * @param value 取值
+     * @return const Bitmap& 位图, 没有视频具有该取值时为空位图
+     */
+    const Bitmap& Get(FacetField field, const std::string& value) const;
+
+    /**
+     * @brief 获取字段的所有取值及其位图
+     *
+     * @param field 字段
+     * @return const FacetValues& 取值 -> 位图
+     */
+    const FacetValues& Values(FacetField field) const;
+
+    static std::string FieldToStr(FacetField field);
+    static std::string MetaFileStatusToStr(MetaFileStatus status);
+
+private:
+
+    static std::vector<std::string> ValuesOf(const VideoInfo& videoInfo, FacetField field);
+
+private:
+
+    BitmapPtr   m_all;                     // 所有视频
+    FacetValues m_facets[FACET_FIELD_NUM]; // 各个字段的取值 -> 位图
+};
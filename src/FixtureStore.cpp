@@ -0,0 +1,98 @@
+#include "FixtureStore.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <Poco/DigestEngine.h>
+#include <Poco/File.h>
+#include <Poco/Path.h>
+#include <Poco/SHA1Engine.h>
+
+#include "Logger.h"
+
+const std::string FIXTURE_INDEX_FILE_NAME = "index.txt"; // 索引文件的名称
+const std::string FIXTURE_FILE_SUFFIX     = ".fixture";  // 录制文件的后缀
+
+FixtureStore::FixtureStore(const std::string& dir)
+{
+    if (!dir.empty()) {
+        m_dir = Poco::Path::forDirectory(dir).toString();
+    }
+}
+
+std::string FixtureStore::KeyOf(const Poco::URI& uri)
+{
+    Poco::URI::QueryParameters params = uri.getQueryParameters();
+    params.erase(std::remove_if(params.begin(),
+                                params.end(),
+                                [](const std::pair<std::string, std::string>& param) {
+                                    return param.first == "api_key";
+                                }),
+                 params.end());
+    std::sort(params.begin(), params.end());
+
+    Poco::URI keyUri;
+    keyUri.setPath(uri.getPath());
+    keyUri.setQueryParameters(params);
+    return keyUri.getPathAndQuery();
+}
+
+bool FixtureStore::IsEnabled() const
+{
+    return !m_dir.empty();
+}
+
+std::string FixtureStore::FilePath(const std::string& key) const
+{
+    Poco::SHA1Engine sha1;
+    sha1.update(key);
+    return m_dir + Poco::DigestEngine::digestToHex(sha1.digest()) + FIXTURE_FILE_SUFFIX;
+}
+
+bool FixtureStore::Load(const std::string& key, std::string& body) const
+{
+    if (!IsEnabled()) {
+        return false;
+    }
+
+    std::ifstream ifs(FilePath(key), std::ios::binary);
+    if (!ifs.is_open()) {
+        return false;
+    }
+
+    std::ostringstream oss;
+    oss << ifs.rdbuf();
+    body = oss.str();
+    return true;
+}
+
+bool FixtureStore::Save(const std::string& key, const std::string& body)
+{
+    if (!IsEnabled()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> locker(m_lock);
+    try {
+        Poco::File(m_dir).createDirectories();
+    } catch (Poco::Exception& e) {
+        LOG_ERROR("Create fixture directory {} failed: {}", m_dir, e.displayText());
+        return false;
+    }
+
+    const std::string filePath = FilePath(key);
+    bool              isNew    = !Poco::File(filePath).exists();
+    std::ofstream     ofs(filePath, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open() || !ofs.write(body.data(), body.size())) {
+        LOG_ERROR("Write fixture {} failed", filePath);
+        return false;
+    }
+
+    if (isNew) {
+        std::ofstream indexOfs(m_dir + FIXTURE_INDEX_FILE_NAME, std::ios::app);
+        indexOfs << Poco::Path(filePath).getFileName() << " " << key << "\n";
+    }
+    LOG_TRACE("Fixture recorded: {}", key);
+    return true;
+}
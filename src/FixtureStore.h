@@ -0,0 +1,69 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+
+#include <Poco/URI.h>
+
+/**
+ * @brief TMDB响应的录制/回放仓库
+ *
+ * 每个响应以请求的key(路径和排序后的查询参数, 不含api_key)的SHA1命名保存在仓库目录中,
+ * 刮削服务录制真实的响应, 模拟TMDB服务器回放这些响应.
+ */
+class FixtureStore
+{
+public:
+
+    /**
+     * @brief 构造仓库
+     *
+     * @param dir 仓库目录, 为空时不录制也不回放
+     */
+    explicit FixtureStore(const std::string& dir);
+
+    /**
+     * @brief 获取请求的key, 与查询参数的顺序和api_key无关
+     *
+     * @param uri 请求的地址
+     * @return std::string 请求的key
+     */
+    static std::string KeyOf(const Poco::URI& uri);
+
+    /**
+     * @brief 仓库是否可用
+     *
+     * @return true 可用
+     * @return false 未配置仓库目录
+     */
+    bool IsEnabled() const;
+
+    /**
+     * @brief 读取录制的响应
+     *
+     * @param key 请求的key
+     * @param body 输出响应内容
+     * @return true 读取成功
+     * @return false 没有录制该请求
+     */
+    bool Load(const std::string& key, std::string& body) const;
+
+    /**
+     * @brief 保存响应, 同时在index.txt中记录key与文件名的对应关系
+     *
+     * @param key 请求的key
+     * @param body 响应内容
+     * @return true 保存成功
+     * @return false 保存失败
+     */
+    bool Save(const std::string& key, const std::string& body);
+
+private:
+
+    std::string FilePath(const std::string& key) const;
+
+private:
+
+    std::string m_dir;  // 仓库目录(以路径分隔符结尾)
+    std::mutex  m_lock; // 写入索引的锁
+};
@@ -31,6 +31,13 @@ const Poco::Process::Args FFPROBE_ANALYZE_ARGS          = {"-analyzeduration",
                                                            "-show_format",
                                                            "-i",
                                                            "file:"}; // 检测ffprobe的输出关键字
+const Poco::Process::Args FFPROBE_DURATION_ARGS         = {"-v",
+                                                           "error",
+                                                           "-print_format",
+                                                           "json",
+                                                           "-show_format",
+                                                           "-i",
+                                                           "file:"}; // 获取视频时长的命令行参数
 
 bool HDRToolKit::Checkffprobe()
 {
@@ -155,3 +162,38 @@ VideoRangeType HDRToolKit::GetHDRTypeFromFile(const std::string &fileName)
 
     return VideoRangeType::UNKNOWN;
 }
+
+int HDRToolKit::GetDurationFromFile(const std::string &fileName)
+{
+    const std::string &ffprobePath = Config::Instance().GetffprobePath();
+    if (ffprobePath.empty() || !Poco::File(ffprobePath).exists()) {
+        return -1;
+    }
+
+    Poco::Process::Args args = FFPROBE_DURATION_ARGS;
+    args.back()              = "file:" + fileName;
+
+    try {
+        Poco::Pipe            outPipe;
+        Poco::ProcessHandle   ffprobeProcHdl = Poco::Process::launch(ffprobePath, args, nullptr, &outPipe, nullptr);
+        Poco::PipeInputStream inputStream(outPipe);
+        std::stringstream     outStream;
+        Poco::StreamCopier::copyStream(inputStream, outStream);
+        ffprobeProcHdl.wait();
+
+        Poco::JSON::Parser      jsonParser;
+        Poco::JSON::Object::Ptr ffprobeJsonPtr = jsonParser.parse(outStream.str()).extract<Poco::JSON::Object::Ptr>();
+        Poco::JSON::Object::Ptr format         = ffprobeJsonPtr->getObject("format");
+        if (format.isNull() || format->isNull("duration")) {
+            LOG_WARN("No duration found in video {}", fileName);
+            return -1;
+        }
+        return static_cast<int>(std::stod(format->getValue<std::string>("duration")));
+    } catch (Poco::Exception &e) {
+        LOG_ERROR("Get duration of video {} failed: {}", fileName, e.displayText());
+    } catch (std::exception &e) {
+        LOG_ERROR("Get duration of video {} failed: {}", fileName, e.what());
+    }
+
+    return -1;
+}
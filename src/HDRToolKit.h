@@ -39,6 +39,14 @@ public:
 
     static VideoRangeType GetHDRTypeFromFile(const std::string& fileName);
 
+    /**
+     * @brief 通过ffprobe获取视频的时长
+     *
+     * @param fileName 视频文件路径
+     * @return int 时长, 单位: 秒; 获取失败时返回-1
+     */
+    static int GetDurationFromFile(const std::string& fileName);
+
 private:
 
     static VideoRangeType GetHDRTypeByDolbyConf(int dv_profile, int dv_bl_signal_compatibility_id);
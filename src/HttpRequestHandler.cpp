@@ -2,13 +2,18 @@
 
 #include <fstream>
 #include <functional>
+#include <sstream>
 #include <utility>
 
+#include <Poco/DeflatingStream.h>
 #include <Poco/File.h>
 #include <Poco/FileStream.h>
+#include <Poco/JSON/Parser.h>
 #include <Poco/Net/HTMLForm.h>
 #include <Poco/Net/WebSocket.h>
 #include <Poco/StreamCopier.h>
+#include <Poco/String.h>
+#include <Poco/StringTokenizer.h>
 #include <Poco/Thread.h>
 #include <Poco/URI.h>
 
@@ -20,6 +25,9 @@
 
 const std::string WEBUI_BUILD_DIST = "web"; // WEBUI默认生成的路径
 
+const int EventStreamHandler::HEARTBEAT_INTERVAL_MS;
+const int EventStreamHandler::RETRY_INTERVAL_MS;
+
 void InvalidRequestHandler::handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
 {
     LOG_TRACE("Invalid request from {}", request.clientAddress().toString());
@@ -46,36 +54,235 @@ Poco::JSON::Object ApiRequestHandler::QueryParamToJson(const Poco::URI::QueryPar
     return queryJsonObj;
 }
 
+bool ApiRequestHandler::MergeJsonBody(std::istream& body, Poco::JSON::Object& param)
+{
+    std::string bodyStr;
+    Poco::StreamCopier::copyToString(body, bodyStr);
+    if (bodyStr.empty()) {
+        return true;
+    }
+
+    try {
+        Poco::JSON::Parser      parser;
+        Poco::JSON::Object::Ptr bodyObj = parser.parse(bodyStr).extract<Poco::JSON::Object::Ptr>();
+        for (const auto& member : *bodyObj) {
+            param.set(member.first, member.second);
+        }
+    } catch (Poco::Exception& e) {
+        LOG_ERROR("Parse request body failed: {}", e.displayText());
+        return false;
+    }
+
+    return true;
+}
+
+bool ApiRequestHandler::MatchETag(const std::string& ifNoneMatch, const std::string& etag)
+{
+    Poco::StringTokenizer tokenizer(ifNoneMatch,
+                                    ",",
+                                    Poco::StringTokenizer::TOK_TRIM | Poco::StringTokenizer::TOK_IGNORE_EMPTY);
+    for (const auto& token : tokenizer) {
+        // 弱比较, 忽略"W/"前缀
+        const std::string tag = token.compare(0, 2, "W/") == 0 ? token.substr(2) : token;
+        if (tag == "*" || tag == etag) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void ApiRequestHandler::handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
 {
     LOG_TRACE("Api request from {}", request.clientAddress().toString());
 
-    response.setChunkedTransferEncoding(true);
-    response.setContentType("application/json");
-    std::ostream& ostr = response.send();
-
     // 关联API与后端接口
     using namespace std::placeholders;
     static std::map<std::string, ApiManager::ApiHandler> RegApiHandlers = {
         {"/api/scan", std::bind(&ApiManager::Scan, &ApiManager::Instance(), _1, _2)},
         {"/api/scanResult", std::bind(&ApiManager::ScanResult, &ApiManager::Instance(), _1, _2)},
         {"/api/list", std::bind(&ApiManager::List, &ApiManager::Instance(), _1, _2)},
+        {"/api/facets", std::bind(&ApiManager::Facets, &ApiManager::Instance(), _1, _2)},
+        {"/api/search", std::bind(&ApiManager::Search, &ApiManager::Instance(), _1, _2)},
+        {"/api/changes", std::bind(&ApiManager::Changes, &ApiManager::Instance(), _1, _2)},
         {"/api/detail", std::bind(&ApiManager::Detail, &ApiManager::Instance(), _1, _2)},
         {"/api/scrape", std::bind(&ApiManager::Scrape, &ApiManager::Instance(), _1, _2)},
+        {"/api/scrapeBatch", std::bind(&ApiManager::ScrapeBatch, &ApiManager::Instance(), _1, _2)},
+        {"/api/scrapeBatchResult", std::bind(&ApiManager::ScrapeBatchResult, &ApiManager::Instance(), _1, _2)},
+        {"/api/autoMatch", std::bind(&ApiManager::AutoMatch, &ApiManager::Instance(), _1, _2)},
+        {"/api/reviewQueue", std::bind(&ApiManager::ReviewQueue, &ApiManager::Instance(), _1, _2)},
         {"/api/refresh", std::bind(&ApiManager::Refresh, &ApiManager::Instance(), _1, _2)},
         {"/api/refreshResult", std::bind(&ApiManager::RefreshResult, &ApiManager::Instance(), _1, _2)},
         {"/api/interlog", std::bind(&ApiManager::InterLog, &ApiManager::Instance(), _1, _2)},
         {"/api/version", std::bind(&ApiManager::Version, &ApiManager::Instance(), _1, _2)},
+        {"/api/upstreamStats", std::bind(&ApiManager::UpstreamStats, &ApiManager::Instance(), _1, _2)},
+        {"/api/memoryStats", std::bind(&ApiManager::MemoryStats, &ApiManager::Instance(), _1, _2)},
+        {"/api/jobs", std::bind(&ApiManager::Jobs, &ApiManager::Instance(), _1, _2)},
         {"/api/quit", std::bind(&ApiManager::Quit, &ApiManager::Instance(), _1, _2)},
     };
 
+    // 响应内容只随媒体库快照变化的API, 内容未变化时返回304, 省去序列化与传输
+    using ETagFunc = std::function<std::string(const Poco::JSON::Object&)>;
+    static std::map<std::string, ETagFunc> RegETagFuncs = {
+        {"/api/list", std::bind(&ApiManager::LibraryETag, &ApiManager::Instance(), _1)},
+        {"/api/facets", std::bind(&ApiManager::LibraryETag, &ApiManager::Instance(), _1)},
+        {"/api/search", std::bind(&ApiManager::LibraryETag, &ApiManager::Instance(), _1)},
+        {"/api/changes", std::bind(&ApiManager::LibraryETag, &ApiManager::Instance(), _1)},
+        {"/api/detail", std::bind(&ApiManager::LibraryETag, &ApiManager::Instance(), _1)},
+    };
+
     Poco::URI uri(request.getURI());
     auto iter = RegApiHandlers.find(uri.getPath());
-    if (iter != RegApiHandlers.end()) {
-        iter->second(QueryParamToJson(uri.getQueryParameters()), ostr);
-    } else { // 非法API请求
-        ostr << R"({"err": "Invalid API request!"})";
+    if (iter == RegApiHandlers.end()) { // 非法API请求
+        response.setChunkedTransferEncoding(true);
+        response.setContentType("application/json");
+        response.send() << R"({"err": "Invalid API request!"})";
+        return;
+    }
+
+    Poco::JSON::Object param       = QueryParamToJson(uri.getQueryParameters());
+    bool               isValidBody = true;
+    if (request.getMethod() == Poco::Net::HTTPRequest::HTTP_POST) {
+        isValidBody = MergeJsonBody(request.stream(), param);
+    }
+
+    auto etagIter = RegETagFuncs.find(uri.getPath());
+    if (isValidBody && etagIter != RegETagFuncs.end()) {
+        const std::string etag = etagIter->second(param);
+        if (!etag.empty()) {
+            response.set("ETag", etag);
+            response.set("Cache-Control", "no-cache");
+            if (MatchETag(request.get("If-None-Match", ""), etag)) {
+                response.setStatusAndReason(Poco::Net::HTTPResponse::HTTP_NOT_MODIFIED);
+                response.setContentLength(0);
+                response.send();
+                return;
+            }
+        }
     }
+
+    response.setChunkedTransferEncoding(true);
+    response.setContentType("application/json");
+    std::ostream& ostr = response.send();
+    if (!isValidBody) {
+        ostr << R"({"success": false, "msg": "Invalid JSON body!"})";
+        return;
+    }
+    iter->second(param, ostr);
+}
+
+void ExportRequestHandler::handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+{
+    LOG_TRACE("Export request from {}", request.clientAddress().toString());
+
+    Poco::URI          uri(request.getURI());
+    Poco::JSON::Object param       = QueryParamToJson(uri.getQueryParameters());
+    bool               isValidBody = true;
+    if (request.getMethod() == Poco::Net::HTTPRequest::HTTP_POST) {
+        isValidBody = MergeJsonBody(request.stream(), param);
+    }
+
+    // 参数在发送响应头之前校验, 无效时返回未压缩的JSON
+    std::ostringstream     errOut;
+    ApiManager::ExportFunc exportFunc;
+    if (!isValidBody) {
+        errOut << R"({"success": false, "msg": "Invalid JSON body!"})";
+    } else {
+        exportFunc = ApiManager::Instance().Export(param, errOut);
+    }
+    if (!exportFunc) {
+        response.setChunkedTransferEncoding(true);
+        response.setContentType("application/json");
+        response.send() << errOut.str();
+        return;
+    }
+
+    const std::string etag = ApiManager::Instance().LibraryETag(param);
+    if (!etag.empty()) {
+        response.set("ETag", etag);
+        response.set("Cache-Control", "no-cache");
+        if (MatchETag(request.get("If-None-Match", ""), etag)) {
+            response.setStatusAndReason(Poco::Net::HTTPResponse::HTTP_NOT_MODIFIED);
+            response.setContentLength(0);
+            response.send();
+            return;
+        }
+    }
+
+    response.setChunkedTransferEncoding(true);
+    response.setContentType("application/x-ndjson");
+    if (!AcceptGzip(request.get("Accept-Encoding", ""))) {
+        exportFunc(response.send());
+        return;
+    }
+    response.set("Content-Encoding", "gzip");
+    Poco::DeflatingOutputStream deflater(response.send(), Poco::DeflatingStreamBuf::STREAM_GZIP);
+    exportFunc(deflater);
+    deflater.close();
+}
+
+bool ExportRequestHandler::AcceptGzip(const std::string& acceptEncoding)
+{
+    Poco::StringTokenizer tokenizer(acceptEncoding,
+                                    ",",
+                                    Poco::StringTokenizer::TOK_TRIM | Poco::StringTokenizer::TOK_IGNORE_EMPTY);
+    for (const auto& token : tokenizer) {
+        const std::string coding = Poco::trim(token.substr(0, token.find(';')));
+        if (Poco::icompare(coding, "gzip") == 0 || coding == "*") {
+            return true;
+        }
+    }
+    return false;
+}
+
+void EventStreamHandler::handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+{
+    LOG_TRACE("Event stream request from {}", request.clientAddress().toString());
+
+    EventBus::SubscriberPtr subscriber = EventBus::Instance().Subscribe();
+    if (subscriber == nullptr) {
+        response.setStatusAndReason(Poco::Net::HTTPResponse::HTTP_SERVICE_UNAVAILABLE);
+        response.setChunkedTransferEncoding(true);
+        response.setContentType("application/json");
+        response.send() << R"({"success": false, "msg": "Too many event subscribers or server is quitting!"})";
+        return;
+    }
+
+    response.setChunkedTransferEncoding(true);
+    response.setContentType("text/event-stream");
+    response.set("Cache-Control", "no-cache");
+    std::ostream& ostr = response.send();
+    ostr << "retry: " << RETRY_INTERVAL_MS << "\n\n";
+    ostr.flush();
+
+    // 客户端断开后写入失败, 最迟在下一次心跳时退出
+    std::vector<Event> events;
+    while (ostr.good() && EventBus::Instance().Wait(subscriber, events, HEARTBEAT_INTERVAL_MS)) {
+        if (events.empty()) {
+            ostr << ": ping\n\n";
+        }
+        for (const auto& event : events) {
+            WriteEvent(ostr, event);
+        }
+        ostr.flush();
+    }
+    EventBus::Instance().Unsubscribe(subscriber);
+    LOG_TRACE("Event stream closed for {}", request.clientAddress().toString());
+}
+
+void EventStreamHandler::WriteEvent(std::ostream& out, const Event& event)
+{
+    out << "id: " << event.id << "\nevent: " << event.type << "\n";
+    std::size_t begin = 0;
+    std::size_t end   = 0;
+    do {
+        end = event.data.find('\n', begin);
+        end = end == std::string::npos ? event.data.size() : end;
+        out << "data: ";
+        out.write(event.data.data() + begin, end - begin);
+        out << "\n";
+        begin = end + 1;
+    } while (end < event.data.size());
+    out << "\n";
 }
 
 void IndexRequestHandler::handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
@@ -183,7 +390,12 @@ HTTPRequestHandler* AppRequestHandlerFactory::createRequestHandler(const HTTPSer
         return checkResult;
     }
 
-    if (uri.find("/api/") == 0) {
+    const std::string path = Poco::URI(uri).getPath();
+    if (path == "/api/events") {
+        return new EventStreamHandler();
+    } else if (path == "/api/export") {
+        return new ExportRequestHandler();
+    } else if (uri.find("/api/") == 0) {
         return new ApiRequestHandler();
     } else if (uri == "/") {
         return new IndexRequestHandler();
@@ -8,6 +8,8 @@
 #include <Poco/Net/PartHandler.h>
 #include <Poco/URI.h>
 
+#include "EventBus.h"
+
 using Poco::Net::HTTPRequestHandler;
 using Poco::Net::HTTPRequestHandlerFactory;
 using Poco::Net::HTTPServerRequest;
@@ -44,7 +46,7 @@ public:
 
     void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response);
 
-private:
+protected:
 
     /**
      * @brief 将HTTP的查询参数转换成JSON格式, 方便处理
@@ -53,6 +55,80 @@ private:
      * @return Poco::JSON::Object
      */
     Poco::JSON::Object QueryParamToJson(const Poco::URI::QueryParameters& queryParam);
+
+    /**
+     * @brief 将POST请求的JSON内容合并到参数中, 同名时以JSON内容为准
+     *
+     * @param body 请求内容的输入流
+     * @param param 待合并的参数
+     * @return true 内容为空或者合并成功
+     * @return false 内容不是合法的JSON对象
+     */
+    bool MergeJsonBody(std::istream& body, Poco::JSON::Object& param);
+
+    /**
+     * @brief 判断请求头If-None-Match是否包含给定的ETag
+     *
+     * @param ifNoneMatch If-None-Match请求头, 可以是逗号分隔的多个ETag或者"*"
+     * @param etag 当前内容的ETag
+     * @return true 包含, 客户端缓存的内容仍然有效
+     * @return false 不包含
+     */
+    static bool MatchETag(const std::string& ifNoneMatch, const std::string& etag);
+};
+
+/**
+ * @brief 处理"/api/export"请求的类, 流式输出媒体库的NDJSON, 客户端接受gzip时边压缩边发送
+ *
+ * 参数与普通API相同, 参数无效时返回JSON格式的错误响应.
+ */
+class ExportRequestHandler : public ApiRequestHandler
+{
+public:
+
+    ExportRequestHandler() {}
+
+    void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response);
+
+private:
+
+    /**
+     * @brief 判断请求头Accept-Encoding是否接受gzip, 不处理q值
+     *
+     * @param acceptEncoding Accept-Encoding请求头
+     * @return true 接受gzip
+     * @return false 不接受
+     */
+    static bool AcceptGzip(const std::string& acceptEncoding);
+};
+
+/**
+ * @brief 处理"/api/events"请求的类, 以Server-Sent Events推送扫描进度, 任务状态, 日志与媒体库变化
+ *
+ * 连接在客户端断开或者服务退出前一直占用一个HTTP工作线程, 订阅者数量由EventBus限制.
+ * 事件类型: scan(内容与ScanResult的条目相同), job(内容与Jobs的条目相同), log(日志文本),
+ * library(videoType, epoch与version, 客户端据此通过Changes增量同步).
+ */
+class EventStreamHandler : public HTTPRequestHandler
+{
+public:
+
+    static const int HEARTBEAT_INTERVAL_MS = 15000; // 没有事件时发送心跳的间隔(毫秒)
+    static const int RETRY_INTERVAL_MS     = 3000;  // 断开后客户端重连的间隔(毫秒)
+
+    EventStreamHandler() {}
+
+    void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response);
+
+private:
+
+    /**
+     * @brief 按照SSE格式写入单个事件, 多行内容拆分为多个data字段
+     *
+     * @param out 响应输出流
+     * @param event 事件
+     */
+    static void WriteEvent(std::ostream& out, const Event& event);
 };
 
 /**
@@ -18,10 +18,9 @@ void HTTPServerApp::AutoUpdate()
     LOG_INFO("Auto update interval: {}s", Config::Instance().GetAutoInterval());
 
     while (GStopFlag.load(std::memory_order_relaxed) -1 && !ApiManager::Instance().IsQuitting()) {
+        // 电视剧正在扫描/刷新时提交失败, 下一秒重试
         if (std::chrono::steady_clock::now() > lastUpdateTime +
-            std::chrono::seconds(Config::Instance().GetAutoInterval())) {
-            ApiManager::Instance().ProcessScan(TV, false);
-            ApiManager::Instance().AutoUpdateTV();
+            std::chrono::seconds(Config::Instance().GetAutoInterval()) && ApiManager::Instance().SubmitAutoUpdate()) {
             lastUpdateTime = std::chrono::steady_clock::now();
         }
         std::this_thread::sleep_for(std::chrono::seconds(1));
@@ -71,6 +70,11 @@ int HTTPServerApp::run()
         m_signalHandleThread.join();
     }
 
+    // 等待后台任务在安全的位置退出, 避免NFO写到一半时进程退出
+    LOG_INFO("Draining background jobs...");
+    ApiManager::Instance().Drain();
+    LOG_INFO("Drained background jobs.");
+
     // 停止HTTP服务器
     LOG_INFO("Stopping http server...");
     m_httpServer->stopAll(true);
@@ -0,0 +1,239 @@
+#include "JobScheduler.h"
+
+#include <algorithm>
+
+#include "Logger.h"
+
+const std::size_t JobScheduler::HISTORY_SIZE;
+
+JobScheduler::JobScheduler(std::size_t threadNum, std::size_t queueCapacity, StatusFunc onStatus)
+    : m_capacity(queueCapacity), m_onStatus(std::move(onStatus)), m_stopped(false), m_nextJobId(1)
+{
+    for (std::size_t i = 0; i < threadNum; i++) {
+        m_workers.emplace_back(&JobScheduler::WorkerLoop, this);
+    }
+}
+
+JobScheduler::~JobScheduler()
+{
+    Drain();
+}
+
+bool JobScheduler::Submit(const std::string& name, const std::string& key, JobPriority priority, JobFunc func,
+                          uint64_t& jobId)
+{
+    {
+        std::lock_guard<std::mutex> locker(m_lock);
+        jobId = 0;
+        if (m_stopped) {
+            return false;
+        }
+        if (!key.empty() && m_activeKeys.count(key) > 0) {
+            jobId = m_activeKeys.at(key);
+            return false;
+        }
+        std::size_t pending = 0;
+        for (const auto& queue : m_queues) {
+            pending += queue.size();
+        }
+        if (pending >= m_capacity) {
+            return false;
+        }
+
+        auto job             = std::make_shared<Job>();
+        job->info.id         = m_nextJobId++;
+        job->info.name       = name;
+        job->info.key        = key;
+        job->info.priority   = priority;
+        job->info.submitTime = std::time(nullptr);
+        job->func            = std::move(func);
+        m_jobs[job->info.id] = job;
+        m_queues[priority].push_back(job->info.id);
+        if (!key.empty()) {
+            m_activeKeys[key] = job->info.id;
+        }
+        jobId = job->info.id;
+        NotifyStatus(job->info);
+    }
+    m_cond.notify_one();
+    LOG_INFO("Job {} submitted: {}", jobId, name);
+    return true;
+}
+
+bool JobScheduler::Cancel(uint64_t jobId)
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    auto                        iter = m_jobs.find(jobId);
+    if (iter == m_jobs.end()) {
+        return false;
+    }
+
+    std::shared_ptr<Job> job = iter->second;
+    if (job->info.status == JOB_QUEUED) {
+        auto& queue = m_queues[job->info.priority];
+        queue.erase(std::remove(queue.begin(), queue.end(), jobId), queue.end());
+        Finish(job, JOB_CANCELLED, "Cancelled before running");
+        return true;
+    }
+    if (job->info.status == JOB_RUNNING) {
+        job->info.cancelling = true;
+        job->cancelled.store(true);
+        NotifyStatus(job->info);
+        return true;
+    }
+    return false;
+}
+
+bool JobScheduler::Get(uint64_t jobId, JobInfo& info)
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    auto                        iter = m_jobs.find(jobId);
+    if (iter == m_jobs.end()) {
+        return false;
+    }
+    info = iter->second->info;
+    return true;
+}
+
+std::vector<JobInfo> JobScheduler::List()
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    std::vector<JobInfo>        infos;
+    infos.reserve(m_jobs.size());
+    for (const auto& jobPair : m_jobs) {
+        infos.push_back(jobPair.second->info);
+    }
+    return infos;
+}
+
+void JobScheduler::Drain()
+{
+    {
+        std::lock_guard<std::mutex> locker(m_lock);
+        if (m_stopped) {
+            return;
+        }
+        m_stopped = true;
+
+        // 排队中的任务直接取消, 执行中的任务在下一个安全位置退出
+        for (auto& queue : m_queues) {
+            for (auto jobId : queue) {
+                Finish(m_jobs.at(jobId), JOB_CANCELLED, "Server is quitting");
+            }
+            queue.clear();
+        }
+        for (auto& jobPair : m_jobs) {
+            if (jobPair.second->info.status == JOB_RUNNING) {
+                LOG_INFO("Waiting for job {} to stop: {}", jobPair.first, jobPair.second->info.name);
+                jobPair.second->info.cancelling = true;
+                jobPair.second->cancelled.store(true);
+            }
+        }
+    }
+    m_cond.notify_all();
+
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void JobScheduler::Finish(const std::shared_ptr<Job>& job, JobStatus status, const std::string& msg)
+{
+    job->info.status  = status;
+    job->info.msg     = msg;
+    job->info.endTime = std::time(nullptr);
+    job->func         = nullptr;
+    if (!job->info.key.empty()) {
+        m_activeKeys.erase(job->info.key);
+    }
+    NotifyStatus(job->info);
+
+    m_history.push_back(job->info.id);
+    while (m_history.size() > HISTORY_SIZE) {
+        m_jobs.erase(m_history.front());
+        m_history.pop_front();
+    }
+}
+
+void JobScheduler::NotifyStatus(const JobInfo& info)
+{
+    if (m_onStatus) {
+        m_onStatus(info);
+    }
+}
+
+void JobScheduler::WorkerLoop()
+{
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> locker(m_lock);
+            m_cond.wait(locker, [this]() {
+                return m_stopped || !m_queues[JOB_INTERACTIVE].empty() || !m_queues[JOB_BACKGROUND].empty();
+            });
+            if (m_stopped) {
+                return;
+            }
+
+            // 高优先级的队列非空时总是先取高优先级的任务
+            for (int priority = JOB_PRIORITY_NUM - 1; priority >= 0; priority--) {
+                if (!m_queues[priority].empty()) {
+                    job = m_jobs.at(m_queues[priority].front());
+                    m_queues[priority].pop_front();
+                    break;
+                }
+            }
+            job->info.status    = JOB_RUNNING;
+            job->info.beginTime = std::time(nullptr);
+            NotifyStatus(job->info);
+        }
+
+        LOG_INFO("Job {} started: {}", job->info.id, job->info.name);
+        JobStatus   status = JOB_DONE;
+        std::string msg;
+        // 单个任务的异常不能导致工作线程退出
+        try {
+            job->func(job->cancelled);
+        } catch (std::exception& e) {
+            status = JOB_FAILED;
+            msg    = e.what();
+        } catch (...) {
+            status = JOB_FAILED;
+            msg    = "Unknown exception";
+        }
+        if (status == JOB_DONE && job->cancelled.load()) {
+            status = JOB_CANCELLED;
+        }
+
+        std::lock_guard<std::mutex> locker(m_lock);
+        Finish(job, status, msg);
+        LOG_INFO("Job {} {}: {}", job->info.id, StatusToStr(status), job->info.name);
+        if (status == JOB_FAILED) {
+            LOG_ERROR("Job {} failed: {}", job->info.id, msg);
+        }
+    }
+}
+
+std::string JobScheduler::PriorityToStr(JobPriority priority)
+{
+    return priority == JOB_INTERACTIVE ? "interactive" : "background";
+}
+
+std::string JobScheduler::StatusToStr(JobStatus status)
+{
+    switch (status) {
+    case JOB_QUEUED:
+        return "queued";
+    case JOB_RUNNING:
+        return "running";
+    case JOB_DONE:
+        return "done";
+    case JOB_FAILED:
+        return "failed";
+    case JOB_CANCELLED:
+        return "cancelled";
+    }
+    return "unknown";
+}
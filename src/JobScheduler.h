@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum JobPriority {
+    JOB_BACKGROUND,  // 后台任务, 如定时的自动更新
+    JOB_INTERACTIVE, // 交互任务, 如通过API发起的扫描/刷新
+    JOB_PRIORITY_NUM,
+};
+
+enum JobStatus {
+    JOB_QUEUED,
+    JOB_RUNNING,
+    JOB_DONE,
+    JOB_FAILED,
+    JOB_CANCELLED,
+};
+
+/**
+ * @brief 任务的状态快照
+ *
+ */
+struct JobInfo {
+    uint64_t    id         = 0;              // 任务ID
+    std::string name;                        // 任务名称
+    std::string key;                         // 互斥键, 同一键同时只能有一个排队或执行中的任务
+    JobPriority priority   = JOB_BACKGROUND; // 优先级
+    JobStatus   status     = JOB_QUEUED;     // 状态
+    bool        cancelling = false;          // 是否已请求取消
+    std::time_t submitTime = 0;              // 提交时间
+    std::time_t beginTime  = 0;              // 开始执行的时间
+    std::time_t endTime    = 0;              // 结束时间
+    std::string msg;                         // 失败原因
+};
+
+/**
+ * @brief 固定线程数, 按优先级调度的长任务执行器
+ *
+ * 交互任务总是先于后台任务执行, 同一优先级按提交顺序执行. 排队中的任务可以直接取消,
+ * 执行中的任务只能设置取消标记, 由任务自己在安全的位置(如两个条目之间)检查并退出.
+ * 已结束的任务保留最近的HISTORY_SIZE条记录以供查询.
+ */
+class JobScheduler
+{
+public:
+
+    using CancelFlag = std::atomic<bool>;
+    using JobFunc    = std::function<void(const CancelFlag&)>;
+    using StatusFunc = std::function<void(const JobInfo&)>;
+
+    static const std::size_t HISTORY_SIZE = 64; // 保留的已结束任务记录数
+
+    /**
+     * @brief 构造调度器并启动工作线程
+     *
+     * @param threadNum 工作线程数
+     * @param queueCapacity 等待队列的容量
+     * @param onStatus 任务状态变化(排队, 开始执行, 结束)时的回调, 在调度器的锁内调用, 不能再调用调度器
+     */
+    JobScheduler(std::size_t threadNum, std::size_t queueCapacity, StatusFunc onStatus = nullptr);
+
+    ~JobScheduler();
+
+    JobScheduler(const JobScheduler&)            = delete;
+    JobScheduler& operator=(const JobScheduler&) = delete;
+
+    /**
+     * @brief 提交任务
+     *
+     * @param name 任务名称
+     * @param key 互斥键, 为空时不限制
+     * @param priority 优先级
+     * @param func 执行函数, 参数为取消标记
+     * @param jobId 成功时为新任务的ID; 同一互斥键已有任务时为已有任务的ID; 其余失败情况为0
+     * @return true 提交成功
+     * @return false 同一互斥键已有任务, 队列已满或者调度器已停止
+     */
+    bool Submit(const std::string& name, const std::string& key, JobPriority priority, JobFunc func,
+                uint64_t& jobId);
+
+    /**
+     * @brief 取消任务, 排队中的任务立即取消, 执行中的任务设置取消标记
+     *
+     * @param jobId 任务ID
+     * @return true 已取消或已请求取消
+     * @return false 任务不存在或已经结束
+     */
+    bool Cancel(uint64_t jobId);
+
+    /**
+     * @brief 获取任务的状态
+     *
+     * @param jobId 任务ID
+     * @param info 任务的状态
+     * @return true 获取成功
+     * @return false 任务不存在或记录已被淘汰
+     */
+    bool Get(uint64_t jobId, JobInfo& info);
+
+    /**
+     * @brief 获取所有任务的状态, 按ID升序
+     *
+     * @return std::vector<JobInfo> 任务的状态
+     */
+    std::vector<JobInfo> List();
+
+    /**
+     * @brief 停止接收新任务, 取消排队中的任务, 通知执行中的任务退出并等待其结束
+     *
+     */
+    void Drain();
+
+    static std::string PriorityToStr(JobPriority priority);
+    static std::string StatusToStr(JobStatus status);
+
+private:
+
+    /**
+     * @brief 任务的记录
+     *
+     */
+    struct Job {
+        JobInfo    info;             // 任务的状态
+        JobFunc    func;             // 任务的执行函数
+        CancelFlag cancelled{false}; // 取消标记
+    };
+
+    void WorkerLoop();
+    void Finish(const std::shared_ptr<Job>& job, JobStatus status, const std::string& msg);
+    void NotifyStatus(const JobInfo& info);
+
+private:
+
+    std::size_t                              m_capacity;                 // 等待队列的容量
+    StatusFunc                               m_onStatus;                 // 任务状态变化时的回调
+    bool                                     m_stopped;                  // 是否已停止
+    uint64_t                                 m_nextJobId;                // 下一个任务的ID
+    std::deque<uint64_t>                     m_queues[JOB_PRIORITY_NUM]; // 各个优先级的等待队列
+    std::map<uint64_t, std::shared_ptr<Job>> m_jobs;                     // 所有任务的记录
+    std::deque<uint64_t>                     m_history;                  // 已结束的任务, 按结束顺序
+    std::map<std::string, uint64_t>          m_activeKeys;               // 互斥键 -> 排队或执行中的任务
+    std::vector<std::thread>                 m_workers;                  // 工作线程
+    std::mutex                               m_lock;                     // 任务记录的锁
+    std::condition_variable                  m_cond;                     // 等待队列的条件变量
+};
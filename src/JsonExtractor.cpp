@@ -0,0 +1,382 @@
+#include "JsonExtractor.h"
+
+#include <cstdlib>
+
+const int JSON_MAX_DEPTH = 128; // 允许的最大嵌套深度, 防止异常数据导致栈溢出
+
+void JsonExtractor::OnValue(const std::string& path, const ValueHandler& handler)
+{
+    m_valueHandlers[path] = handler;
+    RegisterPrefixes(path);
+}
+
+void JsonExtractor::OnObjectEnd(const std::string& path, const EndHandler& handler)
+{
+    m_endHandlers[path] = handler;
+    RegisterPrefixes(path);
+}
+
+void JsonExtractor::Replay(const Events& events) const
+{
+    for (const auto& event : events) {
+        if (event.isEnd) {
+            auto iter = m_endHandlers.find(event.path);
+            if (iter != m_endHandlers.end()) {
+                iter->second();
+            }
+        } else {
+            auto iter = m_valueHandlers.find(event.path);
+            if (iter != m_valueHandlers.end()) {
+                iter->second(event.value);
+            }
+        }
+    }
+}
+
+std::string JsonExtractor::Signature() const
+{
+    std::string signature;
+    for (const auto& pair : m_valueHandlers) {
+        signature += pair.first + ',';
+    }
+    signature += ';';
+    for (const auto& pair : m_endHandlers) {
+        signature += pair.first + ',';
+    }
+    return signature;
+}
+
+const std::string& JsonExtractor::GetLastError() const
+{
+    return m_lastError;
+}
+
+int JsonExtractor::ToInt(const std::string& text, int defaultVal)
+{
+    char* end = nullptr;
+    long  val = std::strtol(text.c_str(), &end, 10);
+    return end == text.c_str() ? defaultVal : static_cast<int>(val);
+}
+
+double JsonExtractor::ToDouble(const std::string& text, double defaultVal)
+{
+    char*  end = nullptr;
+    double val = std::strtod(text.c_str(), &end);
+    return end == text.c_str() ? defaultVal : val;
+}
+
+void JsonExtractor::RegisterPrefixes(const std::string& path)
+{
+    // 在每个路径分隔处截取前缀, 如"a[].b"的前缀为"", "a", "a[]", "a[].b"
+    m_prefixes.insert("");
+    for (std::size_t i = 0; i < path.size(); i++) {
+        if (path[i] == '.' || path[i] == '[') {
+            m_prefixes.insert(path.substr(0, i));
+        }
+    }
+    m_prefixes.insert(path);
+}
+
+bool JsonExtractor::IsWanted() const
+{
+    return m_prefixes.find(m_path) != m_prefixes.end();
+}
+
+int JsonExtractor::Peek()
+{
+    return m_buf->sgetc();
+}
+
+int JsonExtractor::Next()
+{
+    return m_buf->sbumpc();
+}
+
+void JsonExtractor::SkipSpaces()
+{
+    int ch = Peek();
+    while (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r') {
+        m_buf->sbumpc();
+        ch = Peek();
+    }
+}
+
+bool JsonExtractor::Expect(char ch)
+{
+    SkipSpaces();
+    if (Next() != ch) {
+        return Fail(std::string("expect '") + ch + "'");
+    }
+    return true;
+}
+
+bool JsonExtractor::Fail(const std::string& reason)
+{
+    if (m_lastError.empty()) {
+        m_lastError = reason + " at path '" + m_path + "'";
+    }
+    return false;
+}
+
+bool JsonExtractor::Parse(std::istream& in, Events* events)
+{
+    m_buf    = in.rdbuf();
+    m_events = events;
+    m_path.clear();
+    m_lastError.clear();
+    m_depth = 0;
+    if (m_buf == nullptr) {
+        return Fail("empty input stream");
+    }
+
+    if (!ParseValue()) {
+        return false;
+    }
+
+    SkipSpaces();
+    if (Peek() != std::char_traits<char>::eof()) {
+        return Fail("unexpected trailing characters");
+    }
+    return true;
+}
+
+bool JsonExtractor::ParseValue()
+{
+    SkipSpaces();
+    int ch = Peek();
+    if (ch == '{' || ch == '[') {
+        if (m_depth >= JSON_MAX_DEPTH) {
+            return Fail("json nested too deep");
+        }
+        m_depth++;
+        bool ret = ch == '{' ? ParseObject() : ParseArray();
+        m_depth--;
+        return ret;
+    }
+
+    auto         handlerIter = m_valueHandlers.find(m_path);
+    bool         wanted      = handlerIter != m_valueHandlers.end();
+    bool         isNull      = false;
+    std::string* out         = wanted ? &m_value : nullptr;
+    m_value.clear();
+    if (ch == '"') {
+        if (!ParseString(out)) {
+            return false;
+        }
+    } else if (!ParseLiteral(out, isNull)) {
+        return false;
+    }
+
+    if (wanted && !isNull) {
+        if (m_events != nullptr) {
+            m_events->push_back(Event{m_path, m_value, false});
+        }
+        handlerIter->second(m_value);
+    }
+    return true;
+}
+
+bool JsonExtractor::ParseObject()
+{
+    Next(); // '{'
+    const std::size_t pathLen = m_path.size();
+    const bool        wanted  = IsWanted();
+
+    SkipSpaces();
+    if (Peek() == '}') {
+        Next();
+    } else {
+        std::string key;
+        while (true) {
+            SkipSpaces();
+            if (Peek() != '"') {
+                return Fail("expect object key");
+            }
+            key.clear();
+            if (!ParseString(wanted ? &key : nullptr)) {
+                return false;
+            }
+            if (!Expect(':')) {
+                return false;
+            }
+
+            // 未注册的子树不记录路径, 所有成员都会被跳过
+            if (wanted) {
+                if (!m_path.empty()) {
+                    m_path += '.';
+                }
+                m_path += key;
+            } else {
+                m_path += ".?";
+            }
+            if (!ParseValue()) {
+                return false;
+            }
+            m_path.resize(pathLen);
+
+            SkipSpaces();
+            int ch = Next();
+            if (ch == '}') {
+                break;
+            } else if (ch != ',') {
+                return Fail("expect ',' or '}'");
+            }
+        }
+    }
+
+    if (wanted) {
+        auto iter = m_endHandlers.find(m_path);
+        if (iter != m_endHandlers.end()) {
+            if (m_events != nullptr) {
+                m_events->push_back(Event{m_path, std::string(), true});
+            }
+            iter->second();
+        }
+    }
+    return true;
+}
+
+bool JsonExtractor::ParseArray()
+{
+    Next(); // '['
+    const std::size_t pathLen = m_path.size();
+    m_path += "[]";
+
+    SkipSpaces();
+    if (Peek() == ']') {
+        Next();
+    } else {
+        while (true) {
+            if (!ParseValue()) {
+                return false;
+            }
+            SkipSpaces();
+            int ch = Next();
+            if (ch == ']') {
+                break;
+            } else if (ch != ',') {
+                return Fail("expect ',' or ']'");
+            }
+        }
+    }
+
+    m_path.resize(pathLen);
+    return true;
+}
+
+void JsonExtractor::AppendUtf8(uint32_t codePoint, std::string& out)
+{
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+bool JsonExtractor::ParseString(std::string* out)
+{
+    Next(); // '"'
+
+    auto ReadHex4 = [this](uint32_t& val) {
+        val = 0;
+        for (int i = 0; i < 4; i++) {
+            int ch = Next();
+            val <<= 4;
+            if (ch >= '0' && ch <= '9') {
+                val |= ch - '0';
+            } else if (ch >= 'a' && ch <= 'f') {
+                val |= ch - 'a' + 10;
+            } else if (ch >= 'A' && ch <= 'F') {
+                val |= ch - 'A' + 10;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    while (true) {
+        int ch = Next();
+        if (ch == std::char_traits<char>::eof()) {
+            return Fail("unterminated string");
+        } else if (ch == '"') {
+            return true;
+        } else if (ch != '\\') {
+            if (out != nullptr) {
+                *out += static_cast<char>(ch);
+            }
+            continue;
+        }
+
+        // 转义字符
+        ch = Next();
+        char unescaped = 0;
+        switch (ch) {
+            case '"': unescaped = '"'; break;
+            case '\\': unescaped = '\\'; break;
+            case '/': unescaped = '/'; break;
+            case 'b': unescaped = '\b'; break;
+            case 'f': unescaped = '\f'; break;
+            case 'n': unescaped = '\n'; break;
+            case 'r': unescaped = '\r'; break;
+            case 't': unescaped = '\t'; break;
+            case 'u': {
+                uint32_t codePoint = 0;
+                if (!ReadHex4(codePoint)) {
+                    return Fail("invalid unicode escape");
+                }
+                // UTF-16代理对
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                    uint32_t low = 0;
+                    if (Next() != '\\' || Next() != 'u' || !ReadHex4(low) || low < 0xDC00 || low > 0xDFFF) {
+                        return Fail("invalid unicode surrogate pair");
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                if (out != nullptr) {
+                    AppendUtf8(codePoint, *out);
+                }
+                continue;
+            }
+            default:
+                return Fail("invalid escape character");
+        }
+        if (out != nullptr) {
+            *out += unescaped;
+        }
+    }
+}
+
+bool JsonExtractor::ParseLiteral(std::string* out, bool& isNull)
+{
+    std::string text;
+    int         ch = Peek();
+    while ((ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'z') || ch == '-' || ch == '+' || ch == '.' || ch == 'E') {
+        text += static_cast<char>(Next());
+        ch = Peek();
+    }
+
+    if (text.empty()) {
+        return Fail("unexpected character");
+    }
+
+    isNull = text == "null";
+    if (!isNull && text != "true" && text != "false" && !(text[0] == '-' || (text[0] >= '0' && text[0] <= '9'))) {
+        return Fail("invalid literal '" + text + "'");
+    }
+
+    if (out != nullptr) {
+        *out = text;
+    }
+    return true;
+}
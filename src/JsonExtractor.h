@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 按路径选择性提取JSON字段的流式解析器
+ *
+ * 解析时不构建完整的JSON对象树, 仅对注册过的路径回调, 其余的子树直接跳过.
+ * 路径的格式: 对象的成员用"."分隔, 数组的元素用"[]"表示, 例如"genres[].name", "seasons[]".
+ * 解析时可以按顺序记录触发的回调, 在注册了相同路径的其他解析器上重放, 用于共享同一份响应的解析结果.
+ */
+class JsonExtractor
+{
+public:
+
+    using ValueHandler = std::function<void(const std::string&)>;
+    using EndHandler   = std::function<void()>;
+
+    /**
+     * @brief 解析时触发的一次回调
+     *
+     */
+    struct Event {
+        std::string path;  // 回调的路径
+        std::string value; // 标量值, 对象结束时为空
+        bool        isEnd; // 是否为对象结束
+    };
+
+    using Events = std::vector<Event>;
+
+    /**
+     * @brief 注册标量值(字符串/数字/布尔)的回调, 值为null时不回调
+     *
+     * @param path 值的路径
+     * @param handler 回调函数, 参数为字符串的内容(已反转义)或者数字/布尔的原始文本
+     */
+    void OnValue(const std::string& path, const ValueHandler& handler);
+
+    /**
+     * @brief 注册对象结束时的回调, 一般用于提交数组中单个元素的提取结果
+     *
+     * @param path 对象的路径
+     * @param handler 回调函数
+     */
+    void OnObjectEnd(const std::string& path, const EndHandler& handler);
+
+    /**
+     * @brief 解析输入流
+     *
+     * @param in 输入流
+     * @param events 不为nullptr时按顺序追加触发的回调
+     * @return true 解析成功
+     * @return false JSON格式错误, 可通过GetLastError()获取原因
+     */
+    bool Parse(std::istream& in, Events* events = nullptr);
+
+    /**
+     * @brief 按顺序重放其他解析器记录的回调
+     *
+     * @param events 记录的回调, 应来自注册了相同路径(Signature()相同)的解析器
+     */
+    void Replay(const Events& events) const;
+
+    /**
+     * @brief 获取所有注册路径组成的签名, 签名相同的解析器从同一份输入中提取的内容相同
+     *
+     * @return std::string 签名
+     */
+    std::string Signature() const;
+
+    /**
+     * @brief 获取最后一次解析失败的原因
+     *
+     * @return const std::string& 失败原因
+     */
+    const std::string& GetLastError() const;
+
+    /**
+     * @brief 将数字文本转换为整数
+     *
+     * @param text 数字文本
+     * @param defaultVal 转换失败时的默认值
+     * @return int 整数
+     */
+    static int ToInt(const std::string& text, int defaultVal = 0);
+
+    /**
+     * @brief 将数字文本转换为浮点数
+     *
+     * @param text 数字文本
+     * @param defaultVal 转换失败时的默认值
+     * @return double 浮点数
+     */
+    static double ToDouble(const std::string& text, double defaultVal = 0.0);
+
+private:
+
+    void RegisterPrefixes(const std::string& path);
+    bool IsWanted() const;
+
+    int  Peek();
+    int  Next();
+    void SkipSpaces();
+    bool Expect(char ch);
+    bool Fail(const std::string& reason);
+
+    bool ParseValue();
+    bool ParseObject();
+    bool ParseArray();
+    bool ParseString(std::string* out);
+    bool ParseLiteral(std::string* out, bool& isNull);
+    void AppendUtf8(uint32_t codePoint, std::string& out);
+
+private:
+
+    std::streambuf*                     m_buf    = nullptr; // 输入流的缓冲区
+    int                                 m_depth  = 0;       // 当前的嵌套深度
+    Events*                             m_events = nullptr; // 记录触发的回调, 为nullptr时不记录
+    std::string                         m_path;             // 当前的路径
+    std::string                         m_value;            // 当前标量值的缓冲区
+    std::map<std::string, ValueHandler> m_valueHandlers;    // 标量值的回调
+    std::map<std::string, EndHandler>   m_endHandlers;      // 对象结束的回调
+    std::set<std::string>               m_prefixes;         // 所有注册路径的前缀, 不在其中的子树直接跳过
+    std::string                         m_lastError;        // 最后一次的错误原因
+};
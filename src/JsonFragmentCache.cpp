@@ -0,0 +1,65 @@
+#include "JsonFragmentCache.h"
+
+#include <algorithm>
+
+const std::size_t JsonFragmentCache::MIN_SWEEP_SIZE;
+
+JsonFragmentCache::JsonFragmentCache(Renderer briefRenderer, Renderer detailedRenderer) : m_sweepSize(MIN_SWEEP_SIZE)
+{
+    m_renderers[BRIEF_FRAGMENT]    = std::move(briefRenderer);
+    m_renderers[DETAILED_FRAGMENT] = std::move(detailedRenderer);
+}
+
+JsonFragmentCache::FragmentPtr JsonFragmentCache::Brief(const VideoInfoPtr& videoInfo)
+{
+    return Get(videoInfo, BRIEF_FRAGMENT);
+}
+
+JsonFragmentCache::FragmentPtr JsonFragmentCache::Detailed(const VideoInfoPtr& videoInfo)
+{
+    return Get(videoInfo, DETAILED_FRAGMENT);
+}
+
+std::size_t JsonFragmentCache::Size()
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    return m_entries.size();
+}
+
+JsonFragmentCache::FragmentPtr JsonFragmentCache::Get(const VideoInfoPtr& videoInfo, FragmentType type)
+{
+    {
+        std::lock_guard<std::mutex> locker(m_lock);
+        auto                        iter = m_entries.find(videoInfo.get());
+        if (iter != m_entries.end() && iter->second.owner.lock() == videoInfo && iter->second.fragments[type]) {
+            return iter->second.fragments[type];
+        }
+    }
+
+    // 序列化在锁外进行, 并发的首次请求可能重复序列化, 结果相同
+    FragmentPtr fragment = std::make_shared<const std::string>(m_renderers[type](*videoInfo));
+
+    std::lock_guard<std::mutex> locker(m_lock);
+    Entry&                      entry = m_entries[videoInfo.get()];
+    if (entry.owner.lock() != videoInfo) {
+        entry       = Entry();
+        entry.owner = videoInfo;
+    }
+    entry.fragments[type] = fragment;
+    if (m_entries.size() >= m_sweepSize) {
+        Sweep();
+    }
+    return fragment;
+}
+
+void JsonFragmentCache::Sweep()
+{
+    for (auto iter = m_entries.begin(); iter != m_entries.end();) {
+        if (iter->second.owner.expired()) {
+            iter = m_entries.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    m_sweepSize = std::max(MIN_SWEEP_SIZE, m_entries.size() * 2);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Library.h"
+
+/**
+ * @brief 视频信息序列化后的JSON片段缓存
+ *
+ * 媒体库中的视频信息一经发布不再修改, 扫描/刮削总是发布新的对象, 因此以视频信息对象本身作为版本:
+ * 缓存按对象地址索引, 并以weak_ptr确认仍是同一个对象(防止对象销毁后地址被复用), 对象被替换后旧的片段自然失效.
+ * 失效的条目在缓存增长到上次清理后的两倍时统一清理.
+ */
+class JsonFragmentCache
+{
+public:
+
+    using Renderer    = std::function<std::string(const VideoInfo&)>;
+    using FragmentPtr = std::shared_ptr<const std::string>;
+
+    static const std::size_t MIN_SWEEP_SIZE = 1024; // 触发清理的最小条目数
+
+    /**
+     * @brief 构造缓存
+     *
+     * @param briefRenderer 简要信息的序列化函数
+     * @param detailedRenderer 详细信息的序列化函数
+     */
+    JsonFragmentCache(Renderer briefRenderer, Renderer detailedRenderer);
+
+    /**
+     * @brief 获取简要信息的JSON片段, 未缓存时序列化并缓存
+     *
+     * @param videoInfo 视频信息
+     * @return FragmentPtr JSON对象的文本
+     */
+    FragmentPtr Brief(const VideoInfoPtr& videoInfo);
+
+    /**
+     * @brief 获取详细信息的JSON片段, 未缓存时序列化并缓存
+     *
+     * @param videoInfo 视频信息
+     * @return FragmentPtr JSON对象的文本
+     */
+    FragmentPtr Detailed(const VideoInfoPtr& videoInfo);
+
+    /**
+     * @brief 获取缓存的条目数(含未清理的失效条目)
+     *
+     * @return std::size_t 条目数
+     */
+    std::size_t Size();
+
+private:
+
+    enum FragmentType {
+        BRIEF_FRAGMENT,
+        DETAILED_FRAGMENT,
+        FRAGMENT_TYPE_NUM,
+    };
+
+    /**
+     * @brief 单个视频信息的缓存条目
+     *
+     */
+    struct Entry {
+        std::weak_ptr<const VideoInfo> owner;                        // 片段所属的视频信息
+        FragmentPtr                    fragments[FRAGMENT_TYPE_NUM]; // 各个类型的片段
+    };
+
+    FragmentPtr Get(const VideoInfoPtr& videoInfo, FragmentType type);
+    void        Sweep();
+
+private:
+
+    Renderer                                    m_renderers[FRAGMENT_TYPE_NUM]; // 各个类型的序列化函数
+    std::unordered_map<const VideoInfo*, Entry> m_entries;                      // 视频信息的地址 -> 缓存条目
+    std::size_t                                 m_sweepSize;                    // 下次触发清理的条目数
+    std::mutex                                  m_lock;                         // 缓存的锁
+};
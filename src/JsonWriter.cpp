@@ -0,0 +1,193 @@
+#include "JsonWriter.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+const std::size_t JsonWriter::MAX_DEPTH;
+
+JsonWriter::JsonWriter(std::ostream& out) : m_out(out), m_depth(0), m_hasElement{false}, m_afterKey(false) {}
+
+void JsonWriter::BeforeValue()
+{
+    // 成员名称之后直接写值; 容器中的第二个及之后的元素前写逗号
+    if (m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    if (m_depth > 0) {
+        if (m_hasElement[m_depth - 1]) {
+            m_out.put(',');
+        }
+        m_hasElement[m_depth - 1] = true;
+    }
+}
+
+JsonWriter& JsonWriter::StartObject()
+{
+    BeforeValue();
+    m_out.put('{');
+    m_hasElement[m_depth++] = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndObject()
+{
+    m_depth--;
+    m_out.put('}');
+    return *this;
+}
+
+JsonWriter& JsonWriter::StartArray()
+{
+    BeforeValue();
+    m_out.put('[');
+    m_hasElement[m_depth++] = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndArray()
+{
+    m_depth--;
+    m_out.put(']');
+    return *this;
+}
+
+JsonWriter& JsonWriter::Key(const char* key)
+{
+    BeforeValue();
+    WriteString(key, std::strlen(key));
+    m_out.put(':');
+    m_afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Key(const std::string& key)
+{
+    BeforeValue();
+    WriteString(key.data(), key.size());
+    m_out.put(':');
+    m_afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Value(const char* value)
+{
+    BeforeValue();
+    WriteString(value, std::strlen(value));
+    return *this;
+}
+
+JsonWriter& JsonWriter::Value(const std::string& value)
+{
+    BeforeValue();
+    WriteString(value.data(), value.size());
+    return *this;
+}
+
+JsonWriter& JsonWriter::Value(bool value)
+{
+    BeforeValue();
+    m_out << (value ? "true" : "false");
+    return *this;
+}
+
+JsonWriter& JsonWriter::Value(double value)
+{
+    BeforeValue();
+    // JSON不支持NaN与无穷大
+    if (!std::isfinite(value)) {
+        m_out << "null";
+        return *this;
+    }
+    char buf[32];
+    int  len = snprintf(buf, sizeof(buf), "%.15g", value);
+    m_out.write(buf, len);
+    return *this;
+}
+
+JsonWriter& JsonWriter::Null()
+{
+    BeforeValue();
+    m_out << "null";
+    return *this;
+}
+
+JsonWriter& JsonWriter::MergeObject(const std::string& objectJson)
+{
+    // 去掉首尾的大括号, 空对象没有成员可以合并
+    if (objectJson.size() <= 2) {
+        return *this;
+    }
+    BeforeValue();
+    m_out.write(objectJson.data() + 1, objectJson.size() - 2);
+    return *this;
+}
+
+JsonWriter& JsonWriter::RawValue(const std::string& valueJson)
+{
+    BeforeValue();
+    m_out.write(valueJson.data(), valueJson.size());
+    return *this;
+}
+
+void JsonWriter::WriteString(const char* str, std::size_t size)
+{
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+
+    m_out.put('"');
+    // 连续的无需转义的字符整段写入
+    std::size_t begin = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        const unsigned char ch = static_cast<unsigned char>(str[i]);
+        if (ch >= 0x20 && ch != '"' && ch != '\\') {
+            continue;
+        }
+        m_out.write(str + begin, i - begin);
+        begin = i + 1;
+        switch (ch) {
+        case '"':
+            m_out << "\\\"";
+            break;
+        case '\\':
+            m_out << "\\\\";
+            break;
+        case '\b':
+            m_out << "\\b";
+            break;
+        case '\f':
+            m_out << "\\f";
+            break;
+        case '\n':
+            m_out << "\\n";
+            break;
+        case '\r':
+            m_out << "\\r";
+            break;
+        case '\t':
+            m_out << "\\t";
+            break;
+        default: {
+            const char escaped[] = {'\\', 'u', '0', '0', HEX_DIGITS[ch >> 4], HEX_DIGITS[ch & 0x0f]};
+            m_out.write(escaped, sizeof(escaped));
+            break;
+        }
+        }
+    }
+    m_out.write(str + begin, size - begin);
+    m_out.put('"');
+}
+
+void JsonWriter::WriteInt(int64_t value)
+{
+    char buf[24];
+    int  len = snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(value));
+    m_out.write(buf, len);
+}
+
+void JsonWriter::WriteUInt(uint64_t value)
+{
+    char buf[24];
+    int  len = snprintf(buf, sizeof(buf), "%llu", static_cast<unsigned long long>(value));
+    m_out.write(buf, len);
+}
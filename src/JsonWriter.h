@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+/**
+ * @brief 直接写入输出流的JSON生成器
+ *
+ * 不构建对象树, 值在调用时立即转义并写入输出流, 只记录每一层容器是否已有元素(用于写逗号),
+ * 整个过程不申请堆内存. 调用者负责保证调用顺序合法(对象中先Key()再写值), 嵌套深度不超过MAX_DEPTH.
+ */
+class JsonWriter
+{
+public:
+
+    static const std::size_t MAX_DEPTH = 32; // 最大嵌套深度
+
+    explicit JsonWriter(std::ostream& out);
+
+    JsonWriter(const JsonWriter&)            = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    JsonWriter& StartObject();
+    JsonWriter& EndObject();
+    JsonWriter& StartArray();
+    JsonWriter& EndArray();
+
+    /**
+     * @brief 写入对象成员的名称
+     *
+     * @param key 成员名称
+     * @return JsonWriter& 自身, 用于链式调用
+     */
+    JsonWriter& Key(const char* key);
+    JsonWriter& Key(const std::string& key);
+
+    JsonWriter& Value(const char* value);
+    JsonWriter& Value(const std::string& value);
+    JsonWriter& Value(bool value);
+    JsonWriter& Value(double value);
+    JsonWriter& Null();
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, JsonWriter&>::type
+    Value(T value)
+    {
+        BeforeValue();
+        if (std::is_signed<T>::value) {
+            WriteInt(static_cast<int64_t>(value));
+        } else {
+            WriteUInt(static_cast<uint64_t>(value));
+        }
+        return *this;
+    }
+
+    /**
+     * @brief 写入对象成员, 等价于Key(key).Value(value)
+     *
+     * @param key 成员名称
+     * @param value 成员的值
+     * @return JsonWriter& 自身, 用于链式调用
+     */
+    template <typename T>
+    JsonWriter& Field(const char* key, const T& value)
+    {
+        return Key(key).Value(value);
+    }
+
+    /**
+     * @brief 将已经序列化的JSON对象的所有成员合并到当前对象中, 用于拼接缓存的JSON片段
+     *
+     * @param objectJson JSON对象的文本, 如{"a":1}
+     * @return JsonWriter& 自身, 用于链式调用
+     */
+    JsonWriter& MergeObject(const std::string& objectJson);
+
+    /**
+     * @brief 写入已经序列化的JSON值(对象, 数组或者标量)
+     *
+     * @param valueJson JSON值的文本
+     * @return JsonWriter& 自身, 用于链式调用
+     */
+    JsonWriter& RawValue(const std::string& valueJson);
+
+private:
+
+    void BeforeValue();
+    void WriteString(const char* str, std::size_t size);
+    void WriteInt(int64_t value);
+    void WriteUInt(uint64_t value);
+
+private:
+
+    std::ostream& m_out;                   // 输出流
+    std::size_t   m_depth;                 // 当前的嵌套深度
+    bool          m_hasElement[MAX_DEPTH]; // 各层容器是否已有元素
+    bool          m_afterKey;              // 上一次写入的是否为成员名称
+};
@@ -0,0 +1,78 @@
+#include "LatencyHistogram.h"
+
+#include <cmath>
+
+const std::size_t LatencyHistogram::BUCKET_COUNT;
+const uint64_t    LatencyHistogram::DECAY_SAMPLES;
+
+LatencyHistogram::LatencyHistogram() : m_count(0)
+{
+    for (auto& bucket : m_buckets) {
+        bucket.store(0);
+    }
+}
+
+int64_t LatencyHistogram::BucketUpperBound(std::size_t index)
+{
+    return static_cast<int64_t>(std::ceil(std::pow(std::sqrt(2.0), static_cast<double>(index))));
+}
+
+std::size_t LatencyHistogram::BucketIndex(int64_t latencyMs)
+{
+    for (std::size_t i = 0; i < BUCKET_COUNT; i++) {
+        if (latencyMs <= BucketUpperBound(i)) {
+            return i;
+        }
+    }
+    return BUCKET_COUNT - 1;
+}
+
+void LatencyHistogram::Record(int64_t latencyMs)
+{
+    m_buckets[BucketIndex(latencyMs)].fetch_add(1, std::memory_order_relaxed);
+    if (m_count.fetch_add(1, std::memory_order_relaxed) + 1 >= DECAY_SAMPLES) {
+        Decay();
+    }
+}
+
+void LatencyHistogram::Decay()
+{
+    std::unique_lock<std::mutex> locker(m_decayLock, std::try_to_lock);
+    if (!locker.owns_lock() || m_count.load() < DECAY_SAMPLES) {
+        return;
+    }
+
+    uint64_t total = 0;
+    for (auto& bucket : m_buckets) {
+        uint64_t halved = bucket.load(std::memory_order_relaxed) / 2;
+        bucket.store(halved, std::memory_order_relaxed);
+        total += halved;
+    }
+    m_count.store(total);
+}
+
+uint64_t LatencyHistogram::Count() const
+{
+    return m_count.load(std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::Percentile(double percentile) const
+{
+    uint64_t total = 0;
+    for (const auto& bucket : m_buckets) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return -1;
+    }
+
+    const double threshold  = total * percentile / 100.0;
+    uint64_t     cumulative = 0;
+    for (std::size_t i = 0; i < BUCKET_COUNT; i++) {
+        cumulative += m_buckets[i].load(std::memory_order_relaxed);
+        if (cumulative >= threshold) {
+            return BucketUpperBound(i);
+        }
+    }
+    return BucketUpperBound(BUCKET_COUNT - 1);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief 请求耗时的直方图
+ *
+ * 桶的上界按照√2倍递增(1ms ~ 约12分钟), 记录时无锁.
+ * 样本数达到上限后所有的桶减半, 使分位数逐渐跟随最近的网络状况.
+ */
+class LatencyHistogram
+{
+public:
+
+    static const std::size_t BUCKET_COUNT  = 40;    // 桶的个数
+    static const uint64_t    DECAY_SAMPLES = 10000; // 触发衰减的样本数
+
+    LatencyHistogram();
+
+    /**
+     * @brief 记录一次请求的耗时
+     *
+     * @param latencyMs 耗时, 单位: 毫秒
+     */
+    void Record(int64_t latencyMs);
+
+    /**
+     * @brief 获取当前的样本数
+     *
+     * @return uint64_t 样本数
+     */
+    uint64_t Count() const;
+
+    /**
+     * @brief 获取耗时的分位数(取所在桶的上界)
+     *
+     * @param percentile 分位, 取值范围(0, 100]
+     * @return int64_t 耗时, 单位: 毫秒; 没有样本时返回-1
+     */
+    int64_t Percentile(double percentile) const;
+
+private:
+
+    static int64_t     BucketUpperBound(std::size_t index);
+    static std::size_t BucketIndex(int64_t latencyMs);
+
+    void Decay();
+
+private:
+
+    std::atomic<uint64_t> m_buckets[BUCKET_COUNT]; // 各个桶的样本数
+    std::atomic<uint64_t> m_count;                 // 总样本数
+    std::mutex            m_decayLock;             // 衰减操作的锁
+};
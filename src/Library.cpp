@@ -0,0 +1,273 @@
+#include "Library.h"
+
+#include <algorithm>
+#include <atomic>
+#include <initializer_list>
+
+#include "ChangeLog.h"
+#include "DataSource.h"
+#include "FacetIndex.h"
+#include "SearchIndex.h"
+
+static const VideoId     VIDEO_ID_MASK = (static_cast<VideoId>(1) << 53) - 1; // JavaScript可以精确表示的整数范围
+static const std::size_t SSO_CAPACITY  = 15;                                 // 短字符串优化的容量
+static const std::size_t HEAP_OVERHEAD = 2 * sizeof(void*);                  // 每次堆内存申请的额外开销(估算)
+
+static std::size_t HeapBytes(const std::string& str)
+{
+    return str.capacity() > SSO_CAPACITY ? str.capacity() + 1 + HEAP_OVERHEAD : 0;
+}
+
+template <typename T>
+static std::size_t HeapBytes(const std::vector<T>& vec)
+{
+    return vec.capacity() > 0 ? vec.capacity() * sizeof(T) + HEAP_OVERHEAD : 0;
+}
+
+/**
+ * @brief 转为快照中保存的简要信息: 去掉只在详情中显示的字段(与扫描时的简要解析一致),
+ *        并释放集合预留的多余容量, 视频信息发布后不再增长
+ *
+ * @param videoInfo 视频信息
+ */
+static void Compact(VideoInfo& videoInfo)
+{
+    VideoDetail& videoDetail = videoInfo.videoDetail;
+    videoDetail.plot         = std::string();
+    videoDetail.posterUrl    = std::string();
+    videoDetail.fanartUrl    = std::string();
+    videoDetail.clearLogoUrl = std::string();
+    videoDetail.credits.clear();
+    for (auto& actor : videoDetail.actors) {
+        actor.role  = InternedString();
+        actor.thumb = std::string();
+    }
+
+    videoDetail.genre.shrink_to_fit();
+    videoDetail.countries.shrink_to_fit();
+    videoDetail.credits.shrink_to_fit();
+    videoDetail.studio.shrink_to_fit();
+    videoDetail.actors.shrink_to_fit();
+    videoDetail.episodePaths.shrink_to_fit();
+    videoInfo.plotTerms = std::vector<std::string>();
+}
+
+VideoId LibrarySnapshot::IdAt(std::size_t index) const
+{
+    return idIndex->ids[index];
+}
+
+bool LibrarySnapshot::Find(VideoId id, std::size_t& index) const
+{
+    auto iter = idIndex->positions.find(id);
+    if (iter == idIndex->positions.end()) {
+        return false;
+    }
+    index = iter->second;
+    return true;
+}
+
+Library::Library()
+{
+    for (auto videoType : {MOVIE, MOVIE_SET, TV}) {
+        auto snapshot          = std::make_shared<LibrarySnapshot>();
+        snapshot->idIndex      = std::make_shared<const VideoIdIndex>();
+        snapshot->facetIndex   = FacetIndex::Build(snapshot->videoInfos);
+        m_snapshots[videoType] = snapshot;
+        m_isScanning[videoType] = false;
+        m_scanUpdates[videoType].clear();
+        m_searchIndexes[videoType].reset(new SearchIndex());
+        m_changeLogs[videoType].reset(new ChangeLog());
+    }
+}
+
+Library::~Library() {}
+
+LibrarySnapshotPtr Library::Snapshot(VideoType videoType) const
+{
+    return std::atomic_load(&m_snapshots.at(videoType));
+}
+
+void Library::BeginScan(VideoType videoType)
+{
+    std::lock_guard<std::mutex> locker(m_writeLock);
+    m_isScanning.at(videoType) = true;
+    m_scanUpdates.at(videoType).clear();
+}
+
+void Library::PublishScan(VideoType videoType, std::vector<VideoInfo>&& videoInfos)
+{
+    auto snapshot       = std::make_shared<LibrarySnapshot>();
+    snapshot->isScanned = true;
+    snapshot->videoInfos.reserve(videoInfos.size());
+    std::vector<std::vector<std::string>> plotTerms(videoInfos.size()); // 剧情的检索词只交给搜索索引, 不进入快照
+    for (std::size_t index = 0; index < videoInfos.size(); index++) {
+        plotTerms[index].swap(videoInfos[index].plotTerms);
+        Compact(videoInfos[index]);
+        snapshot->videoInfos.push_back(std::make_shared<const VideoInfo>(std::move(videoInfos[index])));
+    }
+
+    std::lock_guard<std::mutex> locker(m_writeLock);
+
+    // 扫描期间刮削过的视频可能在刮削前就已被扫描, 使用刮削后的信息
+    auto& scanUpdates = m_scanUpdates.at(videoType);
+    if (!scanUpdates.empty()) {
+        for (auto& videoInfo : snapshot->videoInfos) {
+            auto iter = scanUpdates.find(videoInfo->videoPath);
+            if (iter != scanUpdates.end()) {
+                videoInfo = iter->second;
+            }
+        }
+        scanUpdates.clear();
+    }
+    snapshot->idIndex          = BuildIdIndex(snapshot->videoInfos);
+    snapshot->facetIndex       = FacetIndex::Build(snapshot->videoInfos);
+    m_isScanning.at(videoType) = false;
+    m_searchIndexes.at(videoType)->Rebuild(snapshot->videoInfos, snapshot->idIndex->ids, plotTerms);
+
+    // 与上一次发布的快照比较, 新增, 删除与状态变化的视频记入变更日志
+    LibrarySnapshotPtr&  current  = m_snapshots.at(videoType);
+    LibrarySnapshotPtr   previous = std::atomic_load(&current);
+    std::vector<VideoId> changedIds;
+    for (std::size_t index = 0; index < snapshot->videoInfos.size(); index++) {
+        VideoId     id            = snapshot->IdAt(index);
+        std::size_t previousIndex = 0;
+        if (!previous->Find(id, previousIndex) ||
+            !IsSameEntry(*previous->videoInfos[previousIndex], *snapshot->videoInfos[index])) {
+            changedIds.push_back(id);
+        }
+    }
+    for (std::size_t index = 0; index < previous->videoInfos.size(); index++) {
+        std::size_t currentIndex = 0;
+        if (!snapshot->Find(previous->IdAt(index), currentIndex)) {
+            changedIds.push_back(previous->IdAt(index));
+        }
+    }
+    snapshot->version = previous->version + 1;
+    m_changeLogs.at(videoType)->Append(snapshot->version, changedIds);
+    std::atomic_store(&current, LibrarySnapshotPtr(snapshot));
+}
+
+bool Library::Update(VideoType videoType, VideoId id, const VideoInfo& fullInfo)
+{
+    VideoInfo videoInfo(fullInfo);
+    Compact(videoInfo);
+
+    std::lock_guard<std::mutex> locker(m_writeLock);
+    LibrarySnapshotPtr&         current  = m_snapshots.at(videoType);
+    LibrarySnapshotPtr          snapshot = std::atomic_load(&current);
+    std::size_t                 index    = 0;
+    if (!snapshot->Find(id, index) || snapshot->videoInfos[index]->videoPath != videoInfo.videoPath) {
+        return false;
+    }
+
+    auto newSnapshot               = std::make_shared<LibrarySnapshot>(*snapshot);
+    newSnapshot->version           = snapshot->version + 1;
+    newSnapshot->videoInfos[index] = std::make_shared<const VideoInfo>(videoInfo);
+    newSnapshot->facetIndex        = snapshot->facetIndex->Update(index, *snapshot->videoInfos[index], videoInfo);
+    m_changeLogs.at(videoType)->Append(newSnapshot->version, std::vector<VideoId>{id});
+    std::atomic_store(&current, LibrarySnapshotPtr(newSnapshot));
+    m_searchIndexes.at(videoType)->Update(id, fullInfo);
+
+    if (m_isScanning.at(videoType)) {
+        m_scanUpdates[videoType][videoInfo.videoPath] = newSnapshot->videoInfos[index];
+    }
+    return true;
+}
+
+std::size_t Library::Search(VideoType               videoType,
+                            const std::string&      query,
+                            std::size_t             limit,
+                            std::vector<SearchHit>& hits) const
+{
+    return m_searchIndexes.at(videoType)->Search(query, limit, hits);
+}
+
+bool Library::Changes(VideoType             videoType,
+                      uint64_t              since,
+                      LibrarySnapshotPtr&   snapshot,
+                      std::vector<VideoId>& ids) const
+{
+    snapshot = Snapshot(videoType);
+    return m_changeLogs.at(videoType)->Since(since, snapshot->version, ids);
+}
+
+LibraryMemoryStats Library::MemoryStats(VideoType videoType) const
+{
+    LibrarySnapshotPtr snapshot = Snapshot(videoType);
+    LibraryMemoryStats stats;
+    stats.titles = snapshot->videoInfos.size();
+    for (const auto& videoInfo : snapshot->videoInfos) {
+        stats.bytes += EstimateBytes(*videoInfo);
+    }
+    return stats;
+}
+
+std::size_t Library::EstimateBytes(const VideoInfo& videoInfo)
+{
+    // 驻留字符串只计算句柄本身, 字符串内容属于全局的字符串池; 剧集路径的目录同理属于全局的目录表
+    const VideoDetail& videoDetail = videoInfo.videoDetail;
+    std::size_t        bytes       = sizeof(VideoInfo);
+    for (const auto* str : {&videoInfo.videoPath,
+                            &videoDetail.title,
+                            &videoDetail.originaltitle,
+                            &videoDetail.plot,
+                            &videoDetail.premiered,
+                            &videoDetail.posterUrl,
+                            &videoDetail.fanartUrl,
+                            &videoDetail.clearLogoUrl}) {
+        bytes += HeapBytes(*str);
+    }
+    for (const auto& uniqueid : videoDetail.uniqueid) {
+        bytes += sizeof(uniqueid) + 4 * sizeof(void*) + HeapBytes(uniqueid.first); // 红黑树节点
+    }
+    bytes += HeapBytes(videoDetail.genre) + HeapBytes(videoDetail.countries) + HeapBytes(videoDetail.credits) +
+             HeapBytes(videoDetail.studio) + HeapBytes(videoDetail.actors) + HeapBytes(videoDetail.episodePaths);
+    for (const auto& actor : videoDetail.actors) {
+        bytes += HeapBytes(actor.thumb);
+    }
+    for (const auto& episodePath : videoDetail.episodePaths) {
+        bytes += HeapBytes(episodePath.name());
+    }
+    return bytes;
+}
+
+bool Library::IsSameEntry(const VideoInfo& lhs, const VideoInfo& rhs)
+{
+    return lhs.videoPath == rhs.videoPath && lhs.nfoStatus == rhs.nfoStatus && lhs.posterStatus == rhs.posterStatus &&
+           lhs.hdrType == rhs.hdrType && DataSource::IsMetaCompleted(lhs) == DataSource::IsMetaCompleted(rhs);
+}
+
+VideoId Library::MakeVideoId(const std::string& videoPath)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char ch : videoPath) {
+        hash ^= ch;
+        hash *= 1099511628211ULL;
+    }
+    return hash & VIDEO_ID_MASK;
+}
+
+std::shared_ptr<const VideoIdIndex> Library::BuildIdIndex(const std::vector<VideoInfoPtr>& videoInfos)
+{
+    // 按路径顺序分配ID, 哈希冲突时顺延, 使冲突的结果也与扫描顺序无关
+    std::vector<std::size_t> order(videoInfos.size());
+    for (std::size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&videoInfos](std::size_t lhs, std::size_t rhs) {
+        return videoInfos[lhs]->videoPath < videoInfos[rhs]->videoPath;
+    });
+
+    auto idIndex = std::make_shared<VideoIdIndex>();
+    idIndex->ids.resize(videoInfos.size());
+    idIndex->positions.reserve(videoInfos.size());
+    for (auto index : order) {
+        VideoId id = MakeVideoId(videoInfos[index]->videoPath);
+        while (!idIndex->positions.emplace(id, index).second) {
+            id = (id + 1) & VIDEO_ID_MASK;
+        }
+        idIndex->ids[index] = id;
+    }
+    return idIndex;
+}
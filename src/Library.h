@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CommonType.h"
+
+using VideoInfoPtr = std::shared_ptr<const VideoInfo>;
+using VideoId      = uint64_t;
+
+class ChangeLog;
+class FacetIndex;
+class SearchIndex;
+struct SearchHit;
+
+/**
+ * @brief 视频ID与快照下标的对应关系, 只在发布扫描结果时重建, 单个视频的更新不改变ID
+ *
+ */
+struct VideoIdIndex {
+    std::vector<VideoId>                     ids;       // 下标 -> 视频ID
+    std::unordered_map<VideoId, std::size_t> positions; // 视频ID -> 下标
+};
+
+/**
+ * @brief 媒体库的不可变快照
+ *
+ */
+struct LibrarySnapshot {
+    uint64_t                            version   = 0;     // 快照的版本号, 每次发布递增
+    bool                                isScanned = false; // 是否已经扫描过
+    std::vector<VideoInfoPtr>           videoInfos;        // 所有视频的信息
+    std::shared_ptr<const VideoIdIndex> idIndex;           // 视频ID索引, 在快照之间共享
+    std::shared_ptr<const FacetIndex>   facetIndex;        // 过滤与分面统计的位图索引
+
+    /**
+     * @brief 获取下标对应的视频ID
+     *
+     * @param index 视频在快照中的下标
+     * @return VideoId 视频ID
+     */
+    VideoId IdAt(std::size_t index) const;
+
+    /**
+     * @brief 查找视频ID对应的下标
+     *
+     * @param id 视频ID
+     * @param index 输出视频在快照中的下标
+     * @return true 找到
+     * @return false 该ID不在快照中(视频已被删除或者ID无效)
+     */
+    bool Find(VideoId id, std::size_t& index) const;
+};
+
+using LibrarySnapshotPtr = std::shared_ptr<const LibrarySnapshot>;
+
+/**
+ * @brief 媒体库的内存占用(估算)
+ *
+ */
+struct LibraryMemoryStats {
+    std::size_t titles = 0; // 视频数
+    std::size_t bytes  = 0; // 视频信息占用的字节数, 不含驻留字符串池
+};
+
+/**
+ * @brief 按视频类型发布的媒体库快照(RCU)
+ *
+ * 读取者通过原子操作获取当前快照, 无需加锁, 也不会被扫描/刮削阻塞; 快照一经发布不再修改.
+ * 写入者(扫描, 刮削)基于当前快照构造新的版本后原子替换, 旧的快照在最后一个读取者释放后销毁.
+ * 单个视频的更新只复制指针数组, 未变化的视频信息和ID索引在新旧快照间共享, 位图索引只复制变化的位图.
+ *
+ * 视频ID由视频路径(媒体库根目录+相对路径)的哈希得到, 与扫描顺序无关, 重新扫描后同一个视频的ID不变.
+ * 全文索引以视频ID标识视频, 不属于快照, 与快照在同一个写入锁内更新.
+ */
+class Library
+{
+public:
+
+    Library();
+    ~Library();
+
+    /**
+     * @brief 获取当前的快照
+     *
+     * @param videoType 视频类型
+     * @return LibrarySnapshotPtr 快照, 在持有期间保持不变
+     */
+    LibrarySnapshotPtr Snapshot(VideoType videoType) const;
+
+    /**
+     * @brief 开始扫描, 记录扫描期间通过Update()更新的视频, 发布扫描结果时保留这些更新
+     *
+     * @param videoType 视频类型
+     */
+    void BeginScan(VideoType videoType);
+
+    /**
+     * @brief 发布扫描的结果, 替换该类型的所有视频
+     *
+     * @param videoType 视频类型
+     * @param videoInfos 扫描得到的视频信息
+     */
+    void PublishScan(VideoType videoType, std::vector<VideoInfo>&& videoInfos);
+
+    /**
+     * @brief 更新单个视频的信息
+     *
+     * @param videoType 视频类型
+     * @param id 视频的ID
+     * @param fullInfo 新的视频信息, 快照中只保存其简要信息, 完整的详情按需从NFO解析
+     * @return true 更新成功
+     * @return false 该ID对应的视频已因重新扫描而被删除
+     */
+    bool Update(VideoType videoType, VideoId id, const VideoInfo& fullInfo);
+
+    /**
+     * @brief 由视频路径计算视频ID(FNV-1a), 取低53位使其可以被JavaScript的数值精确表示
+     *
+     * @param videoPath 视频路径
+     * @return VideoId 视频ID
+     */
+    static VideoId MakeVideoId(const std::string& videoPath);
+
+    /**
+     * @brief 全文搜索
+     *
+     * @param videoType 视频类型
+     * @param query 查询字符串
+     * @param limit 最多返回的结果数
+     * @param hits 输出按相关度降序排列的结果, 结果中的视频可能已不在调用者持有的快照中
+     * @return std::size_t 命中的视频总数
+     */
+    std::size_t Search(VideoType videoType, const std::string& query, std::size_t limit,
+                       std::vector<SearchHit>& hits) const;
+
+    /**
+     * @brief 获取当前快照与客户端已同步版本之间变化的视频
+     *
+     * @param videoType 视频类型
+     * @param since 客户端已同步到的快照版本号
+     * @param snapshot 输出当前快照, 变化的视频以其中的状态为准, 不在快照中的已被删除
+     * @param ids 输出变化的视频ID
+     * @return true 成功
+     * @return false since已超出变更日志保留的范围, 需要全量同步
+     */
+    bool Changes(VideoType videoType, uint64_t since, LibrarySnapshotPtr& snapshot, std::vector<VideoId>& ids) const;
+
+    /**
+     * @brief 统计当前快照中视频信息的内存占用
+     *
+     * @param videoType 视频类型
+     * @return LibraryMemoryStats 内存占用
+     */
+    LibraryMemoryStats MemoryStats(VideoType videoType) const;
+
+    /**
+     * @brief 估算单个视频信息占用的字节数(对象本身及其申请的堆内存)
+     *
+     * @param videoInfo 视频信息
+     * @return std::size_t 字节数
+     */
+    static std::size_t EstimateBytes(const VideoInfo& videoInfo);
+
+private:
+
+    static std::shared_ptr<const VideoIdIndex> BuildIdIndex(const std::vector<VideoInfoPtr>& videoInfos);
+
+    /**
+     * @brief 比较两次扫描之间视频在列表中可见的状态(简要信息与元数据是否完整)是否相同
+     *
+     * @param lhs 视频信息
+     * @param rhs 视频信息
+     * @return true 相同
+     * @return false 不同, 需要记入变更日志
+     */
+    static bool IsSameEntry(const VideoInfo& lhs, const VideoInfo& rhs);
+
+private:
+
+    std::map<VideoType, LibrarySnapshotPtr>                  m_snapshots;     // 各个类型的当前快照, 只通过原子操作读写
+    std::map<VideoType, bool>                                m_isScanning;    // 各个类型是否正在扫描
+    std::map<VideoType, std::map<std::string, VideoInfoPtr>> m_scanUpdates;   // 扫描期间更新的视频, 路径 -> 视频信息
+    std::map<VideoType, std::unique_ptr<SearchIndex>>        m_searchIndexes; // 各个类型的全文索引
+    std::map<VideoType, std::unique_ptr<ChangeLog>>          m_changeLogs;    // 各个类型的变更日志
+    std::mutex                                               m_writeLock;     // 写入者之间的互斥锁, 读取者不需要
+};
@@ -0,0 +1,198 @@
+#include "LibraryQuery.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <map>
+
+static std::string ToLower(const std::string& str)
+{
+    std::string lower(str);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char ch) { return std::tolower(ch); });
+    return lower;
+}
+
+static int HexValue(char ch)
+{
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    }
+    if (ch >= 'a' && ch <= 'f') {
+        return ch - 'a' + 10;
+    }
+    return -1;
+}
+
+bool LibraryQuery::ParseSortField(const std::string& str, ListSortField& sortField)
+{
+    static const std::map<std::string, ListSortField> STR_TO_SORT_FIELD = {
+        {"path", SORT_BY_PATH},
+        {"id", SORT_BY_ID},
+        {"title", SORT_BY_TITLE},
+        {"premiered", SORT_BY_PREMIERED},
+        {"rating", SORT_BY_RATING},
+        {"added", SORT_BY_ADDED},
+    };
+
+    auto iter = STR_TO_SORT_FIELD.find(ToLower(str));
+    if (iter == STR_TO_SORT_FIELD.end()) {
+        return false;
+    }
+    sortField = iter->second;
+    return true;
+}
+
+Bitmap LibraryQuery::Filter(const FacetIndex& facetIndex, const ListQuery& query)
+{
+    Bitmap candidates = facetIndex.All();
+    if (query.status != LIST_ALL) {
+        const std::string& status = query.status == LIST_COMPLETE ? FACET_COMPLETE : FACET_INCOMPLETE;
+        candidates                = Bitmap::And(candidates, facetIndex.Get(FACET_STATUS, status));
+    }
+    if (query.hasArtwork >= 0) {
+        const Bitmap& hasPoster =
+            facetIndex.Get(FACET_POSTER_STATUS, FacetIndex::MetaFileStatusToStr(FILE_FORMAT_MATCH));
+        candidates = query.hasArtwork == 1 ? Bitmap::And(candidates, hasPoster) : Bitmap::AndNot(candidates, hasPoster);
+    }
+    if (!query.hdrType.empty()) {
+        candidates = Bitmap::And(candidates, facetIndex.Get(FACET_HDR, ToLower(query.hdrType)));
+    }
+    if (!query.genre.empty()) {
+        candidates = Bitmap::And(candidates, facetIndex.Get(FACET_GENRE, query.genre));
+    }
+    if (!query.country.empty()) {
+        candidates = Bitmap::And(candidates, facetIndex.Get(FACET_COUNTRY, query.country));
+    }
+    if (!query.studio.empty()) {
+        candidates = Bitmap::And(candidates, facetIndex.Get(FACET_STUDIO, query.studio));
+    }
+    return candidates;
+}
+
+std::string LibraryQuery::SortKey(const VideoInfo& videoInfo, VideoId id, ListSortField sortField)
+{
+    // 数值类型格式化为定长的字符串, 使字符串的比较结果与数值的比较结果一致
+    char       buf[32] = {0};
+    const bool hasNfo  = videoInfo.nfoStatus == FILE_FORMAT_MATCH;
+    switch (sortField) {
+    case SORT_BY_TITLE: {
+        if (hasNfo && !videoInfo.videoDetail.title.empty()) {
+            return ToLower(videoInfo.videoDetail.title);
+        }
+        auto slashPos = videoInfo.videoPath.find_last_of("/\\");
+        return ToLower(slashPos == std::string::npos ? videoInfo.videoPath : videoInfo.videoPath.substr(slashPos + 1));
+    }
+    case SORT_BY_PREMIERED:
+        return hasNfo ? videoInfo.videoDetail.premiered : std::string();
+    case SORT_BY_RATING:
+        snprintf(buf, sizeof(buf), "%012.3f", hasNfo ? std::max(videoInfo.videoDetail.ratings.rating, 0.0) : 0.0);
+        return buf;
+    case SORT_BY_ADDED:
+        snprintf(buf, sizeof(buf), "%020lld", static_cast<long long>(std::max<std::time_t>(videoInfo.addedTime, 0)));
+        return buf;
+    case SORT_BY_ID:
+        snprintf(buf, sizeof(buf), "%020llu", static_cast<unsigned long long>(id));
+        return buf;
+    case SORT_BY_PATH:
+    default:
+        // 排序键为空, 只按路径排序
+        return std::string();
+    }
+}
+
+bool LibraryQuery::Less(const std::string& lhsKey, const std::string& lhsPath, const std::string& rhsKey,
+                        const std::string& rhsPath, bool descending)
+{
+    if (lhsKey != rhsKey) {
+        return descending ? rhsKey < lhsKey : lhsKey < rhsKey;
+    }
+    return descending ? rhsPath < lhsPath : lhsPath < rhsPath;
+}
+
+std::string LibraryQuery::EncodeCursor(const ListQuery& query, const Entry& entry)
+{
+    // 游标的内容: 排序字段, 排序方向, 排序键, 路径; 以十六进制编码以便直接放在查询参数中
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+
+    std::string plain = std::to_string(static_cast<int>(query.sortField)) + (query.descending ? "d" : "a") + '\n' +
+                        entry.key + '\n' + *entry.path;
+    std::string cursor;
+    cursor.reserve(plain.size() * 2);
+    for (unsigned char ch : plain) {
+        cursor.push_back(HEX_DIGITS[ch >> 4]);
+        cursor.push_back(HEX_DIGITS[ch & 0x0f]);
+    }
+    return cursor;
+}
+
+bool LibraryQuery::DecodeCursor(const ListQuery& query, std::string& key, std::string& path)
+{
+    if (query.cursor.size() % 2 != 0) {
+        return false;
+    }
+
+    std::string plain;
+    plain.reserve(query.cursor.size() / 2);
+    for (std::size_t i = 0; i < query.cursor.size(); i += 2) {
+        int high = HexValue(query.cursor[i]);
+        int low  = HexValue(query.cursor[i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        plain.push_back(static_cast<char>(high << 4 | low));
+    }
+
+    auto firstPos  = plain.find('\n');
+    auto secondPos = firstPos == std::string::npos ? std::string::npos : plain.find('\n', firstPos + 1);
+    if (secondPos == std::string::npos) {
+        return false;
+    }
+
+    // 游标只能用于生成它的排序方式
+    const std::string order = std::to_string(static_cast<int>(query.sortField)) + (query.descending ? "d" : "a");
+    if (plain.compare(0, firstPos, order) != 0) {
+        return false;
+    }
+    key  = plain.substr(firstPos + 1, secondPos - firstPos - 1);
+    path = plain.substr(secondPos + 1);
+    return true;
+}
+
+bool LibraryQuery::Run(const LibrarySnapshot& snapshot, const ListQuery& query, ListPage& page)
+{
+    std::string cursorKey;
+    std::string cursorPath;
+    if (!query.cursor.empty() && !DecodeCursor(query, cursorKey, cursorPath)) {
+        return false;
+    }
+
+    // 过滤, 并跳过游标及其之前的条目
+    const Bitmap       candidates = Filter(*snapshot.facetIndex, query);
+    std::vector<Entry> entries;
+    page.total = candidates.Count();
+    entries.reserve(page.total);
+    candidates.ForEach([&](uint32_t index) {
+        const VideoInfo& videoInfo = *snapshot.videoInfos[index];
+        Entry entry{SortKey(videoInfo, snapshot.IdAt(index), query.sortField), &videoInfo.videoPath, index};
+        if (!query.cursor.empty() && !Less(cursorKey, cursorPath, entry.key, *entry.path, query.descending)) {
+            return;
+        }
+        entries.push_back(std::move(entry));
+    });
+
+    // 只对当前页部分排序
+    const bool  descending = query.descending;
+    std::size_t pageSize   = query.limit == 0 ? entries.size() : std::min(query.limit, entries.size());
+    auto        lessFunc   = [descending](const Entry& lhs, const Entry& rhs) {
+        return Less(lhs.key, *lhs.path, rhs.key, *rhs.path, descending);
+    };
+    std::partial_sort(entries.begin(), entries.begin() + pageSize, entries.end(), lessFunc);
+
+    page.indexes.clear();
+    page.indexes.reserve(pageSize);
+    for (std::size_t i = 0; i < pageSize; i++) {
+        page.indexes.push_back(entries[i].index);
+    }
+    page.nextCursor = pageSize < entries.size() ? EncodeCursor(query, entries[pageSize - 1]) : std::string();
+    return true;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Bitmap.h"
+#include "FacetIndex.h"
+#include "Library.h"
+
+enum ListSortField {
+    SORT_BY_PATH,      // 按视频路径, 默认的排序方式
+    SORT_BY_ID,        // 按视频ID, ID由路径的哈希得到, 顺序与路径无关
+    SORT_BY_TITLE,     // 按标题, 没有NFO时按文件(目录)名
+    SORT_BY_PREMIERED, // 按首播日期
+    SORT_BY_RATING,    // 按评分
+    SORT_BY_ADDED,     // 按加入媒体库的时间
+};
+
+enum ListStatusFilter {
+    LIST_ALL,        // 所有视频
+    LIST_COMPLETE,   // 元数据完整的视频
+    LIST_INCOMPLETE, // 元数据不完整的视频
+};
+
+/**
+ * @brief 列表查询的条件
+ *
+ */
+struct ListQuery {
+    ListSortField    sortField  = SORT_BY_PATH; // 排序字段
+    bool             descending = false;        // 是否降序
+    ListStatusFilter status     = LIST_ALL;     // 元数据完整性过滤
+    std::string      hdrType;                   // HDR类型过滤, 不区分大小写, 为空时不过滤
+    std::string      genre;                     // 分类过滤, 为空时不过滤
+    std::string      country;                   // 国家过滤, 为空时不过滤
+    std::string      studio;                    // 制片厂过滤, 为空时不过滤
+    int              hasArtwork = -1;           // 海报过滤, -1: 不过滤, 0: 没有海报, 1: 有海报
+    std::size_t      limit      = 0;            // 单页的条目数, 0表示不分页
+    std::string      cursor;                    // 上一页返回的游标, 为空时从第一页开始
+};
+
+/**
+ * @brief 列表查询的结果
+ *
+ */
+struct ListPage {
+    std::vector<std::size_t> indexes;    // 当前页的视频在快照中的下标
+    std::size_t              total = 0;  // 满足过滤条件的视频总数
+    std::string              nextCursor; // 下一页的游标, 没有下一页时为空
+};
+
+/**
+ * @brief 媒体库快照上的分页查询
+ *
+ * 游标记录了当前页最后一个条目的排序键和路径, 下一页从严格位于其后的条目开始(keyset分页),
+ * 翻页期间发生扫描/刮削时不会重复或跳过未变化的条目. 过滤条件由快照的位图索引求交集得到,
+ * 只对过滤后的条目计算排序键, 且只部分排序出当前页, 调用者只需要序列化当前页的条目.
+ */
+class LibraryQuery
+{
+public:
+
+    /**
+     * @brief 解析排序字段
+     *
+     * @param str 排序字段的字符串(path, id, title, premiered, rating, added)
+     * @param sortField 输出排序字段
+     * @return true 解析成功
+     * @return false 不支持的排序字段
+     */
+    static bool ParseSortField(const std::string& str, ListSortField& sortField);
+
+    /**
+     * @brief 执行查询
+     *
+     * @param snapshot 媒体库快照
+     * @param query 查询条件
+     * @param page 输出查询结果
+     * @return true 查询成功
+     * @return false 游标无效或者与排序方式不匹配
+     */
+    static bool Run(const LibrarySnapshot& snapshot, const ListQuery& query, ListPage& page);
+
+    /**
+     * @brief 求满足查询中的过滤条件的视频, 忽略排序与分页
+     *
+     * @param facetIndex 快照的位图索引
+     * @param query 查询条件
+     * @return Bitmap 满足条件的视频在快照中的下标
+     */
+    static Bitmap Filter(const FacetIndex& facetIndex, const ListQuery& query);
+
+private:
+
+    /**
+     * @brief 待排序的条目
+     *
+     */
+    struct Entry {
+        std::string        key;   // 排序键
+        const std::string* path;  // 视频路径, 排序键相同时按路径排序
+        std::size_t        index; // 视频在快照中的下标
+    };
+
+    static std::string SortKey(const VideoInfo& videoInfo, VideoId id, ListSortField sortField);
+    static bool        Less(const std::string& lhsKey, const std::string& lhsPath, const std::string& rhsKey,
+                            const std::string& rhsPath, bool descending);
+
+    static std::string EncodeCursor(const ListQuery& query, const Entry& entry);
+    static bool        DecodeCursor(const ListQuery& query, std::string& key, std::string& path);
+};
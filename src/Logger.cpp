@@ -7,6 +7,10 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <spdlog/sinks/base_sink.h>
+
+#include "EventBus.h"
+
 std::vector<int> GCrashLogFds;
 
 const size_t INTERLOG_MESSAGE_RESERVED_LINES = 1000; // 内部日志保留的条数
@@ -20,12 +24,43 @@ const std::vector<std::string> CRASH_LOGS_PATHS_TEMPLATE = {
 
 std::vector<std::string> GOpenedCrashLogPaths; // 已打开的崩溃日志路径, 用于正常退出时的日志清理
 
+/**
+ * @brief 将日志推送到事件总线的接收器, 没有订阅者时不格式化
+ *
+ */
+class EventBusSink : public spdlog::sinks::base_sink<std::mutex>
+{
+protected:
+
+    void sink_it_(const spdlog::details::log_msg& msg) override
+    {
+        if (!EventBus::Instance().HasSubscribers()) {
+            return;
+        }
+        spdlog::memory_buf_t formatted;
+        formatter_->format(msg, formatted);
+        std::string line(formatted.data(), formatted.size());
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+            line.pop_back();
+        }
+        EventBus::Instance().Publish("log", line);
+    }
+
+    void flush_() override {}
+};
+
 Logger& Logger::Instance()
 {
     static Logger self;
     return self;
 }
 
+Logger::Logger()
+{
+    // 事件总线先于日志记录器构造完成, 因而晚于日志记录器析构, 退出过程中的日志仍可安全推送
+    EventBus::Instance();
+}
+
 bool Logger::Init(spdlog::level::level_enum level, bool isDaemon, const std::string& logFile, size_t maxSize, size_t maxCount)
 {
 
@@ -50,6 +85,11 @@ bool Logger::Init(spdlog::level::level_enum level, bool isDaemon, const std::str
         sinks.push_back(m_ringbufferSink);
     }
 
+    // 推送给/api/events的订阅者, 只推送info及以上等级的日志
+    m_eventSink = std::make_shared<EventBusSink>();
+    m_eventSink->set_level(spdlog::level::info);
+    sinks.push_back(m_eventSink);
+
     m_logger = std::make_shared<spdlog::logger>("logger", std::begin(sinks), std::end(sinks));
     m_logger->set_level(level);
     m_logger->set_pattern("%Y-%m-%d %H:%M:%S %^%L%$ %v [%s:%#]");
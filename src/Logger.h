@@ -90,12 +90,13 @@ private:
      * @brief 构造函数私有化(单例)
      * 
      */
-    Logger() {};
+    Logger();
 
     std::shared_ptr<spdlog::logger>                       m_logger;         // spdlog的日志记录器
     std::shared_ptr<spdlog::sinks::rotating_file_sink_mt> m_fileSink;       // 标准输出日志接收器
     std::shared_ptr<spdlog::sinks::stdout_color_sink_mt>  m_stdoutSink;     // 标准输出日志接收器
     std::shared_ptr<spdlog::sinks::ringbuffer_sink_mt>    m_ringbufferSink; // 环形队列日志接收器
+    spdlog::sink_ptr                                      m_eventSink;      // 推送到事件总线的日志接收器
 };
 
 /**
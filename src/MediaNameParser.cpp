@@ -0,0 +1,262 @@
+#include "MediaNameParser.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <regex>
+#include <set>
+#include <sstream>
+
+std::vector<std::string> MediaNameParser::SplitPath(const std::string& path)
+{
+    std::vector<std::string> parts;
+    std::string              part;
+    for (char ch : path) {
+        if (ch == '/' || ch == '\\') {
+            if (!part.empty()) {
+                parts.push_back(part);
+            }
+            part.clear();
+        } else {
+            part += ch;
+        }
+    }
+    if (!part.empty()) {
+        parts.push_back(part);
+    }
+    return parts;
+}
+
+std::string MediaNameParser::StripExtension(const std::string& name)
+{
+    auto pos = name.rfind('.');
+    // 扩展名只包含字母和数字且不超过4个字符
+    if (pos == std::string::npos || name.size() - pos - 1 > 4 || pos == 0) {
+        return name;
+    }
+    for (std::size_t i = pos + 1; i < name.size(); i++) {
+        if (!std::isalnum(static_cast<unsigned char>(name[i]))) {
+            return name;
+        }
+    }
+    return name.substr(0, pos);
+}
+
+bool MediaNameParser::IsYearToken(const std::string& token, int& year)
+{
+    static const std::regex yearPattern(R"(^[\(\[]?((19|20)\d{2})[\)\]]?$)");
+
+    std::smatch match;
+    if (!std::regex_match(token, match, yearPattern)) {
+        return false;
+    }
+    year = std::stoi(match[1]);
+    return true;
+}
+
+bool MediaNameParser::IsStopToken(const std::string& token)
+{
+    static const std::set<std::string> stopTokens = {
+        "4k",     "uhd",    "bluray", "blu-ray", "bdrip", "brrip",  "web-dl", "webdl",  "webrip", "web",
+        "hdtv",   "dvdrip", "remux",  "x264",    "x265",  "h264",   "h265",   "h.264",  "h.265",  "hevc",
+        "avc",    "hdr",    "hdr10",  "dv",      "dovi",  "aac",    "ac3",    "dts",    "atmos",  "truehd",
+        "10bit",  "proper", "repack", "extended", "unrated", "complete", "season", "multi", "internal",
+    };
+    static const std::regex stopPattern(R"(^(\d{3,4}[pi]|[sS]\d{1,2}([eE]\d{1,3})?|[eE][pP]?\d{1,3}|第.+[季集])$)");
+
+    std::string lower(token);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char ch) { return std::tolower(ch); });
+    return stopTokens.count(lower) != 0 || std::regex_match(token, stopPattern);
+}
+
+int MediaNameParser::ParseSeason(const std::string& name)
+{
+    static const std::regex seasonPattern(R"((?:^|[^a-zA-Z])(?:[sS]eason[ ._-]?|[sS])(\d{1,2})(?:[^\d]|$))");
+    static const std::regex cnSeasonPattern(R"(第(\d{1,2})季)");
+
+    std::smatch match;
+    if (std::regex_search(name, match, seasonPattern) || std::regex_search(name, match, cnSeasonPattern)) {
+        return std::stoi(match[1]);
+    }
+    return -1;
+}
+
+ParsedMediaName MediaNameParser::ParseName(const std::string& name)
+{
+    ParsedMediaName result;
+    result.season = ParseSeason(name);
+
+    // 移除方括号内的发布组/站点等信息, 将常见的分隔符替换为空格
+    std::string cleaned;
+    int         bracketDepth = 0;
+    for (std::size_t i = 0; i < name.size(); i++) {
+        if (name.compare(i, 3, "【") == 0) {
+            bracketDepth++;
+            i += 2;
+        } else if (name.compare(i, 3, "】") == 0) {
+            bracketDepth = std::max(0, bracketDepth - 1);
+            i += 2;
+            cleaned += ' ';
+        } else if (name[i] == '[') {
+            bracketDepth++;
+        } else if (name[i] == ']') {
+            bracketDepth = std::max(0, bracketDepth - 1);
+            cleaned += ' ';
+        } else if (bracketDepth == 0) {
+            cleaned += (name[i] == '.' || name[i] == '_') ? ' ' : name[i];
+        }
+    }
+
+    // 逐个单词检查, 遇到年份或者质量/编码标签时截断; 第一个单词即使形如年份也视为标题(如"1917", "2012")
+    std::istringstream       iss(cleaned);
+    std::vector<std::string> titleTokens;
+    std::string              token;
+    while (iss >> token) {
+        int year = 0;
+        if (!titleTokens.empty() && IsYearToken(token, year)) {
+            result.year = year;
+            break;
+        }
+        if (IsStopToken(token)) {
+            break;
+        }
+        titleTokens.push_back(token);
+    }
+
+    // 中英混合命名(如"流浪地球 The Wandering Earth")时, 拆分为中文标题和英文备选标题
+    std::string nativeTitle;
+    std::string latinTitle;
+    for (const auto& titleToken : titleTokens) {
+        bool         isAscii = std::all_of(titleToken.begin(), titleToken.end(), [](char ch) {
+            return static_cast<unsigned char>(ch) < 0x80;
+        });
+        std::string& target  = isAscii ? latinTitle : nativeTitle;
+        target += (target.empty() ? "" : " ") + titleToken;
+    }
+
+    // 去掉首尾的连接符
+    auto Trim = [](std::string str) {
+        const std::string trimChars = " -+~&,";
+        auto              begin     = str.find_first_not_of(trimChars);
+        auto              end       = str.find_last_not_of(trimChars);
+        return begin == std::string::npos ? std::string() : str.substr(begin, end - begin + 1);
+    };
+    nativeTitle = Trim(nativeTitle);
+    latinTitle  = Trim(latinTitle);
+
+    if (nativeTitle.empty()) {
+        result.title = latinTitle;
+    } else {
+        result.title    = nativeTitle;
+        result.altTitle = latinTitle;
+    }
+    return result;
+}
+
+ParsedMediaName MediaNameParser::ParseMovie(const std::string& videoPath)
+{
+    std::vector<std::string> parts = SplitPath(videoPath);
+    if (parts.empty()) {
+        return ParsedMediaName();
+    }
+
+    ParsedMediaName result = ParseName(StripExtension(parts.back()));
+    if (result.year == 0 && parts.size() >= 2) {
+        ParsedMediaName folderResult = ParseName(parts[parts.size() - 2]);
+        if (folderResult.year != 0 && !folderResult.title.empty()) {
+            result = folderResult;
+        }
+    }
+    result.season = -1;
+    return result;
+}
+
+ParsedMediaName MediaNameParser::ParseTV(const std::string& tvPath, const std::string& firstEpisodePath)
+{
+    std::vector<std::string> parts = SplitPath(tvPath);
+    if (parts.empty()) {
+        return ParsedMediaName();
+    }
+
+    ParsedMediaName result = ParseName(parts.back());
+    if (result.title.empty() && parts.size() >= 2) {
+        // 目录名仅为季名称, 标题来自上一级目录
+        int season = result.season;
+        result     = ParseName(parts[parts.size() - 2]);
+        if (season != -1) {
+            result.season = season;
+        }
+    }
+
+    if (result.season == -1 && !firstEpisodePath.empty()) {
+        std::vector<std::string> episodeParts = SplitPath(firstEpisodePath);
+        if (!episodeParts.empty()) {
+            result.season = ParseSeason(episodeParts.back());
+        }
+    }
+    return result;
+}
+
+std::vector<uint32_t> MediaNameParser::NormalizeTitle(const std::string& title)
+{
+    std::vector<uint32_t> codePoints;
+    for (std::size_t i = 0; i < title.size();) {
+        unsigned char ch = static_cast<unsigned char>(title[i]);
+        // 解码UTF-8, 非法的字节按单字节处理
+        uint32_t    codePoint = ch;
+        std::size_t length    = 1;
+        if (ch >= 0xF0 && i + 3 < title.size()) {
+            codePoint = ((ch & 0x07u) << 18) | ((title[i + 1] & 0x3Fu) << 12) | ((title[i + 2] & 0x3Fu) << 6) |
+                        (title[i + 3] & 0x3Fu);
+            length    = 4;
+        } else if (ch >= 0xE0 && i + 2 < title.size()) {
+            codePoint = ((ch & 0x0Fu) << 12) | ((title[i + 1] & 0x3Fu) << 6) | (title[i + 2] & 0x3Fu);
+            length    = 3;
+        } else if (ch >= 0xC0 && i + 1 < title.size()) {
+            codePoint = ((ch & 0x1Fu) << 6) | (title[i + 1] & 0x3Fu);
+            length    = 2;
+        }
+        i += length;
+
+        if (codePoint < 0x80) {
+            if (std::isalnum(static_cast<int>(codePoint))) {
+                codePoints.push_back(static_cast<uint32_t>(std::tolower(static_cast<int>(codePoint))));
+            }
+        } else if (!(codePoint >= 0x3000 && codePoint <= 0x303F) && !(codePoint >= 0xFF00 && codePoint <= 0xFF0F) &&
+                   !(codePoint >= 0xFF1A && codePoint <= 0xFF20) && !(codePoint >= 0x2000 && codePoint <= 0x206F)) {
+            // 跳过中文标点(如"：", "·", "《》")
+            codePoints.push_back(codePoint);
+        }
+    }
+    return codePoints;
+}
+
+double MediaNameParser::TitleSimilarity(const std::string& a, const std::string& b)
+{
+    std::vector<uint32_t> codePointsA = NormalizeTitle(a);
+    std::vector<uint32_t> codePointsB = NormalizeTitle(b);
+    if (codePointsA.empty() || codePointsB.empty()) {
+        return 0.0;
+    }
+    if (codePointsA == codePointsB) {
+        return 1.0;
+    }
+    if (codePointsA.size() < 2 || codePointsB.size() < 2) {
+        return 0.0;
+    }
+
+    auto Bigrams = [](const std::vector<uint32_t>& codePoints) {
+        std::vector<uint64_t> bigrams;
+        for (std::size_t i = 0; i + 1 < codePoints.size(); i++) {
+            bigrams.push_back((static_cast<uint64_t>(codePoints[i]) << 32) | codePoints[i + 1]);
+        }
+        std::sort(bigrams.begin(), bigrams.end());
+        return bigrams;
+    };
+    std::vector<uint64_t> bigramsA = Bigrams(codePointsA);
+    std::vector<uint64_t> bigramsB = Bigrams(codePointsB);
+
+    std::vector<uint64_t> common;
+    std::set_intersection(bigramsA.begin(), bigramsA.end(), bigramsB.begin(), bigramsB.end(), std::back_inserter(common));
+    return 2.0 * common.size() / (bigramsA.size() + bigramsB.size());
+}
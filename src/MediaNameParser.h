@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 从文件/目录名称中解析出的媒体信息
+ *
+ */
+struct ParsedMediaName {
+    std::string title;       // 标题(中英混合命名时为中文部分)
+    std::string altTitle;    // 备选标题(中英混合命名时为英文部分)
+    int         year   = 0;  // 年份, 0表示未知
+    int         season = -1; // 季编号, -1表示未知
+};
+
+/**
+ * @brief 媒体文件/目录名称的解析器
+ *
+ * 按照常见的发布命名规则(如"The.Matrix.1999.1080p.BluRay.x264-GROUP.mkv", "流浪地球 (2019)", "Friends S02")
+ * 提取标题, 年份和季编号, 年份及其后的质量/编码等标签均被截断.
+ */
+class MediaNameParser
+{
+public:
+
+    /**
+     * @brief 解析电影的名称, 文件名中没有年份时尝试所在目录的名称
+     *
+     * @param videoPath 电影文件的路径
+     * @return ParsedMediaName 解析结果
+     */
+    static ParsedMediaName ParseMovie(const std::string& videoPath);
+
+    /**
+     * @brief 解析电视剧的名称, 目录名仅为季名称(如"Season 2")时使用上一级目录的名称作为标题
+     *
+     * @param tvPath 电视剧的目录
+     * @param firstEpisodePath 第一集的路径, 用于补充季编号
+     * @return ParsedMediaName 解析结果
+     */
+    static ParsedMediaName ParseTV(const std::string& tvPath, const std::string& firstEpisodePath);
+
+    /**
+     * @brief 解析单个名称
+     *
+     * @param name 文件或目录的名称(不含路径)
+     * @return ParsedMediaName 解析结果
+     */
+    static ParsedMediaName ParseName(const std::string& name);
+
+    /**
+     * @brief 计算两个标题的相似度(忽略大小写, 空白和标点, 基于字符二元组的Dice系数, 适用于中英文)
+     *
+     * @param a 标题a
+     * @param b 标题b
+     * @return double 相似度, 取值范围[0, 1]
+     */
+    static double TitleSimilarity(const std::string& a, const std::string& b);
+
+private:
+
+    static std::vector<uint32_t> NormalizeTitle(const std::string& title);
+
+    static std::vector<std::string> SplitPath(const std::string& path);
+    static std::string              StripExtension(const std::string& name);
+    static bool                     IsYearToken(const std::string& token, int& year);
+    static bool                     IsStopToken(const std::string& token);
+    static int                      ParseSeason(const std::string& name);
+};
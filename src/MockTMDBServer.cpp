@@ -0,0 +1,243 @@
+/**
+ * @file MockTMDBServer.cpp
+ * @brief 模拟TMDB服务器, 回放录制的响应, 用于离线测试刮削的吞吐量与限流/重试行为
+ *
+ * 使用方法: 将刮削服务配置文件中API.URLs的地址指向本服务器(如"http://127.0.0.1:54260/3/movie/"),
+ * 响应通过刮削服务配置API.RecordFixtures录制.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include <Poco/FileStream.h>
+#include <Poco/JSON/Object.h>
+#include <Poco/JSON/Parser.h>
+#include <Poco/Net/HTTPRequestHandler.h>
+#include <Poco/Net/HTTPRequestHandlerFactory.h>
+#include <Poco/Net/HTTPServer.h>
+#include <Poco/Net/HTTPServerParams.h>
+#include <Poco/Net/HTTPServerRequest.h>
+#include <Poco/Net/HTTPServerResponse.h>
+#include <Poco/Net/ServerSocket.h>
+#include <Poco/Path.h>
+#include <Poco/URI.h>
+
+#include "FixtureStore.h"
+#include "Logger.h"
+#include "RateLimiter.h"
+
+const std::string MOCK_CONF_FILE = "config/MockTMDBServer.json"; // 默认的配置文件
+
+/**
+ * @brief 模拟服务器的配置
+ *
+ */
+struct MockConf {
+    uint16_t    port                = 54260; // 监听的端口号
+    std::string fixtureDir          = "fixtures"; // 录制响应的目录
+    int         latencyMinMs        = 0;     // 响应的最小延迟, 单位: 毫秒
+    int         latencyMaxMs        = 0;     // 响应的最大延迟, 单位: 毫秒
+    double      errorRate           = 0.0;   // 返回500的概率
+    double      tooManyRequestsRate = 0.0;   // 随机返回429的概率
+    double      rateLimit           = 0.0;   // 每秒允许的请求数, 超过时返回429, 0表示不限制
+    int         retryAfterSec       = 1;     // 429响应中Retry-After的值, 单位: 秒
+};
+
+/**
+ * @brief 各个响应码的计数
+ *
+ */
+struct MockStats {
+    std::map<int, uint64_t> statusCounts; // 响应码 -> 次数
+    std::mutex              lock;         // 计数的锁
+};
+
+std::atomic<bool> GQuit(false); // 是否收到退出信号
+
+/**
+ * @brief 回放录制响应的请求处理类
+ *
+ */
+class FixtureRequestHandler : public Poco::Net::HTTPRequestHandler
+{
+public:
+
+    FixtureRequestHandler(const MockConf& conf, const FixtureStore& store, RateLimiter& limiter, MockStats& stats)
+        : m_conf(conf), m_store(store), m_limiter(limiter), m_stats(stats)
+    {
+    }
+
+    void handleRequest(Poco::Net::HTTPServerRequest& request, Poco::Net::HTTPServerResponse& response)
+    {
+        Poco::URI uri(request.getURI());
+        if (uri.getPath() == "/__stats") {
+            SendStats(response);
+            return;
+        }
+
+        static std::mt19937 randomEngine(std::random_device{}());
+        static std::mutex   randomLock;
+
+        int    latencyMs = 0;
+        double dice      = 0.0;
+        {
+            std::lock_guard<std::mutex> locker(randomLock);
+            latencyMs = std::uniform_int_distribution<int>(m_conf.latencyMinMs,
+                                                           std::max(m_conf.latencyMinMs, m_conf.latencyMaxMs))(randomEngine);
+            dice      = std::uniform_real_distribution<double>(0.0, 1.0)(randomEngine);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(latencyMs));
+
+        // 依次模拟限流, 随机限流, 服务端错误, 最后回放录制的响应
+        const std::string key = FixtureStore::KeyOf(uri);
+        std::string       body;
+        if (m_conf.rateLimit > 0 && !m_limiter.Acquire(std::chrono::steady_clock::now())) {
+            SendError(response, Poco::Net::HTTPResponse::HTTP_TOO_MANY_REQUESTS, 25, "Request count over limit.");
+        } else if (dice < m_conf.tooManyRequestsRate) {
+            SendError(response, Poco::Net::HTTPResponse::HTTP_TOO_MANY_REQUESTS, 25, "Request count over limit.");
+        } else if (dice < m_conf.tooManyRequestsRate + m_conf.errorRate) {
+            SendError(response, Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR, 11, "Internal error.");
+        } else if (!m_store.Load(key, body)) {
+            LOG_WARN("Fixture not found: {}", key);
+            SendError(response, Poco::Net::HTTPResponse::HTTP_NOT_FOUND, 34, "The resource you requested could not be found.");
+        } else {
+            CountStatus(Poco::Net::HTTPResponse::HTTP_OK);
+            const std::string extension = Poco::Path(uri.getPath()).getExtension();
+            response.setContentType(extension == "png"                      ? "image/png"
+                                    : (extension == "jpg" || extension == "jpeg") ? "image/jpeg"
+                                                                                  : "application/json");
+            response.sendBuffer(body.data(), body.size());
+        }
+        LOG_DEBUG("{} {} -> {} ({}ms)", request.getMethod(), key, static_cast<int>(response.getStatus()), latencyMs);
+    }
+
+private:
+
+    void CountStatus(int status)
+    {
+        std::lock_guard<std::mutex> locker(m_stats.lock);
+        m_stats.statusCounts[status]++;
+    }
+
+    void SendError(Poco::Net::HTTPServerResponse& response, Poco::Net::HTTPResponse::HTTPStatus status, int code,
+                   const std::string& msg)
+    {
+        CountStatus(status);
+        response.setStatus(status);
+        if (status == Poco::Net::HTTPResponse::HTTP_TOO_MANY_REQUESTS) {
+            response.set("Retry-After", std::to_string(m_conf.retryAfterSec));
+        }
+        response.setContentType("application/json");
+
+        // 与TMDB的错误响应格式保持一致
+        Poco::JSON::Object jsonObj;
+        jsonObj.set("success", false);
+        jsonObj.set("status_code", code);
+        jsonObj.set("status_message", msg);
+        jsonObj.stringify(response.send());
+    }
+
+    void SendStats(Poco::Net::HTTPServerResponse& response)
+    {
+        Poco::JSON::Object jsonObj;
+        {
+            std::lock_guard<std::mutex> locker(m_stats.lock);
+            for (const auto& pair : m_stats.statusCounts) {
+                jsonObj.set(std::to_string(pair.first), pair.second);
+            }
+        }
+        response.setContentType("application/json");
+        jsonObj.stringify(response.send());
+    }
+
+private:
+
+    const MockConf&     m_conf;    // 模拟服务器的配置
+    const FixtureStore& m_store;   // 录制响应的仓库
+    RateLimiter&        m_limiter; // 模拟TMDB的限流
+    MockStats&          m_stats;   // 响应码的计数
+};
+
+/**
+ * @brief 请求处理类的工厂
+ *
+ */
+class FixtureRequestHandlerFactory : public Poco::Net::HTTPRequestHandlerFactory
+{
+public:
+
+    FixtureRequestHandlerFactory(const MockConf& conf)
+        : m_conf(conf), m_store(conf.fixtureDir), m_limiter(conf.rateLimit, conf.rateLimit)
+    {
+    }
+
+    Poco::Net::HTTPRequestHandler* createRequestHandler(const Poco::Net::HTTPServerRequest&)
+    {
+        return new FixtureRequestHandler(m_conf, m_store, m_limiter, m_stats);
+    }
+
+private:
+
+    MockConf     m_conf;    // 模拟服务器的配置
+    FixtureStore m_store;   // 录制响应的仓库
+    RateLimiter  m_limiter; // 模拟TMDB的限流
+    MockStats    m_stats;   // 响应码的计数
+};
+
+bool ParseMockConf(const std::string& confFile, MockConf& conf)
+{
+    try {
+        Poco::FileInputStream   fis(confFile);
+        Poco::JSON::Parser      jsonParser;
+        Poco::JSON::Object::Ptr jsonPtr = jsonParser.parse(fis).extract<Poco::JSON::Object::Ptr>();
+
+        conf.port                = jsonPtr->optValue<uint16_t>("ListenPort", conf.port);
+        conf.fixtureDir          = jsonPtr->optValue<std::string>("FixtureDir", conf.fixtureDir);
+        conf.latencyMinMs        = jsonPtr->optValue<int>("LatencyMinMs", conf.latencyMinMs);
+        conf.latencyMaxMs        = jsonPtr->optValue<int>("LatencyMaxMs", conf.latencyMaxMs);
+        conf.errorRate           = jsonPtr->optValue<double>("ErrorRate", conf.errorRate);
+        conf.tooManyRequestsRate = jsonPtr->optValue<double>("TooManyRequestsRate", conf.tooManyRequestsRate);
+        conf.rateLimit           = jsonPtr->optValue<double>("RateLimit", conf.rateLimit);
+        conf.retryAfterSec       = jsonPtr->optValue<int>("RetryAfterSec", conf.retryAfterSec);
+    } catch (Poco::Exception& e) {
+        LOG_ERROR("Parse conf file {} failed: {}", confFile, e.displayText());
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if (!Logger::Instance().Init(spdlog::level::info)) {
+        return 1;
+    }
+
+    MockConf conf;
+    if (!ParseMockConf(argc > 1 ? argv[1] : MOCK_CONF_FILE, conf)) {
+        return 1;
+    }
+
+    Poco::Net::ServerSocket      sock(Poco::Net::SocketAddress("[::]:" + std::to_string(conf.port)));
+    Poco::Net::HTTPServerParams* pParams = new Poco::Net::HTTPServerParams;
+    pParams->setMaxQueued(256);
+    pParams->setMaxThreads(64);
+    Poco::Net::HTTPServer server(new FixtureRequestHandlerFactory(conf), sock, pParams);
+    server.start();
+    LOG_INFO("Mock TMDB server listening on port {}, fixtures: {}", server.port(), conf.fixtureDir);
+
+    std::signal(SIGINT, [](int) { GQuit.store(true); });
+    std::signal(SIGTERM, [](int) { GQuit.store(true); });
+    while (!GQuit.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    LOG_INFO("Stopping mock TMDB server...");
+    server.stopAll(true);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "NegativeCache.h"
+
+const std::size_t NegativeCache::MAX_ENTRIES;
+
+void NegativeCache::Add(const std::string& key, int ttlSec)
+{
+    if (ttlSec <= 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> locker(m_lock);
+    auto                        now = std::chrono::steady_clock::now();
+    if (m_entries.size() >= MAX_ENTRIES) {
+        PurgeExpired(now);
+    }
+    if (m_entries.size() >= MAX_ENTRIES) {
+        // 仍然超过上限时丢弃最早过期的条目
+        auto oldest = m_entries.begin();
+        for (auto iter = m_entries.begin(); iter != m_entries.end(); ++iter) {
+            if (iter->second < oldest->second) {
+                oldest = iter;
+            }
+        }
+        m_entries.erase(oldest);
+    }
+    m_entries[key] = now + std::chrono::seconds(ttlSec);
+}
+
+bool NegativeCache::Contains(const std::string& key)
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    auto                        iter = m_entries.find(key);
+    if (iter == m_entries.end()) {
+        return false;
+    }
+    if (iter->second <= std::chrono::steady_clock::now()) {
+        m_entries.erase(iter);
+        return false;
+    }
+    return true;
+}
+
+void NegativeCache::Remove(const std::string& key)
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    m_entries.erase(key);
+}
+
+std::size_t NegativeCache::Size()
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    return m_entries.size();
+}
+
+void NegativeCache::PurgeExpired(const std::chrono::steady_clock::time_point& now)
+{
+    for (auto iter = m_entries.begin(); iter != m_entries.end();) {
+        if (iter->second <= now) {
+            iter = m_entries.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
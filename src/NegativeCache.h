@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief 失败结果的缓存
+ *
+ * 记录确定会失败的请求(如TMDB返回404的ID), 在过期之前直接跳过, 避免批量任务反复请求.
+ */
+class NegativeCache
+{
+public:
+
+    static const std::size_t MAX_ENTRIES = 10000; // 缓存条目的上限
+
+    /**
+     * @brief 添加失败记录
+     *
+     * @param key 请求的key
+     * @param ttlSec 有效时间, 单位: 秒, 不大于0时不记录
+     */
+    void Add(const std::string& key, int ttlSec);
+
+    /**
+     * @brief 判断请求是否在有效期内失败过
+     *
+     * @param key 请求的key
+     * @return true 失败过, 应直接跳过
+     * @return false 未记录或者已过期
+     */
+    bool Contains(const std::string& key);
+
+    /**
+     * @brief 移除失败记录(如用户手动修正了ID)
+     *
+     * @param key 请求的key
+     */
+    void Remove(const std::string& key);
+
+    /**
+     * @brief 获取缓存的条目数(含未清理的过期条目)
+     *
+     * @return std::size_t 条目数
+     */
+    std::size_t Size();
+
+private:
+
+    void PurgeExpired(const std::chrono::steady_clock::time_point& now);
+
+private:
+
+    std::map<std::string, std::chrono::steady_clock::time_point> m_entries; // 请求的key -> 过期时间
+    std::mutex                                                   m_lock;    // 缓存的锁
+};
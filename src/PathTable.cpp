@@ -0,0 +1,102 @@
+#include "PathTable.h"
+
+const PathTable::NodeId PathTable::ROOT;
+
+static const char* PATH_SEPARATORS = "/\\";
+
+PathTable& PathTable::Instance()
+{
+    static PathTable inst;
+    return inst;
+}
+
+PathTable::PathTable()
+{
+    m_nodes.push_back(Node{ROOT, std::string()});
+}
+
+std::string PathTable::ChildKey(NodeId parent, const std::string& name)
+{
+    std::string key(reinterpret_cast<const char*>(&parent), sizeof(parent));
+    key += name;
+    return key;
+}
+
+PathTable::NodeId PathTable::Intern(const std::string& dir)
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    NodeId                      node  = ROOT;
+    std::size_t                 begin = 0;
+    while (begin < dir.size()) {
+        std::size_t end = dir.find_first_of(PATH_SEPARATORS, begin);
+        end             = end == std::string::npos ? dir.size() : end + 1;
+
+        // 目录名保留末尾的分隔符, 还原时直接拼接, 不改变原路径中的分隔符
+        std::string name = dir.substr(begin, end - begin);
+        auto        iter = m_children.find(ChildKey(node, name));
+        if (iter != m_children.end()) {
+            node = iter->second;
+        } else {
+            const NodeId child = static_cast<NodeId>(m_nodes.size());
+            m_children.emplace(ChildKey(node, name), child);
+            m_nodes.push_back(Node{node, std::move(name)});
+            node = child;
+        }
+        begin = end;
+    }
+    return node;
+}
+
+std::string PathTable::Resolve(NodeId node) const
+{
+    std::vector<const std::string*> names;
+    std::size_t                     length = 0;
+
+    std::lock_guard<std::mutex> locker(m_lock);
+    while (node != ROOT) {
+        const Node& current = m_nodes[node];
+        names.push_back(&current.name);
+        length += current.name.size();
+        node = current.parent;
+    }
+
+    std::string dir;
+    dir.reserve(length);
+    for (auto iter = names.rbegin(); iter != names.rend(); ++iter) {
+        dir += **iter;
+    }
+    return dir;
+}
+
+void PathTable::Stats(std::size_t& count, std::size_t& bytes) const
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    count = m_nodes.size();
+    bytes = m_nodes.capacity() * sizeof(Node) + m_children.bucket_count() * sizeof(void*);
+    for (const auto& node : m_nodes) {
+        // 节点的目录名, 以及查找表中的节点: 键, 值, 缓存的哈希值, 后继指针
+        bytes += node.name.capacity() > 15 ? node.name.capacity() + 1 : 0;
+        const std::size_t keyLength = sizeof(NodeId) + node.name.size();
+        bytes += sizeof(std::string) + sizeof(NodeId) + sizeof(std::size_t) + sizeof(void*);
+        bytes += keyLength > 15 ? keyLength + 1 : 0;
+    }
+}
+
+CompactPath::CompactPath() : m_dir(PathTable::ROOT) {}
+
+CompactPath::CompactPath(const std::string& path)
+{
+    const std::size_t slashPos = path.find_last_of(PATH_SEPARATORS);
+    if (slashPos == std::string::npos) {
+        m_dir  = PathTable::ROOT;
+        m_name = path;
+    } else {
+        m_dir  = PathTable::Instance().Intern(path.substr(0, slashPos + 1));
+        m_name = path.substr(slashPos + 1);
+    }
+}
+
+std::string CompactPath::str() const
+{
+    return m_dir == PathTable::ROOT ? m_name : PathTable::Instance().Resolve(m_dir) + m_name;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief 全局的目录表, 以父节点指针的形式保存目录树
+ *
+ * 每一级目录只保存一个节点, 节点记录父节点的编号与本级目录名(含末尾的分隔符). 同一电视剧的所有剧集,
+ * 同一数据源下的所有视频共用目录前缀, 前缀在表中只保存一份. 目录节点在进程退出前不会释放,
+ * 数量以媒体库中出现过的目录数为上限.
+ */
+class PathTable
+{
+public:
+
+    using NodeId = uint32_t;
+
+    static const NodeId ROOT = 0; // 根节点, 表示空的目录前缀
+
+    /**
+     * @brief 获取单例
+     *
+     * @return PathTable& 单例
+     */
+    static PathTable& Instance();
+
+    /**
+     * @brief 登记目录, 逐级查找或创建节点
+     *
+     * @param dir 目录, 以分隔符结尾
+     * @return NodeId 最末一级目录的节点
+     */
+    NodeId Intern(const std::string& dir);
+
+    /**
+     * @brief 还原节点对应的完整目录
+     *
+     * @param node 节点
+     * @return std::string 以分隔符结尾的目录
+     */
+    std::string Resolve(NodeId node) const;
+
+    /**
+     * @brief 获取表中的节点个数与占用的字节数(估算)
+     *
+     * @param count 输出节点个数
+     * @param bytes 输出占用的字节数
+     */
+    void Stats(std::size_t& count, std::size_t& bytes) const;
+
+private:
+
+    PathTable();
+
+    /**
+     * @brief 目录节点
+     *
+     */
+    struct Node {
+        NodeId      parent; // 父节点
+        std::string name;   // 本级目录名, 含末尾的分隔符
+    };
+
+    /**
+     * @brief 查找子节点的键: 父节点编号(4字节)与本级目录名拼接
+     *
+     * @param parent 父节点
+     * @param name 本级目录名
+     * @return std::string 键
+     */
+    static std::string ChildKey(NodeId parent, const std::string& name);
+
+private:
+
+    std::vector<Node>                       m_nodes;    // 节点编号 -> 节点
+    std::unordered_map<std::string, NodeId> m_children; // 父节点与目录名 -> 子节点
+    mutable std::mutex                      m_lock;     // 表的锁
+};
+
+/**
+ * @brief 压缩存储的文件路径: 目录为目录表中的节点, 只单独保存文件名
+ *
+ * 64位系统上std::string占32字节, 长路径还要另外申请堆内存; 压缩后目录前缀只占4字节, 文件名通常较短.
+ */
+class CompactPath
+{
+public:
+
+    CompactPath();
+    CompactPath(const std::string& path);
+
+    /**
+     * @brief 还原完整路径
+     *
+     * @return std::string 完整路径
+     */
+    std::string str() const;
+
+    operator std::string() const
+    {
+        return str();
+    }
+
+    /**
+     * @brief 文件名(不含目录)
+     *
+     * @return const std::string& 文件名
+     */
+    const std::string& name() const
+    {
+        return m_name;
+    }
+
+    bool operator==(const CompactPath& other) const
+    {
+        return m_dir == other.m_dir && m_name == other.m_name;
+    }
+
+    bool operator!=(const CompactPath& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+
+    PathTable::NodeId m_dir;  // 所在目录
+    std::string       m_name; // 文件名
+};
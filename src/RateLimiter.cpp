@@ -0,0 +1,40 @@
+#include "RateLimiter.h"
+
+#include <algorithm>
+#include <thread>
+
+RateLimiter::RateLimiter(double ratePerSec, double burst)
+    : m_ratePerSec(ratePerSec), m_burst(std::max(burst, 1.0)), m_tokens(m_burst),
+      m_lastTime(std::chrono::steady_clock::now())
+{
+}
+
+bool RateLimiter::Acquire(const std::chrono::steady_clock::time_point& deadline)
+{
+    if (m_ratePerSec <= 0) {
+        return true;
+    }
+
+    std::chrono::steady_clock::time_point readyTime;
+    {
+        std::lock_guard<std::mutex> locker(m_lock);
+
+        // 按照流逝的时间补充令牌
+        auto                          now     = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = now - m_lastTime;
+        m_tokens                              = std::min(m_burst, m_tokens + elapsed.count() * m_ratePerSec);
+        m_lastTime                            = now;
+
+        // 预约一个令牌, 令牌数为负时计算出可用的时间, 在锁外等待, 保证先到先得
+        double waitSec = m_tokens >= 1 ? 0 : (1 - m_tokens) / m_ratePerSec;
+        readyTime      = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                  std::chrono::duration<double>(waitSec));
+        if (waitSec > 0 && readyTime > deadline) {
+            return false;
+        }
+        m_tokens -= 1;
+    }
+
+    std::this_thread::sleep_until(readyTime);
+    return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+
+/**
+ * @brief 令牌桶限流器
+ *
+ * 令牌按照固定速率生成, 桶的容量决定了允许的突发请求数; 令牌不足时等待, 直到令牌生成或者超过截止时间.
+ */
+class RateLimiter
+{
+public:
+
+    /**
+     * @brief 构造限流器, 初始时令牌桶是满的
+     *
+     * @param ratePerSec 每秒生成的令牌数, 不大于0时不限流
+     * @param burst 令牌桶的容量
+     */
+    RateLimiter(double ratePerSec, double burst);
+
+    /**
+     * @brief 获取一个令牌
+     *
+     * @param deadline 等待的截止时间
+     * @return true 获取成功
+     * @return false 截止时间前无法获取令牌
+     */
+    bool Acquire(const std::chrono::steady_clock::time_point& deadline);
+
+private:
+
+    double                                m_ratePerSec; // 每秒生成的令牌数
+    double                                m_burst;      // 令牌桶的容量
+    double                                m_tokens;     // 当前的令牌数, 为负数时表示已被预约
+    std::chrono::steady_clock::time_point m_lastTime;   // 上次补充令牌的时间
+    std::mutex                            m_lock;       // 令牌桶的锁
+};
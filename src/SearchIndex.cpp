@@ -0,0 +1,367 @@
+#include "SearchIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+const std::size_t SearchIndex::MAX_QUERY_TOKENS;
+
+// 各字段的权重
+static const float TITLE_WEIGHT          = 5.0f;
+static const float ORIGINAL_TITLE_WEIGHT = 4.0f;
+static const float PEOPLE_WEIGHT         = 2.0f;
+static const float STUDIO_WEIGHT         = 1.0f;
+static const float PLOT_WEIGHT           = 1.0f;
+
+/**
+ * @brief 解码一个UTF-8字符, 非法的字节作为单独的字符返回0
+ *
+ * @param text 文本
+ * @param pos 字符的起始位置, 返回时指向下一个字符
+ * @return uint32_t 码点
+ */
+static uint32_t DecodeUtf8(const std::string& text, std::size_t& pos)
+{
+    const unsigned char lead = static_cast<unsigned char>(text[pos++]);
+    if (lead < 0x80) {
+        return lead;
+    }
+
+    std::size_t length    = 0;
+    uint32_t    codePoint = 0;
+    if ((lead & 0xE0) == 0xC0) {
+        length    = 1;
+        codePoint = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length    = 2;
+        codePoint = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length    = 3;
+        codePoint = lead & 0x07;
+    } else {
+        return 0;
+    }
+
+    for (std::size_t i = 0; i < length; i++) {
+        if (pos >= text.size() || (static_cast<unsigned char>(text[pos]) & 0xC0) != 0x80) {
+            return 0;
+        }
+        codePoint = (codePoint << 6) | (static_cast<unsigned char>(text[pos++]) & 0x3F);
+    }
+    return codePoint;
+}
+
+static void EncodeUtf8(uint32_t codePoint, std::string& out)
+{
+    if (codePoint < 0x80) {
+        out.push_back(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+static bool IsCjk(uint32_t codePoint)
+{
+    return (codePoint >= 0x3040 && codePoint <= 0x30FF) || // 平假名, 片假名
+           (codePoint >= 0x3400 && codePoint <= 0x4DBF) || // 中日韩统一表意文字扩展A
+           (codePoint >= 0x4E00 && codePoint <= 0x9FFF) || // 中日韩统一表意文字
+           (codePoint >= 0xAC00 && codePoint <= 0xD7AF) || // 韩文音节
+           (codePoint >= 0xF900 && codePoint <= 0xFAFF) || // 中日韩兼容表意文字
+           (codePoint >= 0x20000 && codePoint <= 0x2FFFF); // 中日韩统一表意文字扩展B及之后
+}
+
+static bool IsWordChar(uint32_t codePoint)
+{
+    return (codePoint >= '0' && codePoint <= '9') || (codePoint >= 'a' && codePoint <= 'z') ||
+           (codePoint >= 0xC0 && codePoint <= 0x24F && codePoint != 0xD7 && codePoint != 0xF7);
+}
+
+static uint32_t Normalize(uint32_t codePoint)
+{
+    // 全角的字母与数字转为半角
+    if (codePoint >= 0xFF01 && codePoint <= 0xFF5E) {
+        codePoint -= 0xFEE0;
+    }
+    if (codePoint >= 'A' && codePoint <= 'Z') {
+        codePoint += 'a' - 'A';
+    }
+    return codePoint;
+}
+
+SearchIndex::SearchIndex() : m_aliveNum(0) {}
+
+void SearchIndex::Tokenize(const std::string& text, std::vector<std::string>& tokens, bool withUnigrams)
+{
+    std::string word;
+    std::string prevCjk; // 上一个中日韩文字, 与当前的字组成bigram
+    bool        cjkPaired = false;
+
+    auto flushWord = [&]() {
+        if (!word.empty()) {
+            tokens.push_back(word);
+            word.clear();
+        }
+    };
+    auto flushCjk = [&]() {
+        if (!prevCjk.empty() && !cjkPaired && !withUnigrams) {
+            tokens.push_back(prevCjk);
+        }
+        prevCjk.clear();
+        cjkPaired = false;
+    };
+
+    std::size_t pos = 0;
+    while (pos < text.size()) {
+        const uint32_t codePoint = Normalize(DecodeUtf8(text, pos));
+        if (IsCjk(codePoint)) {
+            flushWord();
+            std::string current;
+            EncodeUtf8(codePoint, current);
+            if (withUnigrams) {
+                tokens.push_back(current);
+            }
+            if (!prevCjk.empty()) {
+                tokens.push_back(prevCjk + current);
+                cjkPaired = true;
+            }
+            prevCjk.swap(current);
+        } else if (IsWordChar(codePoint)) {
+            flushCjk();
+            EncodeUtf8(codePoint, word);
+        } else {
+            flushWord();
+            flushCjk();
+        }
+    }
+    flushWord();
+    flushCjk();
+}
+
+void SearchIndex::CollectPlotTerms(const std::string& plot, std::vector<std::string>& terms)
+{
+    std::vector<std::string> tokens;
+    Tokenize(plot, tokens, true);
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+    tokens.shrink_to_fit();
+    terms.swap(tokens);
+}
+
+void SearchIndex::CollectTerms(const VideoInfo&                videoInfo,
+                               const std::vector<std::string>& plotTerms,
+                               std::map<std::string, float>&   terms)
+{
+    std::vector<std::string> tokens;
+    auto addField = [&](const std::string& text, float weight) {
+        tokens.clear();
+        Tokenize(text, tokens, true);
+        for (const auto& token : tokens) {
+            terms[token] += weight;
+        }
+    };
+
+    // 没有NFO时只能按文件(目录)名搜索
+    const VideoDetail& videoDetail = videoInfo.videoDetail;
+    if (videoInfo.nfoStatus != FILE_FORMAT_MATCH || videoDetail.title.empty()) {
+        auto slashPos = videoInfo.videoPath.find_last_of("/\\");
+        addField(slashPos == std::string::npos ? videoInfo.videoPath : videoInfo.videoPath.substr(slashPos + 1),
+                 TITLE_WEIGHT);
+    }
+    if (videoInfo.nfoStatus != FILE_FORMAT_MATCH) {
+        return;
+    }
+
+    addField(videoDetail.title, TITLE_WEIGHT);
+    addField(videoDetail.originaltitle, ORIGINAL_TITLE_WEIGHT);
+    addField(videoDetail.director, PEOPLE_WEIGHT);
+    for (const auto& actor : videoDetail.actors) {
+        addField(actor.name, PEOPLE_WEIGHT);
+    }
+    for (const auto& studio : videoDetail.studio) {
+        addField(studio, STUDIO_WEIGHT);
+    }
+
+    // 剧情较长, 每个词只计一次, 避免重复出现的词压过标题
+    for (const auto& term : plotTerms) {
+        terms[term] += PLOT_WEIGHT;
+    }
+}
+
+void SearchIndex::AddDocument(VideoId id, const VideoInfo& videoInfo, const std::vector<std::string>& plotTerms)
+{
+    // 完整的视频信息带有剧情原文, 扫描结果和沿用的旧文档只有检索词; 没有NFO时不索引剧情
+    std::vector<std::string> docPlotTerms;
+    if (videoInfo.nfoStatus == FILE_FORMAT_MATCH) {
+        if (!videoInfo.videoDetail.plot.empty()) {
+            CollectPlotTerms(videoInfo.videoDetail.plot, docPlotTerms);
+        } else {
+            docPlotTerms = plotTerms;
+        }
+    }
+
+    std::map<std::string, float> terms;
+    CollectTerms(videoInfo, docPlotTerms, terms);
+
+    const uint32_t doc = static_cast<uint32_t>(m_docs.size());
+    m_docs.emplace_back();
+    Document& document = m_docs.back();
+    document.id        = id;
+    document.alive     = true;
+    document.terms.reserve(terms.size());
+    document.isPlotTerm.reserve(terms.size());
+    for (const auto& term : terms) {
+        m_postings[term.first].push_back(Posting{doc, term.second});
+        document.terms.push_back(term.first);
+        document.isPlotTerm.push_back(std::binary_search(docPlotTerms.begin(), docPlotTerms.end(), term.first));
+    }
+    m_idToDoc[id] = doc;
+    m_aliveNum++;
+}
+
+void SearchIndex::RemoveDocument(uint32_t doc)
+{
+    Document& document = m_docs[doc];
+    for (const auto& term : document.terms) {
+        auto iter = m_postings.find(term);
+        if (iter == m_postings.end()) {
+            continue;
+        }
+        auto& postings = iter->second;
+        auto  pos      = std::lower_bound(
+            postings.begin(), postings.end(), doc, [](const Posting& posting, uint32_t target) {
+                return posting.doc < target;
+            });
+        if (pos != postings.end() && pos->doc == doc) {
+            postings.erase(pos);
+        }
+        if (postings.empty()) {
+            m_postings.erase(iter);
+        }
+    }
+    document.alive = false;
+    document.terms.clear();
+    document.terms.shrink_to_fit();
+    document.isPlotTerm.clear();
+    document.isPlotTerm.shrink_to_fit();
+    m_aliveNum--;
+}
+
+void SearchIndex::Rebuild(const std::vector<VideoInfoPtr>&              videoInfos,
+                          const std::vector<VideoId>&                   ids,
+                          const std::vector<std::vector<std::string>>& plotTerms)
+{
+    SearchIndex index;
+    for (std::size_t i = 0; i < videoInfos.size(); i++) {
+        index.AddDocument(ids[i], *videoInfos[i], plotTerms[i]);
+    }
+
+    std::lock_guard<std::mutex> locker(m_lock);
+    m_postings.swap(index.m_postings);
+    m_docs.swap(index.m_docs);
+    m_idToDoc.swap(index.m_idToDoc);
+    m_aliveNum = index.m_aliveNum;
+}
+
+void SearchIndex::Update(VideoId id, const VideoInfo& videoInfo)
+{
+    std::vector<std::string> plotTerms = videoInfo.plotTerms;
+
+    std::lock_guard<std::mutex> locker(m_lock);
+    auto                        iter = m_idToDoc.find(id);
+    if (iter != m_idToDoc.end()) {
+        // 自动更新等只获取部分信息的更新不带剧情, 沿用旧文档的剧情检索词(词表有序, 提取结果仍然有序)
+        const Document& document = m_docs[iter->second];
+        if (plotTerms.empty() && videoInfo.videoDetail.plot.empty()) {
+            for (std::size_t i = 0; i < document.terms.size(); i++) {
+                if (document.isPlotTerm[i]) {
+                    plotTerms.push_back(document.terms[i]);
+                }
+            }
+        }
+        RemoveDocument(iter->second);
+    }
+    AddDocument(id, videoInfo, plotTerms);
+}
+
+std::size_t SearchIndex::Search(const std::string& query, std::size_t limit, std::vector<SearchHit>& hits) const
+{
+    hits.clear();
+    std::vector<std::string> tokens;
+    Tokenize(query, tokens);
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+    if (tokens.empty()) {
+        return 0;
+    }
+    if (tokens.size() > MAX_QUERY_TOKENS) {
+        tokens.resize(MAX_QUERY_TOKENS);
+    }
+
+    std::lock_guard<std::mutex> locker(m_lock);
+
+    // 所有词都必须出现, 从最短的倒排表开始求交集
+    std::vector<const std::vector<Posting>*> lists;
+    for (const auto& token : tokens) {
+        auto iter = m_postings.find(token);
+        if (iter == m_postings.end()) {
+            return 0;
+        }
+        lists.push_back(&iter->second);
+    }
+    std::sort(lists.begin(), lists.end(), [](const std::vector<Posting>* lhs, const std::vector<Posting>* rhs) {
+        return lhs->size() < rhs->size();
+    });
+
+    std::vector<std::pair<uint32_t, double>> candidates; // 文档编号, 相关度
+    for (std::size_t i = 0; i < lists.size(); i++) {
+        const auto&  postings = *lists[i];
+        const double idf      = std::log(1.0 + static_cast<double>(m_aliveNum) / postings.size());
+        if (i == 0) {
+            candidates.reserve(postings.size());
+            for (const auto& posting : postings) {
+                candidates.emplace_back(posting.doc, posting.weight * idf);
+            }
+            continue;
+        }
+
+        // 两个有序表归并, 只保留同时出现的文档
+        std::size_t kept    = 0;
+        auto        postIter = postings.begin();
+        for (const auto& candidate : candidates) {
+            while (postIter != postings.end() && postIter->doc < candidate.first) {
+                ++postIter;
+            }
+            if (postIter == postings.end()) {
+                break;
+            }
+            if (postIter->doc == candidate.first) {
+                candidates[kept++] = std::make_pair(candidate.first, candidate.second + postIter->weight * idf);
+            }
+        }
+        candidates.resize(kept);
+        if (candidates.empty()) {
+            return 0;
+        }
+    }
+
+    const std::size_t total = candidates.size();
+    hits.reserve(total);
+    for (const auto& candidate : candidates) {
+        hits.push_back(SearchHit{m_docs[candidate.first].id, candidate.second});
+    }
+    limit = std::min(limit, hits.size());
+    std::partial_sort(hits.begin(), hits.begin() + limit, hits.end(), [](const SearchHit& lhs, const SearchHit& rhs) {
+        return lhs.score != rhs.score ? lhs.score > rhs.score : lhs.id < rhs.id;
+    });
+    hits.resize(limit);
+    return total;
+}
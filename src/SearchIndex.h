@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Library.h"
+
+/**
+ * @brief 搜索结果中的单个视频
+ *
+ */
+struct SearchHit {
+    VideoId id;    // 视频ID
+    double  score; // 相关度, 越大越相关
+};
+
+/**
+ * @brief 媒体库元数据的全文倒排索引
+ *
+ * 索引标题, 原始标题, 剧情, 演员, 导演和制片厂. 剧情在扫描时直接切分为检索词, 不保留原文. 拉丁字母与数字按单词切分(不区分大小写),
+ * 中日韩文字没有分隔符, 索引时每个字与相邻两个字(bigram)都作为词, 查询时连续的多个字只按bigram切分,
+ * 只有一个字的查询按单字匹配. 查询的所有词都出现的视频才会命中,
+ * 相关度为各个词在视频中的字段权重与逆文档频率(IDF)的乘积之和.
+ * 文档以稳定的视频ID标识, 单个视频更新时只替换该视频的倒排项, 不需要重建索引.
+ */
+class SearchIndex
+{
+public:
+
+    static const std::size_t MAX_QUERY_TOKENS = 32; // 查询的最大词数, 超出的部分忽略
+
+    SearchIndex();
+
+    SearchIndex(const SearchIndex&)            = delete;
+    SearchIndex& operator=(const SearchIndex&) = delete;
+
+    /**
+     * @brief 重建索引, 用于发布扫描结果; 新索引在锁外构造, 构造期间查询使用旧索引
+     *
+     * @param videoInfos 所有视频信息
+     * @param ids 与videoInfos一一对应的视频ID
+     * @param plotTerms 与videoInfos一一对应的剧情检索词
+     */
+    void Rebuild(const std::vector<VideoInfoPtr>&              videoInfos,
+                 const std::vector<VideoId>&                   ids,
+                 const std::vector<std::vector<std::string>>& plotTerms);
+
+    /**
+     * @brief 更新单个视频的索引
+     *
+     * @param id 视频ID
+     * @param videoInfo 新的视频信息, 带有剧情原文或检索词时索引新的剧情, 都没有时沿用原有的剧情检索词
+     */
+    void Update(VideoId id, const VideoInfo& videoInfo);
+
+    /**
+     * @brief 搜索
+     *
+     * @param query 查询字符串
+     * @param limit 最多返回的结果数
+     * @param hits 输出按相关度降序排列的结果
+     * @return std::size_t 命中的视频总数
+     */
+    std::size_t Search(const std::string& query, std::size_t limit, std::vector<SearchHit>& hits) const;
+
+    /**
+     * @brief 切分文本, 词转为小写, 不去重
+     *
+     * @param text UTF-8文本
+     * @param tokens 输出切分得到的词(追加)
+     * @param withUnigrams 是否输出连续中日韩文字中的每个字, 建立索引时为true, 使单字的查询也能命中
+     */
+    static void Tokenize(const std::string& text, std::vector<std::string>& tokens, bool withUnigrams = false);
+
+    /**
+     * @brief 将剧情切分为去重的检索词
+     *
+     * @param plot 剧情
+     * @param terms 输出检索词(覆盖)
+     */
+    static void CollectPlotTerms(const std::string& plot, std::vector<std::string>& terms);
+
+private:
+
+    /**
+     * @brief 倒排项
+     *
+     */
+    struct Posting {
+        uint32_t doc;    // 文档编号
+        float    weight; // 词在文档中的权重(各字段权重之和)
+    };
+
+    /**
+     * @brief 文档, 更新后旧的编号不再使用, 新的编号总是递增, 使倒排表保持按编号有序
+     *
+     */
+    struct Document {
+        VideoId                  id    = 0;     // 视频ID
+        bool                     alive = false; // 是否有效
+        std::vector<std::string> terms;         // 文档包含的词(有序), 用于删除倒排项
+        std::vector<bool>        isPlotTerm;    // 与terms一一对应, 词是否来自剧情, 用于不带剧情的更新
+    };
+
+    static void CollectTerms(const VideoInfo&                videoInfo,
+                             const std::vector<std::string>& plotTerms,
+                             std::map<std::string, float>&   terms);
+
+    void AddDocument(VideoId id, const VideoInfo& videoInfo, const std::vector<std::string>& plotTerms);
+    void RemoveDocument(uint32_t doc);
+
+private:
+
+    std::unordered_map<std::string, std::vector<Posting>> m_postings; // 词 -> 按文档编号升序的倒排表
+    std::vector<Document>                                 m_docs;     // 文档编号 -> 文档
+    std::unordered_map<VideoId, uint32_t>                 m_idToDoc;  // 视频ID -> 文档编号
+    std::size_t                                           m_aliveNum; // 有效的文档数
+    mutable std::mutex                                    m_lock;     // 索引的锁
+};
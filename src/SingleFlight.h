@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief 相同请求合并执行
+ *
+ * 同一时刻以相同的key调用Do()时, 只有第一个调用者真正执行, 其余调用者等待并共享其结果.
+ * 执行结束后立即移除记录, 之后的调用会重新执行, 因此不会产生过期的缓存.
+ *
+ * @tparam T 结果的类型
+ */
+template <typename T>
+class SingleFlight
+{
+public:
+
+    using ResultPtr = std::shared_ptr<const T>;
+
+    /**
+     * @brief 执行或加入一次调用
+     *
+     * @param key 调用的唯一标识
+     * @param func 实际执行的函数, 失败时返回nullptr
+     * @return ResultPtr 共享的结果, 失败时为nullptr
+     */
+    ResultPtr Do(const std::string& key, const std::function<ResultPtr()>& func)
+    {
+        std::unique_lock<std::mutex> locker(m_lock);
+        auto                         iter = m_calls.find(key);
+        if (iter != m_calls.end()) {
+            std::shared_future<ResultPtr> future = iter->second;
+            locker.unlock();
+            return future.get();
+        }
+
+        std::promise<ResultPtr> promise;
+        m_calls[key] = promise.get_future().share();
+        locker.unlock();
+
+        ResultPtr result;
+        try {
+            result = func();
+        } catch (...) {
+            result = nullptr;
+        }
+
+        // 先移除记录再通知等待者, 保证之后的调用重新执行
+        locker.lock();
+        m_calls.erase(key);
+        locker.unlock();
+        promise.set_value(result);
+
+        return result;
+    }
+
+private:
+
+    std::map<std::string, std::shared_future<ResultPtr>> m_calls; // 正在执行的调用
+    std::mutex                                           m_lock;  // 调用记录的锁
+};
@@ -0,0 +1,35 @@
+#include "StringPool.h"
+
+StringPool& StringPool::Instance()
+{
+    static StringPool inst;
+    return inst;
+}
+
+const std::string* StringPool::Intern(const std::string& str)
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    return &*m_strings.insert(str).first;
+}
+
+void StringPool::Stats(std::size_t& count, std::size_t& bytes)
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    count = m_strings.size();
+    bytes = m_strings.bucket_count() * sizeof(void*);
+    for (const auto& str : m_strings) {
+        // 哈希表节点: 字符串对象, 缓存的哈希值, 后继指针; 超出短字符串优化的内容另外分配
+        bytes += sizeof(std::string) + sizeof(std::size_t) + sizeof(void*);
+        bytes += str.capacity() > 15 ? str.capacity() + 1 : 0;
+    }
+}
+
+InternedString::InternedString()
+{
+    static const std::string* EMPTY_STR = StringPool::Instance().Intern(std::string());
+    m_str                               = EMPTY_STR;
+}
+
+InternedString::InternedString(const std::string& str) : m_str(StringPool::Instance().Intern(str)) {}
+
+InternedString::InternedString(const char* str) : m_str(StringPool::Instance().Intern(str)) {}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+/**
+ * @brief 全局的字符串驻留池
+ *
+ * 分类, 国家, 制片厂, 演职人员等字段的取值集合很小, 却在每个视频中重复出现. 相同的字符串在池中只保存一份,
+ * 视频中只保存指向池中字符串的指针. 池中的字符串在进程退出前不会释放, 因此只用于取值有限的字段.
+ */
+class StringPool
+{
+public:
+
+    /**
+     * @brief 获取单例
+     *
+     * @return StringPool& 单例
+     */
+    static StringPool& Instance();
+
+    /**
+     * @brief 驻留字符串
+     *
+     * @param str 字符串
+     * @return const std::string* 池中的字符串, 在进程退出前保持有效
+     */
+    const std::string* Intern(const std::string& str);
+
+    /**
+     * @brief 获取池中的字符串个数与占用的字节数(估算)
+     *
+     * @param count 输出字符串个数
+     * @param bytes 输出占用的字节数
+     */
+    void Stats(std::size_t& count, std::size_t& bytes);
+
+private:
+
+    StringPool() = default;
+
+private:
+
+    std::unordered_set<std::string> m_strings; // 所有驻留的字符串, 节点的地址在插入后不变
+    std::mutex                      m_lock;    // 池的锁
+};
+
+/**
+ * @brief 驻留字符串的句柄, 只占一个指针, 可以隐式转换为const std::string&
+ *
+ * 内容相同的句柄指向同一个字符串, 比较只需要比较指针.
+ */
+class InternedString
+{
+public:
+
+    InternedString();
+    InternedString(const std::string& str);
+    InternedString(const char* str);
+
+    operator const std::string&() const
+    {
+        return *m_str;
+    }
+
+    const std::string& str() const
+    {
+        return *m_str;
+    }
+
+    const char* c_str() const
+    {
+        return m_str->c_str();
+    }
+
+    bool empty() const
+    {
+        return m_str->empty();
+    }
+
+    std::size_t size() const
+    {
+        return m_str->size();
+    }
+
+    bool operator==(const InternedString& other) const
+    {
+        return m_str == other.m_str;
+    }
+
+    bool operator!=(const InternedString& other) const
+    {
+        return m_str != other.m_str;
+    }
+
+private:
+
+    const std::string* m_str; // 池中的字符串
+};
@@ -0,0 +1,11 @@
+#include "StripedMutex.h"
+
+const std::size_t StripedMutex::STRIPE_NUM;
+
+std::mutex& StripedMutex::Of(uint64_t key)
+{
+    // 混合高位, 避免键值的低位分布不均时集中到少数几把锁
+    key ^= key >> 32;
+    key ^= key >> 16;
+    return m_stripes[key % STRIPE_NUM];
+}
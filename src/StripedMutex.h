@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief 分段互斥锁, 以固定数量的互斥锁保护任意数量的条目
+ *
+ * 条目按键值映射到其中一把锁, 同一条目的操作互斥, 不同条目的操作只在映射到同一把锁时才会互相等待.
+ * 锁的数量固定, 不随条目的增删分配或释放, 条目被删除后也无需清理.
+ */
+class StripedMutex
+{
+public:
+
+    static const std::size_t STRIPE_NUM = 64; // 锁的数量
+
+    StripedMutex() {}
+
+    StripedMutex(const StripedMutex&)            = delete;
+    StripedMutex& operator=(const StripedMutex&) = delete;
+
+    /**
+     * @brief 获取条目对应的锁
+     *
+     * @param key 条目的键值, 应当分布均匀(如哈希值)
+     * @return std::mutex& 条目对应的锁
+     */
+    std::mutex& Of(uint64_t key);
+
+private:
+
+    std::mutex m_stripes[STRIPE_NUM]; // 所有的锁
+};
@@ -1,23 +1,56 @@
 #include "TMDBAPI.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 #include "Poco/Net/HTTPClientSession.h"
 #include "Poco/Net/HTTPRequest.h"
 #include "Poco/Net/HTTPResponse.h"
-#include <Poco/JSON/Object.h>
+#include <Poco/CountingStream.h>
+#include <Poco/TeeStream.h>
 #include <Poco/URI.h>
-#include <Poco/JSON/Parser.h>
 #include <Poco/StreamCopier.h>
 #include <string>
 
+#include "ArtworkStore.h"
 #include "Config.h"
 #include "DataConvert.h"
+#include "DataSource.h"
+#include "FixtureStore.h"
 #include "ISO-3611-1.h"
+#include "JsonExtractor.h"
 #include "Logger.h"
+#include "RateLimiter.h"
+#include "SingleFlight.h"
+#include "TaskExecutor.h"
 #include "Utils.h"
 
-using namespace Poco::JSON;
+const std::size_t TMDBAPI::HEDGE_WORKER_NUM;
+const std::size_t TMDBAPI::HEDGE_QUEUE_SIZE;
+
+/**
+ * @brief 中断执行中的HTTP请求, 阻塞在该连接上的读写立即失败
+ *
+ * @param session 请求的会话
+ */
+static void AbortSession(Poco::Net::HTTPClientSession& session)
+{
+    try {
+        session.socket().shutdown();
+    } catch (Poco::Exception&) {
+        // 连接尚未建立, 请求按自身的超时结束
+    }
+}
 
 bool TMDBAPI::IsImagesAllFilled(const VideoDetail& videoDetail)
 {
@@ -44,50 +77,134 @@ const std::string& TMDBAPI::GetLastErrStr()
         {PARSE_CREDITS_FAILED, "Parse credits failed."},
         {DOWNLOAD_POSTER_FAILED, "Download poster failed."},
         {WRITE_NFO_FILE_FAILED, "Write nfo file failed."},
+        {UPSTREAM_UNAVAILABLE, "TMDB is unavailable, skipped until it recovers."},
+        {TMDB_ID_NOT_FOUND, "TMDB id not found, skipped until the cache expires."},
     };
 
     return errMap.at(m_lastErrCode);
 }
 
-bool TMDBAPI::ParseImagesToVideoDetail(std::stringstream& sS, VideoDetail& videoDetail)
+bool TMDBAPI::ParseImagesToVideoDetail(const Poco::URI& uri, ApiUrlType apiUrlType, VideoDetail& videoDetail)
 {
-    Object::Ptr jsonPtr = nullptr;
-    try {
-        Parser parser;
-        auto   result = parser.parse(sS);
-        jsonPtr       = result.extract<Object::Ptr>();
-    } catch (Poco::Exception& e) {
-        LOG_ERROR("Images json parse failed, text as fllows: ");
-        std::cout << sS.str() << std::endl;
-        return false;
-    }
+    // 各类图片均取第一张, 已经填写过的不再覆盖
+    JsonExtractor extractor;
+    extractor.OnValue("backdrops[].file_path", [&videoDetail](const std::string& val) {
+        if (videoDetail.fanartUrl.empty()) {
+            videoDetail.fanartUrl = val;
+        }
+    });
+    extractor.OnValue("logos[].file_path", [&videoDetail](const std::string& val) {
+        if (videoDetail.clearLogoUrl.empty()) {
+            videoDetail.clearLogoUrl = val;
+        }
+    });
+    extractor.OnValue("posters[].file_path", [&videoDetail](const std::string& val) {
+        if (videoDetail.posterUrl.empty()) {
+            videoDetail.posterUrl = val;
+        }
+    });
 
-    // 剧照
-    auto backdropsJsonPtr = jsonPtr->getArray("backdrops");
-    if (videoDetail.fanartUrl.empty() && !backdropsJsonPtr.isNull() && !backdropsJsonPtr->empty()) {
-        videoDetail.fanartUrl = backdropsJsonPtr->getObject(0)->optValue<std::string>("file_path", "");
-    }
+    return SendRequest(uri, apiUrlType, extractor);
+}
 
-    // logo
-    auto logosJsonPtr = jsonPtr->getArray("logos");
-    if (videoDetail.clearLogoUrl.empty() && !logosJsonPtr.isNull() && !logosJsonPtr->empty()) {
-        videoDetail.clearLogoUrl = logosJsonPtr->getObject(0)->optValue<std::string>("file_path", "");
-    }
+std::string TMDBAPI::NormalizeUri(const Poco::URI& uri)
+{
+    // 查询参数排序后拼接, 参数顺序不同的相同请求视为同一请求
+    Poco::URI normalized(uri);
+    normalized.normalize();
+    auto queryParams = normalized.getQueryParameters();
+    std::sort(queryParams.begin(), queryParams.end());
+    normalized.setQueryParameters(queryParams);
+    return normalized.toString();
+}
 
-    // 海报
-    auto postersJsonPtr = jsonPtr->getArray("posters");
-    if (videoDetail.posterUrl.empty() && !postersJsonPtr.isNull() && !postersJsonPtr->empty()) {
-        videoDetail.posterUrl = postersJsonPtr->getObject(0)->optValue<std::string>("file_path", "");
-    }
+LatencyHistogram& TMDBAPI::GetLatencyHistogram(ApiUrlType apiUrlType)
+{
+    static std::map<ApiUrlType, LatencyHistogram> histograms;
+    static std::mutex                             lock;
+
+    std::lock_guard<std::mutex> locker(lock);
+    return histograms[apiUrlType];
+}
+
+CircuitBreaker& TMDBAPI::GetCircuitBreaker(ApiUrlType apiUrlType)
+{
+    static CircuitBreaker apiBreaker(Config::Instance().GetFailurePolicy().breakerThreshold,
+                                     Config::Instance().GetFailurePolicy().breakerOpenSec);
+    static CircuitBreaker imageBreaker(Config::Instance().GetFailurePolicy().breakerThreshold,
+                                       Config::Instance().GetFailurePolicy().breakerOpenSec);
+    return apiUrlType == IMAGE_DOWNLOAD ? imageBreaker : apiBreaker;
+}
+
+NegativeCache& TMDBAPI::GetNegativeCache()
+{
+    static NegativeCache negativeCache;
+    return negativeCache;
+}
+
+TaskExecutor& TMDBAPI::GetHedgeExecutor()
+{
+    static TaskExecutor hedgeExecutor(HEDGE_WORKER_NUM, HEDGE_QUEUE_SIZE);
+    return hedgeExecutor;
+}
+
+RateLimiter& TMDBAPI::GetRateLimiter()
+{
+    // TMDB按照来源限制API的请求速率, 图像下载不受限制
+    static RateLimiter rateLimiter(Config::Instance().GetRateLimit(), Config::Instance().GetRateLimit());
+    return rateLimiter;
+}
+
+void TMDBAPI::Drain()
+{
+    GetHedgeExecutor().Shutdown();
+}
+
+bool TMDBAPI::IsUpstreamAvailable()
+{
+    return !GetCircuitBreaker(GET_MOVIE_DETAIL).IsOpen();
+}
+
+std::string TMDBAPI::MissingKey(VideoType videoType, int tmdbId)
+{
+    ApiUrlType apiUrlType = videoType == TV ? GET_TV_DETAIL : GET_MOVIE_DETAIL;
+    Poco::URI  uri(Config::Instance().GetApiUrl(apiUrlType) + std::to_string(tmdbId));
+    return uri.getPath();
+}
+
+bool TMDBAPI::IsKnownMissing(VideoType videoType, int tmdbId)
+{
+    return GetNegativeCache().Contains(MissingKey(videoType, tmdbId));
+}
+
+void TMDBAPI::ForgetMissing(VideoType videoType, int tmdbId)
+{
+    GetNegativeCache().Remove(MissingKey(videoType, tmdbId));
+}
 
+bool TMDBAPI::CheckScrapable(VideoType videoType, int tmdbId)
+{
+    if (!IsUpstreamAvailable()) {
+        m_lastErrCode = UPSTREAM_UNAVAILABLE;
+        return false;
+    }
+    if (IsKnownMissing(videoType, tmdbId)) {
+        LOG_DEBUG("TMDB id {} is known missing, skipped", tmdbId);
+        m_lastErrCode = TMDB_ID_NOT_FOUND;
+        return false;
+    }
     return true;
 }
 
-bool TMDBAPI::SendRequest(std::ostream& out, const Poco::URI& uri)
+TMDBAPI::AttemptResult TMDBAPI::SendOnce(const Poco::URI&              uri,
+                                         ApiUrlType                    apiUrlType,
+                                         const RequestPolicyConf&      policy,
+                                         Poco::Net::HTTPClientSession& session,
+                                         const BodyHandler&            handler,
+                                         const std::function<bool()>&  claim)
 {
-    Poco::Net::HTTPRequest       request;
-    Poco::Net::HTTPResponse      response;
-    Poco::Net::HTTPClientSession session;
+    Poco::Net::HTTPRequest  request;
+    Poco::Net::HTTPResponse response;
 
     // 设置访问的各项参数
     std::string path(uri.getPathAndQuery());
@@ -96,6 +213,9 @@ bool TMDBAPI::SendRequest(std::ostream& out, const Poco::URI& uri)
     }
     session.setHost(uri.getHost());
     session.setPort(uri.getPort());
+    session.setTimeout(Poco::Timespan(policy.connectTimeout, 0),
+                       Poco::Timespan(policy.readTimeout, 0),
+                       Poco::Timespan(policy.readTimeout, 0));
     request.setMethod(Poco::Net::HTTPRequest::HTTP_GET);
     request.setURI(path);
     request.setVersion(Poco::Net::HTTPMessage::HTTP_1_1);
@@ -103,93 +223,423 @@ bool TMDBAPI::SendRequest(std::ostream& out, const Poco::URI& uri)
         session.setProxy(Config::Instance().GetHttpProxyHost(), Config::Instance().GetHttpProxyPort());
     }
 
+    AttemptResult result;
+    auto          begin = std::chrono::steady_clock::now();
     try {
         session.sendRequest(request);
-        auto& rs = session.receiveResponse(response);
+        auto& rs      = session.receiveResponse(response);
+        result.status = response.getStatus();
         // 响应码必须为200
         if (response.getStatus() != Poco::Net::HTTPResponse::HTTP_OK) {
             LOG_ERROR("Response status code is {} for {}", response.getStatus(), uri.toString());
             std::string responseStr;
             Poco::StreamCopier::copyToString(rs, responseStr);
             LOG_ERROR("Response content is:\n{}", responseStr);
-            return false;
+            if (response.has("Retry-After")) {
+                result.retryAfterSec = JsonExtractor::ToInt(response.get("Retry-After"));
+            }
+        } else if (claim && !claim()) {
+            LOG_DEBUG("Another attempt is handling the response, drop this one: {}", uri.toString());
+            result.status = 0;
         } else {
-            Poco::StreamCopier::copyStream(rs, out);
+            // 响应内容直接从套接字交给处理函数; 内容长度不符说明连接中途断开
+            result.delivered = true;
+            Poco::CountingInputStream counting(rs);
+            result.handled = handler(counting);
+            if (result.handled && response.hasContentLength() &&
+                counting.chars() != static_cast<std::streamsize>(response.getContentLength64())) {
+                LOG_ERROR("Response of uri {} is truncated", uri.toString());
+                result.handled = false;
+                result.status  = 0;
+            }
+            if (result.handled) {
+                GetLatencyHistogram(apiUrlType)
+                    .Record(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::steady_clock::now() - begin)
+                                .count());
+            }
         }
     } catch (Poco::Exception& e) {
         LOG_ERROR("Send request failed for uri {} : {}", uri.toString(), e.displayText());
-        return false;
+        result.status  = 0;
+        result.handled = false;
+    } catch (std::exception& e) {
+        LOG_ERROR("Handle response failed for uri {} : {}", uri.toString(), e.what());
+        result.handled = false;
     }
 
-    return true;
+    return result;
 }
 
-// bool TMDBAPI::Search(std::ostream& out, VideoType VideoType, const std::string& keywords, const std::string& year)
-// {
-//     // 拼接访问的URL
-//     ApiUrlType apiUrlType = VideoType == TV ? SEARCH_TV : SEARCH_MOVIE;
-//     std::string uriStr        = Config::Instance().GetApiUrl(apiUrlType);
+TMDBAPI::AttemptResult TMDBAPI::SendHedged(const Poco::URI&                             uri,
+                                           ApiUrlType                                   apiUrlType,
+                                           const RequestPolicyConf&                     policy,
+                                           const std::chrono::steady_clock::time_point& deadline,
+                                           const BodyHandler&                           handler)
+{
+    // 主请求在调用线程中执行, 对冲请求在执行器的线程中执行, 调用者返回后对冲请求可能仍持有该状态.
+    // 先收到响应的请求取得响应内容的处理权, 另一个请求放弃其响应; 处理函数只会被其中一个请求调用
+    struct HedgeState {
+        std::mutex                    lock;
+        std::condition_variable       cond;
+        Poco::Net::HTTPClientSession* primarySession = nullptr; // 执行中的主请求, 对冲请求取得处理权时将其中断
+        bool                          primaryDone    = false;   // 主请求已结束
+        bool                          primaryClaimed = false;   // 主请求已取得处理权
+        bool                          hedgeStarted   = false;   // 对冲请求已发出
+        bool                          hedgeClaimed   = false;   // 对冲请求已取得处理权, 调用者必须等待其结束
+        bool                          hedgeDone      = false;   // 对冲请求已结束
+        bool                          abandoned      = false;   // 调用者已返回, 对冲请求不能再发出或取得处理权
+        AttemptResult                 hedgeResult;              // 对冲请求的结果
+    };
+    auto              state     = std::make_shared<HedgeState>();
+    LatencyHistogram& histogram = GetLatencyHistogram(apiUrlType);
+
+    // 样本足够时预约一个对冲请求: 在执行器中等到分位数阈值, 主请求仍未结束才发出, 执行器已满时不对冲
+    const uint64_t HEDGE_MIN_SAMPLES = 20;
+    bool           hedged            = false;
+    if (policy.hedgePercentile > 0 && histogram.Count() >= HEDGE_MIN_SAMPLES) {
+        auto hedgeAt = std::min(deadline,
+                                std::chrono::steady_clock::now() +
+                                    std::chrono::milliseconds(histogram.Percentile(policy.hedgePercentile)));
+        const BodyHandler* handlerPtr = &handler; // 只在取得处理权后使用, 此时调用者一定在等待
+        TaskExecutor::Task hedge      = [state, uri, apiUrlType, policy, hedgeAt, handlerPtr]() {
+            {
+                std::unique_lock<std::mutex> locker(state->lock);
+                state->cond.wait_until(locker, hedgeAt, [&state]() { return state->primaryDone || state->abandoned; });
+                if (state->primaryDone || state->abandoned) {
+                    return;
+                }
+                // 对冲请求额外占用一个令牌, 不等待令牌, 没有空闲的令牌时不对冲
+                if (apiUrlType != IMAGE_DOWNLOAD && !GetRateLimiter().Acquire(std::chrono::steady_clock::now())) {
+                    return;
+                }
+                state->hedgeStarted = true;
+            }
+
+            auto claim = [&state]() {
+                std::lock_guard<std::mutex> locker(state->lock);
+                if (state->primaryClaimed || state->abandoned) {
+                    return false;
+                }
+                state->hedgeClaimed = true;
+                if (state->primarySession != nullptr) {
+                    AbortSession(*state->primarySession);
+                }
+                state->cond.notify_all();
+                return true;
+            };
 
-//     Poco::URI uri(uriStr);
-//     uri.addQueryParameter("api_key", Config::Instance().GetApiKey());
-//     uri.addQueryParameter("language", "zh-cn");
-//     uri.addQueryParameter("query", keywords);
-//     if (!year.empty()) {
-//         uri.addQueryParameter("year", year);
-//     }
-//     LOG_DEBUG("Search uri is: {}", uri.toString());
+            LOG_DEBUG("Request exceeds p{} latency, send hedged request: {}", policy.hedgePercentile, uri.toString());
+            Poco::Net::HTTPClientSession session;
+            AttemptResult                result = SendOnce(uri, apiUrlType, policy, session, *handlerPtr, claim);
 
-//     return SendRequest(out, uri);
-// }
+            std::lock_guard<std::mutex> locker(state->lock);
+            state->hedgeResult = result;
+            state->hedgeDone   = true;
+            state->cond.notify_all();
+        };
+        hedged = GetHedgeExecutor().Submit({hedge});
+    }
+
+    AttemptResult result;
+    {
+        auto claim = [&state]() {
+            std::lock_guard<std::mutex> locker(state->lock);
+            if (state->hedgeClaimed) {
+                return false;
+            }
+            state->primaryClaimed = true;
+            return true;
+        };
+
+        Poco::Net::HTTPClientSession session;
+        {
+            std::lock_guard<std::mutex> locker(state->lock);
+            state->primarySession = &session;
+        }
+        result = SendOnce(uri, apiUrlType, policy, session, handler, hedged ? claim : std::function<bool()>());
+
+        std::lock_guard<std::mutex> locker(state->lock);
+        state->primarySession = nullptr;
+    }
+    if (!hedged) {
+        return result;
+    }
+
+    std::unique_lock<std::mutex> locker(state->lock);
+    state->primaryDone = true;
+    state->cond.notify_all();
+
+    // 主请求处理了响应或者对冲请求还未发出时直接返回; 否则主请求失败(或被对冲请求中断), 等待对冲请求
+    if (result.delivered || !state->hedgeStarted) {
+        state->abandoned = true;
+        return result;
+    }
+    state->cond.wait_until(locker, deadline, [&state]() { return state->hedgeDone || state->hedgeClaimed; });
+    if (state->hedgeClaimed) {
+        // 对冲请求正在调用处理函数, 必须等其结束, 耗时受读超时限制
+        state->cond.wait(locker, [&state]() { return state->hedgeDone; });
+        return state->hedgeResult;
+    }
+    if (!state->hedgeDone) {
+        LOG_ERROR("Request deadline({}s) exceeded for uri {}", policy.totalTimeout, uri.toString());
+    }
+    state->abandoned = true;
+    return result;
+}
 
-bool TMDBAPI::ParseMovieDetailsToVideoDetail(std::stringstream& sS, VideoDetail& videoDetail)
+TMDBAPI::RequestOutcome TMDBAPI::DoRequest(const Poco::URI& uri, ApiUrlType apiUrlType, const BodyHandler& handler)
 {
-    Object::Ptr jsonPtr = nullptr;
-    try {
-        Parser parser;
-        auto   result = parser.parse(sS);
-        jsonPtr       = result.extract<Object::Ptr>();
-    } catch (Poco::Exception& e) {
-        LOG_ERROR("Movie detail json parse failed, text as fllows: ");
-        std::cout << sS.str() << std::endl;
+    const RequestPolicyConf policy   = Config::Instance().GetRequestPolicy(apiUrlType);
+    const auto              deadline = std::chrono::steady_clock::now() + std::chrono::seconds(policy.totalTimeout);
+
+    static std::mt19937 randomEngine(std::random_device{}());
+    static std::mutex   randomLock;
+
+    // 近期返回过404的资源直接失败, 熔断期间不再访问网络
+    const FailurePolicyConf failurePolicy = Config::Instance().GetFailurePolicy();
+    CircuitBreaker&         breaker       = GetCircuitBreaker(apiUrlType);
+    if (GetNegativeCache().Contains(uri.getPath())) {
+        LOG_DEBUG("Resource is known missing, skipped: {}", uri.getPath());
+        return REQUEST_FAILED;
+    }
+
+    // 录制模式下边处理边保存响应, 供模拟TMDB服务器回放
+    static FixtureStore fixtureStore(Config::Instance().GetFixtureRecordPath());
+    std::ostringstream  recorded;
+    BodyHandler         recordingHandler = [&handler, &recorded](std::istream& in) {
+        Poco::TeeInputStream tee(in);
+        tee.addStream(recorded);
+        return handler(tee);
+    };
+    const BodyHandler& bodyHandler = fixtureStore.IsEnabled() ? recordingHandler : handler;
+
+    for (int attempt = 0;; attempt++) {
+        // 每次尝试(包括重试)先获取本地限流的令牌; 未获取到时没有访问上游, 不计入熔断器, 也不重试
+        if (apiUrlType != IMAGE_DOWNLOAD && !GetRateLimiter().Acquire(deadline)) {
+            LOG_WARN("No rate limit token before deadline, throttled uri {}", uri.getPath());
+            return REQUEST_THROTTLED;
+        }
+        if (!breaker.Allow()) {
+            LOG_WARN("Circuit breaker is open, skipped uri {}", uri.getPath());
+            return REQUEST_FAILED;
+        }
+
+        AttemptResult result = SendHedged(uri, apiUrlType, policy, deadline, bodyHandler);
+
+        // 网络错误和服务端错误说明上游(或代理)异常, 其余的响应说明上游可用
+        if (result.status == 0 || result.status >= Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR) {
+            breaker.OnFailure();
+        } else {
+            breaker.OnSuccess();
+        }
+        if (result.status == Poco::Net::HTTPResponse::HTTP_NOT_FOUND) {
+            GetNegativeCache().Add(uri.getPath(), failurePolicy.notFoundTtl);
+        }
+
+        if (result.handled) {
+            if (fixtureStore.IsEnabled()) {
+                fixtureStore.Save(FixtureStore::KeyOf(uri), recorded.str());
+            }
+            return REQUEST_OK;
+        }
+
+        // 响应内容已经(部分)交给处理函数时无法重来; 仅对网络错误, 限流和服务端错误进行重试
+        bool retryable = !result.delivered && (result.status == 0 ||
+                                               result.status == Poco::Net::HTTPResponse::HTTP_TOO_MANY_REQUESTS ||
+                                               result.status >= Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+        if (!retryable || attempt >= policy.maxRetries) {
+            return REQUEST_FAILED;
+        }
+
+        // 指数退避并加入随机抖动, 服务端给出Retry-After时至少等待该时间
+        int backoffMs = std::min(policy.backoffMaxMs, policy.backoffBaseMs << std::min(attempt, 16));
+        {
+            std::lock_guard<std::mutex> locker(randomLock);
+            backoffMs = std::uniform_int_distribution<int>(backoffMs / 2, std::max(backoffMs, 1))(randomEngine);
+        }
+        backoffMs = std::max(backoffMs, result.retryAfterSec * 1000);
+        if (std::chrono::steady_clock::now() + std::chrono::milliseconds(backoffMs) >= deadline) {
+            LOG_ERROR("No time left to retry uri {}", uri.toString());
+            return REQUEST_FAILED;
+        }
+
+        LOG_WARN("Retry({}/{}) uri {} after {}ms", attempt + 1, policy.maxRetries, uri.toString(), backoffMs);
+        std::this_thread::sleep_for(std::chrono::milliseconds(backoffMs));
+    }
+}
+
+bool TMDBAPI::SendRequest(const Poco::URI& uri, ApiUrlType apiUrlType, JsonExtractor& extractor)
+{
+    // 同时发起的相同请求(如批量刷新同一部剧的多个季)只访问一次网络: 第一个请求直接从套接字解析,
+    // 只共享提取出的字段, 其余请求在自己的解析器上重放; 提取的字段不同时解析结果不同, 不合并
+    static SingleFlight<JsonExtractor::Events> inFlightRequests;
+
+    bool isLeader = false;
+    auto events   = inFlightRequests.Do(
+        NormalizeUri(uri) + '#' + extractor.Signature(),
+        [this, &uri, apiUrlType, &extractor, &isLeader]() -> SingleFlight<JsonExtractor::Events>::ResultPtr {
+            isLeader    = true;
+            auto parsed = std::make_shared<JsonExtractor::Events>();
+            auto parse  = [&uri, &extractor, &parsed](std::istream& in) {
+                if (!extractor.Parse(in, parsed.get())) {
+                    LOG_ERROR("Json parse failed({}) for uri {}", extractor.GetLastError(), uri.getPath());
+                    return false;
+                }
+                return true;
+            };
+            if (DoRequest(uri, apiUrlType, parse) != REQUEST_OK) {
+                return nullptr;
+            }
+            return parsed;
+        });
+    if (events == nullptr) {
+        return false;
+    }
+
+    if (!isLeader) {
+        extractor.Replay(*events);
     }
+    return true;
+}
 
-    videoDetail.title          = jsonPtr->getValue<std::string>("title");
-    videoDetail.originaltitle  = jsonPtr->getValue<std::string>("original_title");
-    videoDetail.ratings.rating = jsonPtr->getValue<double>("vote_average");
-    videoDetail.ratings.votes  = jsonPtr->getValue<int>("vote_count");
-    videoDetail.plot           = jsonPtr->getValue<std::string>("overview");
+bool TMDBAPI::DownloadImage(std::ostream& out, const Poco::URI& uri)
+{
+    // 图片不合并请求, 响应内容直接从套接字写入调用者的输出流(仓库边下载边计算哈希), 不在内存中缓存
+    auto copy = [&out](std::istream& in) {
+        Poco::StreamCopier::copyStream(in, out);
+        return out.good();
+    };
+    return DoRequest(uri, IMAGE_DOWNLOAD, copy) == REQUEST_OK;
+}
 
-    if (!jsonPtr->getValue<std::string>("poster_path").empty()) {
-        const std::string imageUrl =
-            Config::Instance().GetApiUrl(IMAGE_DOWNLOAD) + Config::Instance().GetImageDownloadQuality();
-        videoDetail.posterUrl = imageUrl + jsonPtr->getValue<std::string>("poster_path");
+bool TMDBAPI::Search(VideoType videoType, const std::string& keywords, int year, std::vector<SearchResult>& results)
+{
+    // 拼接访问的URL
+    ApiUrlType apiUrlType = videoType == TV ? SEARCH_TV : SEARCH_MOVIE;
+    Poco::URI  uri(Config::Instance().GetApiUrl(apiUrlType));
+    uri.addQueryParameter("api_key", Config::Instance().GetApiKey());
+    uri.addQueryParameter("language", "zh-CN");
+    uri.addQueryParameter("query", keywords);
+    if (year > 0) {
+        uri.addQueryParameter(videoType == TV ? "first_air_date_year" : "year", std::to_string(year));
     }
+    LOG_DEBUG("Search uri is: {}", uri.toString());
+
+    // 电影与电视剧的字段名称不同
+    const std::string titleKey         = videoType == TV ? "results[].name" : "results[].title";
+    const std::string originalTitleKey = videoType == TV ? "results[].original_name" : "results[].original_title";
+    const std::string dateKey          = videoType == TV ? "results[].first_air_date" : "results[].release_date";
+
+    SearchResult  result;
+    JsonExtractor extractor;
+    extractor.OnValue("results[].id", [&result](const std::string& val) {
+        result.tmdbId = JsonExtractor::ToInt(val);
+    });
+    extractor.OnValue(titleKey, [&result](const std::string& val) { result.title = val; });
+    extractor.OnValue(originalTitleKey, [&result](const std::string& val) { result.originalTitle = val; });
+    extractor.OnValue(dateKey, [&result](const std::string& val) {
+        result.year = JsonExtractor::ToInt(val.substr(0, 4));
+    });
+    extractor.OnValue("results[].popularity", [&result](const std::string& val) {
+        result.popularity = JsonExtractor::ToDouble(val);
+    });
+    extractor.OnObjectEnd("results[]", [&result, &results]() {
+        if (result.tmdbId > 0) {
+            results.push_back(result);
+        }
+        result = SearchResult();
+    });
 
-    auto genreJsonPtr = jsonPtr->getArray("genres");
-    for (std::size_t i = 0; i < genreJsonPtr->size(); i++) {
-        videoDetail.genre.push_back(genreJsonPtr->getObject(i)->getValue<std::string>("name"));
+    if (!SendRequest(uri, apiUrlType, extractor)) {
+        LOG_ERROR("Search failed for keywords: {}", keywords);
+        return false;
     }
 
-    auto contriesJsonPtr = jsonPtr->getArray("production_countries");
-    for (std::size_t i = 0; i < contriesJsonPtr->size(); i++) {
-        const std::string& code = contriesJsonPtr->getObject(i)->getValue<std::string>("iso_3166_1");
-        videoDetail.countries.push_back(ISO_3611_CODE_TO_STR.at(code));
+    return true;
+}
+
+bool TMDBAPI::GetRuntime(VideoType videoType, int tmdbId, int& runtime)
+{
+    ApiUrlType apiUrlType = videoType == TV ? GET_TV_DETAIL : GET_MOVIE_DETAIL;
+    Poco::URI  uri(Config::Instance().GetApiUrl(apiUrlType) + std::to_string(tmdbId));
+    uri.addQueryParameter("api_key", Config::Instance().GetApiKey());
+    uri.addQueryParameter("language", "zh-CN");
+
+    // 电视剧取第一个单集时长
+    runtime = 0;
+    JsonExtractor extractor;
+    extractor.OnValue(videoType == TV ? "episode_run_time[]" : "runtime", [&runtime](const std::string& val) {
+        if (runtime == 0) {
+            runtime = JsonExtractor::ToInt(val);
+        }
+    });
+
+    if (!SendRequest(uri, apiUrlType, extractor)) {
+        LOG_ERROR("Get runtime failed for tmdb id {}", tmdbId);
+        return false;
     }
 
-    videoDetail.premiered = jsonPtr->getValue<std::string>("release_date");
+    return runtime > 0;
+}
 
-    auto studioJsonArrPtr = jsonPtr->getArray("production_companies");
-    for (std::size_t i = 0; i < studioJsonArrPtr->size(); i++) {
-        videoDetail.studio.push_back(studioJsonArrPtr->getObject(i)->getValue<std::string>("name"));
+bool TMDBAPI::GetAiringInfo(int tmdbId, AiringInfo& airingInfo)
+{
+    Poco::URI uri(Config::Instance().GetApiUrl(GET_TV_DETAIL) + std::to_string(tmdbId));
+    uri.addQueryParameter("api_key", Config::Instance().GetApiKey());
+    uri.addQueryParameter("language", "zh-CN");
+
+    airingInfo = AiringInfo();
+    JsonExtractor extractor;
+    extractor.OnValue("status", [&airingInfo](const std::string& val) { airingInfo.status = val; });
+    extractor.OnValue("last_air_date", [&airingInfo](const std::string& val) { airingInfo.lastAirDate = val; });
+    extractor.OnValue("next_episode_to_air.air_date", [&airingInfo](const std::string& val) {
+        airingInfo.nextAirDate = val;
+    });
+
+    if (!SendRequest(uri, GET_TV_DETAIL, extractor)) {
+        LOG_ERROR("Get airing info failed for tmdb id {}", tmdbId);
+        return false;
     }
 
+    airingInfo.isEnded = airingInfo.status == "Ended" || airingInfo.status == "Canceled";
     return true;
 }
 
+bool TMDBAPI::ParseMovieDetailsToVideoDetail(const Poco::URI& uri, VideoDetail& videoDetail)
+{
+    const std::string imageUrl =
+        Config::Instance().GetApiUrl(IMAGE_DOWNLOAD) + Config::Instance().GetImageDownloadQuality();
+
+    JsonExtractor extractor;
+    extractor.OnValue("title", [&videoDetail](const std::string& val) { videoDetail.title = val; });
+    extractor.OnValue("original_title", [&videoDetail](const std::string& val) { videoDetail.originaltitle = val; });
+    extractor.OnValue("vote_average", [&videoDetail](const std::string& val) {
+        videoDetail.ratings.rating = JsonExtractor::ToDouble(val);
+    });
+    extractor.OnValue("vote_count", [&videoDetail](const std::string& val) {
+        videoDetail.ratings.votes = JsonExtractor::ToInt(val);
+    });
+    extractor.OnValue("overview", [&videoDetail](const std::string& val) { videoDetail.plot = val; });
+    extractor.OnValue("poster_path", [&videoDetail, &imageUrl](const std::string& val) {
+        if (!val.empty()) {
+            videoDetail.posterUrl = imageUrl + val;
+        }
+    });
+    extractor.OnValue("genres[].name", [&videoDetail](const std::string& val) { videoDetail.genre.push_back(val); });
+    extractor.OnValue("production_countries[].iso_3166_1", [&videoDetail](const std::string& val) {
+        videoDetail.countries.push_back(ISO_3611_CODE_TO_STR.at(val));
+    });
+    extractor.OnValue("release_date", [&videoDetail](const std::string& val) { videoDetail.premiered = val; });
+    extractor.OnValue("production_companies[].name", [&videoDetail](const std::string& val) {
+        videoDetail.studio.push_back(val);
+    });
+
+    return SendRequest(uri, GET_MOVIE_DETAIL, extractor);
+}
+
 bool TMDBAPI::GetMovieDetail(int tmdbId, VideoDetail& videoDetail)
 {
-    std::stringstream sS;
     // 拼接访问的URL
     std::string uriStr = Config::Instance().GetApiUrl(GET_MOVIE_DETAIL) + std::to_string(tmdbId);
 
@@ -198,37 +648,62 @@ bool TMDBAPI::GetMovieDetail(int tmdbId, VideoDetail& videoDetail)
     uri.addQueryParameter("language", "zh-cn");
     LOG_DEBUG("Get movie detail uri is: {}", uri.toString());
 
-    if (SendRequest(sS, uri)) {
-        return ParseMovieDetailsToVideoDetail(sS, videoDetail);
-    } else {
-        return false;
-    }
+    return ParseMovieDetailsToVideoDetail(uri, videoDetail);
 }
 
-bool TMDBAPI::ParseTVDetailsToVideoDetail(std::stringstream& sS, VideoDetail& videoDetail, int seasonId)
+bool TMDBAPI::ParseTVDetailsToVideoDetail(const Poco::URI& uri, VideoDetail& videoDetail, int seasonId)
 {
-    Object::Ptr jsonPtr = nullptr;
-    try {
-        Parser parser;
-        auto   result = parser.parse(sS);
-        jsonPtr       = result.extract<Object::Ptr>();
-    } catch (Poco::Exception& e) {
-        LOG_ERROR("TV detail json parse failed, text as fllows: ");
-        std::cout << sS.str() << std::endl;
+    std::string  name;
+    std::string  posterPath;
+    std::string  overview;
+    SeasonDetail currentSeason;
+    SeasonDetail selectedSeason;
+    currentSeason.seasonNumber = -1;
+    selectedSeason.queryed     = false;
+
+    JsonExtractor extractor;
+    extractor.OnValue("name", [&name](const std::string& val) { name = val; });
+    extractor.OnValue("poster_path", [&posterPath](const std::string& val) { posterPath = val; });
+    extractor.OnValue("overview", [&overview](const std::string& val) { overview = val; });
+    extractor.OnValue("original_name", [&videoDetail](const std::string& val) { videoDetail.originaltitle = val; });
+    extractor.OnValue("vote_average", [&videoDetail](const std::string& val) {
+        videoDetail.ratings.rating = JsonExtractor::ToDouble(val);
+    });
+    extractor.OnValue("vote_count", [&videoDetail](const std::string& val) {
+        videoDetail.ratings.votes = JsonExtractor::ToInt(val);
+    });
+    extractor.OnValue("genres[].name", [&videoDetail](const std::string& val) { videoDetail.genre.push_back(val); });
+    extractor.OnValue("production_countries[].iso_3166_1", [&videoDetail](const std::string& val) {
+        videoDetail.countries.push_back(ISO_3611_CODE_TO_STR.at(val));
+    });
+    extractor.OnValue("production_companies[].name", [&videoDetail](const std::string& val) {
+        videoDetail.studio.push_back(val);
+    });
+
+    // 仅保留指定的季
+    extractor.OnValue("seasons[].season_number", [&currentSeason](const std::string& val) {
+        currentSeason.seasonNumber = JsonExtractor::ToInt(val, -1);
+    });
+    extractor.OnValue("seasons[].name", [&currentSeason](const std::string& val) { currentSeason.name = val; });
+    extractor.OnValue("seasons[].poster_path", [&currentSeason](const std::string& val) {
+        currentSeason.posterPath = val;
+    });
+    extractor.OnValue("seasons[].overview", [&currentSeason](const std::string& val) { currentSeason.plot = val; });
+    extractor.OnObjectEnd("seasons[]", [&currentSeason, &selectedSeason, seasonId]() {
+        if (currentSeason.seasonNumber == seasonId) {
+            selectedSeason         = currentSeason;
+            selectedSeason.queryed = true;
+        }
+        currentSeason              = SeasonDetail();
+        currentSeason.seasonNumber = -1;
+    });
+
+    if (!SendRequest(uri, GET_TV_DETAIL, extractor)) {
         return false;
     }
 
     // 获取指定的季
-    Object::Ptr selectedSeason = nullptr;
-    auto seasonArr = jsonPtr->getArray("seasons");
-    for (size_t i = 0; i < seasonArr->size(); i++) {
-        auto season = seasonArr->getObject(i);
-        if (season->getValue<int>("season_number") == seasonId) {
-            selectedSeason = season;
-            break;
-        } 
-    }
-    if (selectedSeason == nullptr) {
+    if (!selectedSeason.queryed) {
         LOG_ERROR("Could not found given season id!");
         return false;
     }
@@ -237,47 +712,27 @@ bool TMDBAPI::ParseTVDetailsToVideoDetail(std::stringstream& sS, VideoDetail& vi
         "第一季", "第1季", "第 1 季",
         "SEASON ONE", "SEASON1", "SEASON 1",
     };
-    auto iter = seasonOne.find(selectedSeason->getValue<std::string>("name"));
+    auto iter = seasonOne.find(selectedSeason.name);
     if ( iter != seasonOne.end() || seasonId == 1 ) { // 第一部不加序号
-        videoDetail.title = jsonPtr->getValue<std::string>("name");
+        videoDetail.title = name;
     } else {
-        videoDetail.title = jsonPtr->getValue<std::string>("name") + std::to_string(seasonId);
+        videoDetail.title = name + std::to_string(seasonId);
     }
 
     const std::string imageUrl =
         Config::Instance().GetApiUrl(IMAGE_DOWNLOAD) + Config::Instance().GetImageDownloadQuality();
-    if (selectedSeason->isNull("poster_path")) {
-        if (!jsonPtr->getValue<std::string>("poster_path").empty()) {
-            videoDetail.posterUrl = imageUrl + jsonPtr->getValue<std::string>("poster_path");
+    if (selectedSeason.posterPath.empty()) {
+        if (!posterPath.empty()) {
+            videoDetail.posterUrl = imageUrl + posterPath;
         }
     } else {
-        videoDetail.posterUrl = imageUrl + selectedSeason->getValue<std::string>("poster_path");
+        videoDetail.posterUrl = imageUrl + selectedSeason.posterPath;
     }
 
-    if (selectedSeason->getValue<std::string>("overview").empty()) {
-        videoDetail.plot = jsonPtr->getValue<std::string>("overview");
+    if (selectedSeason.plot.empty()) {
+        videoDetail.plot = overview;
     } else {
-        videoDetail.plot = selectedSeason->getValue<std::string>("overview");
-    }
-
-    videoDetail.originaltitle  = jsonPtr->getValue<std::string>("original_name");
-    videoDetail.ratings.rating = jsonPtr->getValue<double>("vote_average");
-    videoDetail.ratings.votes  = jsonPtr->getValue<int>("vote_count");
-
-    auto genreJsonPtr = jsonPtr->getArray("genres");
-    for (std::size_t i = 0; i < genreJsonPtr->size(); i++) {
-        videoDetail.genre.push_back(genreJsonPtr->getObject(i)->getValue<std::string>("name"));
-    }
-
-    auto contriesJsonPtr = jsonPtr->getArray("production_countries");
-    for (std::size_t i = 0; i < contriesJsonPtr->size(); i++) {
-        const std::string& code = contriesJsonPtr->getObject(i)->getValue<std::string>("iso_3166_1");
-        videoDetail.countries.push_back(ISO_3611_CODE_TO_STR.at(code));
-    }
-
-    auto studioJsonArrPtr = jsonPtr->getArray("production_companies");
-    for (std::size_t i = 0; i < studioJsonArrPtr->size(); i++) {
-        videoDetail.studio.push_back(studioJsonArrPtr->getObject(i)->getValue<std::string>("name"));
+        videoDetail.plot = selectedSeason.plot;
     }
 
     return true;
@@ -285,7 +740,6 @@ bool TMDBAPI::ParseTVDetailsToVideoDetail(std::stringstream& sS, VideoDetail& vi
 
 bool TMDBAPI::GetTVDetail(int tmdbId, int seasonId, VideoDetail& videoDetail)
 {
-    std::stringstream sS;
     // 拼接访问的URL
     std::string uriStr = Config::Instance().GetApiUrl(GET_TV_DETAIL) + std::to_string(tmdbId);
 
@@ -294,16 +748,11 @@ bool TMDBAPI::GetTVDetail(int tmdbId, int seasonId, VideoDetail& videoDetail)
     uri.addQueryParameter("language", "zh-cn");
     LOG_DEBUG("Get tv detail uri is: {}", uri.toString());
 
-    if (SendRequest(sS, uri)) {
-        return ParseTVDetailsToVideoDetail(sS, videoDetail, seasonId);
-    } else {
-        return false;
-    }
+    return ParseTVDetailsToVideoDetail(uri, videoDetail, seasonId);
 }
 
 bool TMDBAPI::GetSeasonDetail(int tmdbId, int seasonId, VideoDetail& videoDetail, bool forceUseOnlineTvMeta)
 {
-    std::stringstream sS;
     // 拼接访问的URL
     std::string uriStr = Config::Instance().GetApiUrl(GET_SEASON_DETAIL);
     if (ReplaceString(uriStr, "{tv_id}", std::to_string(tmdbId)) <= 0) {
@@ -318,82 +767,85 @@ bool TMDBAPI::GetSeasonDetail(int tmdbId, int seasonId, VideoDetail& videoDetail
     uri.addQueryParameter("language", "zh-cn");
     LOG_DEBUG("Get season detail uri is: {}", uri.toString());
 
-    if (SendRequest(sS, uri)) {
-        Parser      parser;
-        Object::Ptr jsonPtr = nullptr;
-        try {
-            auto result = parser.parse(sS);
-            jsonPtr     = result.extract<Object::Ptr>();
-        } catch (Poco::Exception& e) {
-            LOG_ERROR("Parse season detail failed, text: {}", sS.str());
+    // 剧集列表直接从响应中提取, 不构建完整的JSON对象树
+    std::vector<EpisodeDetail> episodeDetails;
+    EpisodeDetail              currentEpisode = EpisodeDetail();
+    JsonExtractor              extractor;
+    extractor.OnValue("air_date", [&videoDetail](const std::string& val) { videoDetail.premiered = val; });
+    extractor.OnValue("episodes[].name", [&currentEpisode](const std::string& val) { currentEpisode.title = val; });
+    extractor.OnValue("episodes[].overview", [&currentEpisode](const std::string& val) {
+        currentEpisode.plot = val;
+    });
+    extractor.OnValue("episodes[].season_number", [&currentEpisode](const std::string& val) {
+        currentEpisode.seasonNumber = JsonExtractor::ToInt(val);
+    });
+    extractor.OnValue("episodes[].episode_number", [&currentEpisode](const std::string& val) {
+        currentEpisode.episodeNumber = JsonExtractor::ToInt(val);
+    });
+    extractor.OnObjectEnd("episodes[]", [&currentEpisode, &episodeDetails]() {
+        episodeDetails.push_back(currentEpisode);
+        currentEpisode = EpisodeDetail();
+    });
+
+    if (!SendRequest(uri, GET_SEASON_DETAIL, extractor)) {
+        if (!extractor.GetLastError().empty()) {
             m_lastErrCode = PARSE_SEASON_DETAIL_FAILED;
-            return false;
-        }
-        videoDetail.premiered = jsonPtr->getValue<std::string>("air_date");
-        auto episodesJsonArr = jsonPtr->getArray("episodes");
-        if (!WriteEpisodeNfo(episodesJsonArr, videoDetail.episodePaths, seasonId, forceUseOnlineTvMeta)) {
-            LOG_ERROR("Write episode nfos failed!");
-            return false;
-        } else {
-            // 如果写入成功, 需要即时更新, 否则剧集nfo个数未更新会导致反复写入新剧集的nfo
-            videoDetail.episodeNfoCount = videoDetail.episodePaths.size();
         }
-        return true;
-    } else {
         return false;
     }
-}
 
-bool TMDBAPI::ParseCreditsToVideoDetail(std::stringstream& sS, VideoDetail& videoDetail)
-{
-    Object::Ptr jsonPtr = nullptr;
-    try {
-        Parser parser;
-        auto   result = parser.parse(sS);
-        jsonPtr       = result.extract<Object::Ptr>();
-    } catch (Poco::Exception& e) {
-        LOG_ERROR("Credits json parse failed, text as fllows: ");
-        std::cout << sS.str() << std::endl;
+    if (!WriteEpisodeNfo(episodeDetails, videoDetail.episodePaths, seasonId, forceUseOnlineTvMeta)) {
+        LOG_ERROR("Write episode nfos failed!");
         return false;
+    } else {
+        // 如果写入成功, 需要即时更新, 否则剧集nfo个数未更新会导致反复写入新剧集的nfo
+        videoDetail.episodeNfoCount = videoDetail.episodePaths.size();
     }
+    return true;
+}
 
+bool TMDBAPI::ParseCreditsToVideoDetail(const Poco::URI& uri, ApiUrlType apiUrlType, VideoDetail& videoDetail)
+{
     const std::string imageUrl =
         Config::Instance().GetApiUrl(IMAGE_DOWNLOAD) + Config::Instance().GetImageDownloadQuality();
 
-    auto castJsonArrPtr = jsonPtr->getArray("cast");
-    for (std::size_t i = 0; i < castJsonArrPtr->size(); i++) {
-        auto              castJsonObjPtr = castJsonArrPtr->getObject(i);
-        const std::string department     = castJsonObjPtr->getValue<std::string>("known_for_department");
+    std::string   department;
+    ActorDetail   actor = ActorDetail();
+    JsonExtractor extractor;
+    extractor.OnValue("cast[].known_for_department", [&department](const std::string& val) { department = val; });
+    extractor.OnValue("cast[].name", [&actor](const std::string& val) { actor.name = val; });
+    extractor.OnValue("cast[].character", [&actor](const std::string& val) { actor.role = val; });
+    extractor.OnValue("cast[].order", [&actor](const std::string& val) { actor.order = JsonExtractor::ToInt(val); });
+    extractor.OnValue("cast[].profile_path", [&actor, &imageUrl](const std::string& val) {
+        actor.thumb = imageUrl + val;
+    });
+    extractor.OnObjectEnd("cast[]", [&department, &actor, &videoDetail]() {
         if (department == "Acting") {
-            ActorDetail actor = {
-                castJsonObjPtr->getValue<std::string>("name"),
-                castJsonObjPtr->getValue<std::string>("character"),
-                castJsonObjPtr->getValue<int>("order"),
-                castJsonObjPtr->isNull("profile_path")
-                    ? ""
-                    : imageUrl + castJsonObjPtr->getValue<std::string>("profile_path"),
-            };
             videoDetail.actors.push_back(actor);
         }
-    }
-
-    auto crewJsonArrPtr = jsonPtr->getArray("crew");
-    for (std::size_t i = 0; i < crewJsonArrPtr->size(); i++) {
-        auto crewJsonObjPtr = crewJsonArrPtr->getObject(i);
-        if (crewJsonObjPtr->optValue<std::string>("job", "") == "Writer") {
-            videoDetail.credits.push_back(crewJsonObjPtr->getValue<std::string>("name"));
-        } else if (crewJsonObjPtr->optValue<std::string>("job", "") == "Director") {
-            videoDetail.director = crewJsonObjPtr->getValue<std::string>("name");
+        department.clear();
+        actor = ActorDetail();
+    });
+
+    std::string job;
+    std::string crewName;
+    extractor.OnValue("crew[].job", [&job](const std::string& val) { job = val; });
+    extractor.OnValue("crew[].name", [&crewName](const std::string& val) { crewName = val; });
+    extractor.OnObjectEnd("crew[]", [&job, &crewName, &videoDetail]() {
+        if (job == "Writer") {
+            videoDetail.credits.push_back(crewName);
+        } else if (job == "Director") {
+            videoDetail.director = crewName;
         }
-    }
+        job.clear();
+        crewName.clear();
+    });
 
-    return true;
+    return SendRequest(uri, apiUrlType, extractor);
 }
 
 bool TMDBAPI::GetMovieCredits(int tmdbId, VideoDetail& videoDetail)
 {
-    std::stringstream sS;
-
     // 拼接访问的URL
     std::string uriStr = Config::Instance().GetApiUrl(GET_MOVIE_CREDITS);
     if (ReplaceString(uriStr, "{movie_id}", std::to_string(tmdbId)) <= 0) {
@@ -406,17 +858,11 @@ bool TMDBAPI::GetMovieCredits(int tmdbId, VideoDetail& videoDetail)
     uri.addQueryParameter("language", "zh-cn");
     LOG_DEBUG("Get movie credits uri is: {}", uri.toString());
 
-    if (SendRequest(sS, uri)) {
-        return ParseCreditsToVideoDetail(sS, videoDetail);
-    } else {
-        return false;
-    }
+    return ParseCreditsToVideoDetail(uri, GET_MOVIE_CREDITS, videoDetail);
 }
 
 bool TMDBAPI::GetTVCredits(int tmdbId, VideoDetail& videoDetail)
 {
-    std::stringstream sS;
-
     // 拼接访问的URL
     std::string uriStr = Config::Instance().GetApiUrl(GET_TV_CREDITS);
     if (ReplaceString(uriStr, "{tv_id}", std::to_string(tmdbId)) <= 0) {
@@ -429,49 +875,38 @@ bool TMDBAPI::GetTVCredits(int tmdbId, VideoDetail& videoDetail)
     uri.addQueryParameter("language", "zh-cn");
     LOG_DEBUG("Get tv credits uri is: {}", uri.toString());
 
-   if (SendRequest(sS, uri)) {
-        return ParseCreditsToVideoDetail(sS, videoDetail);
-    } else {
-        return false;
-    }
+    return ParseCreditsToVideoDetail(uri, GET_TV_CREDITS, videoDetail);
 }
 
 bool TMDBAPI::DownloadImages(VideoInfo& videoInfo)
 {
-    auto DownloadToFile = [this](const std::string filePath, const std::string uri) {
-        std::ofstream ofs(filePath);
-        if (!ofs.is_open()) {
-            LOG_ERROR("Failed to open file {} to write poster!", filePath);
-            return false;
-        }
+    const std::string imageUrl =
+        Config::Instance().GetApiUrl(IMAGE_DOWNLOAD) + Config::Instance().GetImageDownloadQuality();
+    auto downloader = [this, &imageUrl](std::ostream& out, const std::string& uri) {
+        return DownloadImage(out, Poco::URI(imageUrl + uri));
+    };
 
-        const std::string imageUrl =
-            Config::Instance().GetApiUrl(IMAGE_DOWNLOAD) + Config::Instance().GetImageDownloadQuality();
-        if (uri.empty()) {
-            LOG_WARN("Image uri for {} is empty!", filePath);
-            return false;
-        } else {
-            LOG_DEBUG("Download poster {} to {}", uri, filePath);
-            return SendRequest(ofs, Poco::URI(imageUrl + uri));
-        }
+    // 图片来源未变化时跳过下载, 相同的图片在本地仅存储一份
+    auto DownloadToFile = [&downloader](const std::string& filePath, const std::string& uri) {
+        return ArtworkStore::Instance().Sync(filePath, uri, downloader);
     };
 
-    videoInfo.posterStatus    = DownloadToFile(videoInfo.posterPath, videoInfo.videoDetail.posterUrl)
-                                    ? FILE_FORMAT_MATCH
-                                    : FILE_FORMAT_MISMATCH;
-    videoInfo.fanartStatus    = DownloadToFile(videoInfo.fanartPath, videoInfo.videoDetail.fanartUrl)
-                                    ? FILE_FORMAT_MATCH
-                                    : FILE_FORMAT_MISMATCH;
-    videoInfo.clearlogoStatus = DownloadToFile(videoInfo.clearlogoPath, videoInfo.videoDetail.clearLogoUrl)
-                                    ? FILE_FORMAT_MATCH
-                                    : FILE_FORMAT_MISMATCH;
+    const VideoDetail& videoDetail = videoInfo.videoDetail;
+    videoInfo.posterStatus         = DownloadToFile(DataSource::GetPosterPath(videoInfo), videoDetail.posterUrl)
+                                         ? FILE_FORMAT_MATCH
+                                         : FILE_FORMAT_MISMATCH;
+    videoInfo.fanartStatus         = DownloadToFile(DataSource::GetFanartPath(videoInfo), videoDetail.fanartUrl)
+                                         ? FILE_FORMAT_MATCH
+                                         : FILE_FORMAT_MISMATCH;
+    videoInfo.clearlogoStatus      = DownloadToFile(DataSource::GetClearlogoPath(videoInfo), videoDetail.clearLogoUrl)
+                                         ? FILE_FORMAT_MATCH
+                                         : FILE_FORMAT_MISMATCH;
 
     return true;
 }
 
 bool TMDBAPI::GetMovieImages(VideoInfo& videoInfo)
 {
-    std::stringstream sS;
     // 拼接访问的URL
     std::string uriStr = Config::Instance().GetApiUrl(GET_MOVIE_IMAGES);
     if (ReplaceString(uriStr, "{movie_id}", std::to_string(videoInfo.videoDetail.uniqueid.at("tmdb"))) <= 0) {
@@ -485,8 +920,7 @@ bool TMDBAPI::GetMovieImages(VideoInfo& videoInfo)
     uriLangZh.addQueryParameter("include_image_language", "zh");
     LOG_DEBUG("Get movie images uri(language zh) is: {}", uriLangZh.toString());
 
-    SendRequest(sS, uriLangZh);
-    ParseImagesToVideoDetail(sS, videoInfo.videoDetail);
+    ParseImagesToVideoDetail(uriLangZh, GET_MOVIE_IMAGES, videoInfo.videoDetail);
 
     if (!IsImagesAllFilled(videoInfo.videoDetail)) {
         Poco::URI uriLangEn(uriStr);
@@ -494,8 +928,7 @@ bool TMDBAPI::GetMovieImages(VideoInfo& videoInfo)
         uriLangEn.addQueryParameter("include_image_language", "en");
         LOG_DEBUG("Get movie images uri(language en) is: {}", uriLangEn.toString());
 
-        SendRequest(sS, uriLangEn);
-        ParseImagesToVideoDetail(sS, videoInfo.videoDetail);
+        ParseImagesToVideoDetail(uriLangEn, GET_MOVIE_IMAGES, videoInfo.videoDetail);
     }
 
     if (!IsImagesAllFilled(videoInfo.videoDetail)) {
@@ -504,8 +937,7 @@ bool TMDBAPI::GetMovieImages(VideoInfo& videoInfo)
         uriLangNull.addQueryParameter("include_image_language", "null");
         LOG_DEBUG("Get movie images uri(language null) is: {}", uriLangNull.toString());
 
-        SendRequest(sS, uriLangNull);
-        ParseImagesToVideoDetail(sS, videoInfo.videoDetail);
+        ParseImagesToVideoDetail(uriLangNull, GET_MOVIE_IMAGES, videoInfo.videoDetail);
     }
 
     return true;
@@ -513,7 +945,6 @@ bool TMDBAPI::GetMovieImages(VideoInfo& videoInfo)
 
 bool TMDBAPI::GetSeasonImages(VideoInfo& videoInfo, int seasonNumber)
 {
-    std::stringstream sS;
     // 拼接访问的URL
     std::string uriStr = Config::Instance().GetApiUrl(GET_SEASON_IMAGES);
     if (ReplaceString(uriStr, "{tv_id}", std::to_string(videoInfo.videoDetail.uniqueid.at("tmdb"))) <= 0) {
@@ -532,8 +963,7 @@ bool TMDBAPI::GetSeasonImages(VideoInfo& videoInfo, int seasonNumber)
     uriLangZh.addQueryParameter("include_image_language", "zh");
     LOG_DEBUG("Get season images uri(language zh) is: {}", uriLangZh.toString());
 
-    SendRequest(sS, uriLangZh);
-    ParseImagesToVideoDetail(sS, videoInfo.videoDetail);
+    ParseImagesToVideoDetail(uriLangZh, GET_SEASON_IMAGES, videoInfo.videoDetail);
 
     if (!IsImagesAllFilled(videoInfo.videoDetail)) {
         Poco::URI uriLangEn(uriStr);
@@ -541,8 +971,7 @@ bool TMDBAPI::GetSeasonImages(VideoInfo& videoInfo, int seasonNumber)
         uriLangEn.addQueryParameter("include_image_language", "en");
         LOG_DEBUG("Get season images uri(language en) is: {}", uriLangEn.toString());
 
-        SendRequest(sS, uriLangEn);
-        ParseImagesToVideoDetail(sS, videoInfo.videoDetail);
+        ParseImagesToVideoDetail(uriLangEn, GET_SEASON_IMAGES, videoInfo.videoDetail);
     }
 
     if (!IsImagesAllFilled(videoInfo.videoDetail)) {
@@ -551,8 +980,7 @@ bool TMDBAPI::GetSeasonImages(VideoInfo& videoInfo, int seasonNumber)
         uriLangNull.addQueryParameter("include_image_language", "null");
         LOG_DEBUG("Get season images uri(language null) is: {}", uriLangNull.toString());
 
-        SendRequest(sS, uriLangNull);
-        ParseImagesToVideoDetail(sS, videoInfo.videoDetail);
+        ParseImagesToVideoDetail(uriLangNull, GET_SEASON_IMAGES, videoInfo.videoDetail);
     }
 
     return true;
@@ -570,7 +998,6 @@ bool TMDBAPI::GetTVImages(VideoInfo& videoInfo, int seasonNumber)
         return true;
     }
 
-    std::stringstream sS;
     // 拼接访问的URL
     std::string uriStr = Config::Instance().GetApiUrl(GET_TV_IMAGES);
     if (ReplaceString(uriStr, "{tv_id}", std::to_string(videoInfo.videoDetail.uniqueid.at("tmdb"))) <= 0) {
@@ -584,8 +1011,7 @@ bool TMDBAPI::GetTVImages(VideoInfo& videoInfo, int seasonNumber)
     uriLangZh.addQueryParameter("include_image_language", "zh");
     LOG_DEBUG("Get season images uri(language zh) is: {}", uriLangZh.toString());
 
-    SendRequest(sS, uriLangZh);
-    ParseImagesToVideoDetail(sS, videoInfo.videoDetail);
+    ParseImagesToVideoDetail(uriLangZh, GET_TV_IMAGES, videoInfo.videoDetail);
 
     if (!IsImagesAllFilled(videoInfo.videoDetail)) {
         Poco::URI uriLangEn(uriStr);
@@ -593,8 +1019,7 @@ bool TMDBAPI::GetTVImages(VideoInfo& videoInfo, int seasonNumber)
         uriLangEn.addQueryParameter("include_image_language", "en");
         LOG_DEBUG("Get season images uri(language en) is: {}", uriLangEn.toString());
 
-        SendRequest(sS, uriLangEn);
-        ParseImagesToVideoDetail(sS, videoInfo.videoDetail);
+        ParseImagesToVideoDetail(uriLangEn, GET_TV_IMAGES, videoInfo.videoDetail);
     }
 
     if (!IsImagesAllFilled(videoInfo.videoDetail)) {
@@ -603,8 +1028,7 @@ bool TMDBAPI::GetTVImages(VideoInfo& videoInfo, int seasonNumber)
         uriLangNull.addQueryParameter("include_image_language", "null");
         LOG_DEBUG("Get season images uri(language null) is: {}", uriLangNull.toString());
 
-        SendRequest(sS, uriLangNull);
-        ParseImagesToVideoDetail(sS, videoInfo.videoDetail);
+        ParseImagesToVideoDetail(uriLangNull, GET_TV_IMAGES, videoInfo.videoDetail);
     }
 
     return true;
@@ -623,8 +1047,11 @@ bool TMDBAPI::UpdateTV(VideoInfo& videoInfo)
         LOG_ERROR("No TMDB ID for current video {}", videoInfo.videoPath);
         return false;
     }
+    if (!CheckScrapable(TV, tmdbIdIter->second)) {
+        LOG_WARN("Update skipped for {}: {}", videoInfo.videoPath, GetLastErrStr());
+        return false;
+    }
 
-    std::stringstream seasonDetailStream;
     if (!GetSeasonDetail(videoInfo.videoDetail.uniqueid.at("tmdb"), videoInfo.videoDetail.seasonNumber, videoInfo.videoDetail, true)) {
         LOG_ERROR("Get season detail failed for {}", videoInfo.videoPath);
         return false;
@@ -639,7 +1066,7 @@ bool TMDBAPI::UpdateTV(VideoInfo& videoInfo)
     // result  = parser.parse(tvDetailStream);
     // jsonPtr = result.extract<Object::Ptr>();
     // if (jsonPtr->getValue<std::string>("status").compare("Ended")) {
-    //     if (SetTVEnded(videoInfo.nfoPath)) {
+    //     if (SetTVEnded(DataSource::GetNfoPath(videoInfo))) {
     //         LOG_ERROR("TV {} is set to ended failed!", videoInfo.videoPath);
     //     } else {
     //         LOG_INFO("TV {} is set to ended!", videoInfo.videoPath);
@@ -651,13 +1078,16 @@ bool TMDBAPI::UpdateTV(VideoInfo& videoInfo)
 
 bool TMDBAPI::ScrapeMovie(VideoInfo& videoInfo, int movieID)
 {
+    if (!CheckScrapable(MOVIE, movieID)) {
+        return false;
+    }
+
     videoInfo.videoDetail.genre.clear();
     videoInfo.videoDetail.countries.clear();
     videoInfo.videoDetail.credits.clear();
     videoInfo.videoDetail.studio.clear();
     videoInfo.videoDetail.actors.clear();
 
-    std::stringstream sS;
     if (!GetMovieDetail(movieID, videoInfo.videoDetail)) {
         m_lastErrCode = GET_MOVIE_DETAIL_FAILED;
         return false;
@@ -670,7 +1100,7 @@ bool TMDBAPI::ScrapeMovie(VideoInfo& videoInfo, int movieID)
         return false;
     }
 
-    if (!VideoInfoToNfo(videoInfo, videoInfo.nfoPath, true, "tmdb")) {
+    if (!VideoInfoToNfo(videoInfo, DataSource::GetNfoPath(videoInfo), true, "tmdb")) {
         m_lastErrCode = WRITE_NFO_FILE_FAILED;
         return false;
     }
@@ -694,6 +1124,10 @@ bool TMDBAPI::ScrapeMovie(VideoInfo& videoInfo, int movieID)
 
 bool TMDBAPI::ScrapeTV(VideoInfo& videoInfo, int tvId, int seasonId, bool forceUseOnlineTvMeta)
 {
+    if (!CheckScrapable(TV, tvId)) {
+        return false;
+    }
+
     // 清空所有的矢量, 刮削时矢量元素的添加均为push_back()
     videoInfo.videoDetail.genre.clear();
     videoInfo.videoDetail.countries.clear();
@@ -703,7 +1137,6 @@ bool TMDBAPI::ScrapeTV(VideoInfo& videoInfo, int tvId, int seasonId, bool forceU
     // 设置季编号
     videoInfo.videoDetail.seasonNumber = seasonId;
 
-    std::stringstream sS;
     if (!GetTVDetail(tvId, seasonId, videoInfo.videoDetail)) {
         m_lastErrCode = GET_TV_DETAIL_FAILED;
         return false;
@@ -721,7 +1154,7 @@ bool TMDBAPI::ScrapeTV(VideoInfo& videoInfo, int tvId, int seasonId, bool forceU
         return false;
     }
 
-    if (!VideoInfoToNfo(videoInfo, videoInfo.nfoPath, true, "tmdb")) {
+    if (!VideoInfoToNfo(videoInfo, DataSource::GetNfoPath(videoInfo), true, "tmdb")) {
         m_lastErrCode = WRITE_NFO_FILE_FAILED;
         return false;
     }
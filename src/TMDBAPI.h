@@ -2,8 +2,25 @@
 
 #include "AbstractAPI.h"
 
+#include <chrono>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <Poco/Net/HTTPClientSession.h>
 #include <Poco/URI.h>
 
+#include "CircuitBreaker.h"
+#include "Config.h"
+#include "LatencyHistogram.h"
+#include "NegativeCache.h"
+
+class JsonExtractor;
+class RateLimiter;
+class TaskExecutor;
+
 class TMDBAPI : public AbstractAPI
 {
     enum ErrCode {
@@ -19,33 +36,271 @@ class TMDBAPI : public AbstractAPI
         PARSE_CREDITS_FAILED,
         DOWNLOAD_POSTER_FAILED,
         WRITE_NFO_FILE_FAILED,
+        UPSTREAM_UNAVAILABLE,
+        TMDB_ID_NOT_FOUND,
+    };
+
+    /**
+     * @brief 响应内容的处理函数, 直接从套接字读取, 处理成功时返回true
+     *
+     */
+    using BodyHandler = std::function<bool(std::istream&)>;
+
+    /**
+     * @brief 单次HTTP请求的结果
+     *
+     */
+    struct AttemptResult {
+        bool delivered     = false; // 响应内容是否已交给处理函数, 已交付的请求不能重试
+        bool handled       = false; // 处理函数是否成功读取了完整的响应内容
+        int  status        = 0;     // HTTP响应码, 网络错误时为0
+        int  retryAfterSec = 0;     // 服务端要求的重试等待时间, 单位: 秒
+    };
+
+    /**
+     * @brief 按策略执行请求(含重试)的最终结果
+     *
+     */
+    enum RequestOutcome {
+        REQUEST_OK,        // 成功
+        REQUEST_FAILED,    // 上游失败(网络错误, 错误的响应码等), 已知不存在或者熔断中
+        REQUEST_THROTTLED, // 截止时间前未获取到本地限流的令牌, 没有访问上游
     };
 
 public:
 
+    /**
+     * @brief 搜索结果中的单个条目
+     *
+     */
+    struct SearchResult {
+        int         tmdbId     = 0;   // TMDB的ID
+        std::string title;            // 标题
+        std::string originalTitle;    // 原始标题
+        int         year       = 0;   // 上映/首播年份, 0表示未知
+        double      popularity = 0.0; // 热度
+    };
+
+    /**
+     * @brief 获取API的请求耗时直方图
+     *
+     * @param apiUrlType API的URL类型
+     * @return LatencyHistogram& 请求耗时直方图
+     */
+    static LatencyHistogram& GetLatencyHistogram(ApiUrlType apiUrlType);
+
+    /**
+     * @brief 获取API的熔断器, 图像下载与其余API的主机不同, 分别熔断
+     *
+     * @param apiUrlType API的URL类型
+     * @return CircuitBreaker& 熔断器
+     */
+    static CircuitBreaker& GetCircuitBreaker(ApiUrlType apiUrlType);
+
+    /**
+     * @brief 获取TMDB返回404的请求缓存, key为请求的路径
+     *
+     * @return NegativeCache& 失败缓存
+     */
+    static NegativeCache& GetNegativeCache();
+
+    /**
+     * @brief TMDB的API是否可用, 熔断中时批量任务应提前终止
+     *
+     * @return true 可用
+     * @return false 熔断中
+     */
+    static bool IsUpstreamAvailable();
+
+    /**
+     * @brief 判断TMDB的ID是否已知不存在(近期返回过404)
+     *
+     * @param videoType 视频类型
+     * @param tmdbId TMDB的ID
+     * @return true 已知不存在
+     * @return false 未知
+     */
+    static bool IsKnownMissing(VideoType videoType, int tmdbId);
+
+    /**
+     * @brief 清除TMDB ID不存在的记录, 用于人工指定ID刮削时立即重新请求
+     *
+     * @param videoType 视频类型
+     * @param tmdbId TMDB的ID
+     */
+    static void ForgetMissing(VideoType videoType, int tmdbId);
+
+    /**
+     * @brief 停止对冲请求的执行器, 丢弃未发出的对冲请求并等待已发出的对冲请求结束, 退出前调用
+     *
+     */
+    static void Drain();
+
     bool ScrapeMovie(VideoInfo& videoInfo, int movieID) override;
 
     bool ScrapeTV(VideoInfo& videoInfo, int tvId, int seasonId, bool forceUseOnlineTvMeta = false) override;
 
     bool UpdateTV(VideoInfo& videoInfo);
 
+    /**
+     * @brief 按照关键字搜索电影/电视剧
+     *
+     * @param videoType 视频类型
+     * @param keywords 关键字
+     * @param year 年份, 不大于0时不限制
+     * @param results 输出搜索结果(按照TMDB的相关度排序)
+     * @return true 搜索成功
+     * @return false 搜索失败
+     */
+    bool Search(VideoType videoType, const std::string& keywords, int year, std::vector<SearchResult>& results);
+
+    /**
+     * @brief 获取电影的时长或者电视剧的单集时长
+     *
+     * @param videoType 视频类型
+     * @param tmdbId TMDB的ID
+     * @param runtime 输出时长, 单位: 分钟
+     * @return true 获取成功
+     * @return false 获取失败或者TMDB没有时长信息
+     */
+    bool GetRuntime(VideoType videoType, int tmdbId, int& runtime);
+
+    /**
+     * @brief 获取电视剧的播出计划
+     *
+     * @param tmdbId TMDB的ID
+     * @param airingInfo 输出播出计划
+     * @return true 获取成功
+     * @return false 获取失败
+     */
+    bool GetAiringInfo(int tmdbId, AiringInfo& airingInfo);
+
     int GetLastErrCode() override;
 
     const std::string& GetLastErrStr() override;
 
 private:
 
+    static const std::size_t HEDGE_WORKER_NUM = 2; // 对冲请求的线程数
+    static const std::size_t HEDGE_QUEUE_SIZE = 8; // 对冲请求的队列容量, 已满时不再对冲
+
+    /**
+     * @brief 获取对冲请求的执行器, 对冲请求在其中等待分位数阈值后发出
+     *
+     * @return TaskExecutor& 执行器
+     */
+    static TaskExecutor& GetHedgeExecutor();
+
+    /**
+     * @brief 获取TMDB API的限流器, 图像下载不限流
+     *
+     * @return RateLimiter& 限流器
+     */
+    static RateLimiter& GetRateLimiter();
+
     bool IsImagesAllFilled(const VideoDetail& videoDetail);
 
-    bool SendRequest(std::ostream& out, const Poco::URI& uri);
+    /**
+     * @brief 刮削前检查上游是否熔断以及ID是否已知不存在, 不通过时设置错误码
+     *
+     * @param videoType 视频类型
+     * @param tmdbId TMDB的ID
+     * @return true 可以刮削
+     * @return false 应直接跳过
+     */
+    bool CheckScrapable(VideoType videoType, int tmdbId);
+
+    /**
+     * @brief 获取TMDB ID在失败缓存中的key, 即详情接口的URL路径
+     *
+     * @param videoType 视频类型
+     * @param tmdbId TMDB的ID
+     * @return std::string 失败缓存的key
+     */
+    static std::string MissingKey(VideoType videoType, int tmdbId);
+
+    /**
+     * @brief 发送API请求并从响应流中直接解析JSON, 相同的请求同时进行时仅访问一次网络
+     *
+     * 合并的请求只共享解析器提取到的字段, 不缓存响应的原文
+     *
+     * @param uri 请求的地址
+     * @param apiUrlType API的URL类型, 用于选择超时与重试策略
+     * @param extractor 已注册好处理函数的解析器
+     * @return true 请求与解析均成功
+     * @return false 请求失败或者解析失败, 解析失败时解析器的GetLastError不为空
+     */
+    bool SendRequest(const Poco::URI& uri, ApiUrlType apiUrlType, JsonExtractor& extractor);
+
+    /**
+     * @brief 下载图片, 响应内容直接写入输出流, 不合并请求
+     *
+     * @param out 图片的输出流
+     * @param uri 图片的地址
+     * @return true 下载成功
+     * @return false 下载失败
+     */
+    bool DownloadImage(std::ostream& out, const Poco::URI& uri);
+
+    /**
+     * @brief 按照API的超时与重试策略执行HTTP请求, 每次尝试前获取本地限流的令牌
+     *
+     * @param uri 请求的地址
+     * @param apiUrlType API的URL类型
+     * @param handler 响应内容的处理函数, 响应内容交给处理函数后不再重试
+     * @return RequestOutcome 请求的结果, 本地限流不计入熔断器也不重试
+     */
+    RequestOutcome DoRequest(const Poco::URI& uri, ApiUrlType apiUrlType, const BodyHandler& handler);
+
+    /**
+     * @brief 在调用线程中执行一次请求, 耗时超过历史分位数时由执行器发起对冲请求, 先收到响应的一方处理响应内容
+     *
+     * @param uri 请求的地址
+     * @param apiUrlType API的URL类型
+     * @param policy 超时与重试策略
+     * @param deadline 总超时的截止时间
+     * @param handler 响应内容的处理函数, 只会被调用一次
+     * @return AttemptResult 请求结果
+     */
+    static AttemptResult SendHedged(const Poco::URI&                             uri,
+                                    ApiUrlType                                   apiUrlType,
+                                    const RequestPolicyConf&                     policy,
+                                    const std::chrono::steady_clock::time_point& deadline,
+                                    const BodyHandler&                           handler);
+
+    /**
+     * @brief 执行一次HTTP请求, 响应成功且取得处理权时把响应流交给处理函数, 处理成功时记录耗时
+     *
+     * @param uri 请求的地址
+     * @param apiUrlType API的URL类型
+     * @param policy 超时与重试策略
+     * @param session 请求的会话, 由调用者持有, 以便其他线程中断请求
+     * @param handler 响应内容的处理函数
+     * @param claim 收到成功的响应后调用, 返回false表示另一个请求已在处理, 本次请求放弃
+     * @return AttemptResult 请求结果
+     */
+    static AttemptResult SendOnce(const Poco::URI&              uri,
+                                  ApiUrlType                    apiUrlType,
+                                  const RequestPolicyConf&      policy,
+                                  Poco::Net::HTTPClientSession& session,
+                                  const BodyHandler&            handler,
+                                  const std::function<bool()>&  claim);
+
+    /**
+     * @brief 规范化请求地址, 作为合并相同请求的key
+     *
+     * @param uri 请求的地址
+     * @return std::string 规范化后的地址
+     */
+    static std::string NormalizeUri(const Poco::URI& uri);
 
-    bool ParseMovieDetailsToVideoDetail(std::stringstream& sS, VideoDetail& videoDetail);
+    bool ParseMovieDetailsToVideoDetail(const Poco::URI& uri, VideoDetail& videoDetail);
 
-    bool ParseTVDetailsToVideoDetail(std::stringstream& sS, VideoDetail& videoDetail, int seasonId);
+    bool ParseTVDetailsToVideoDetail(const Poco::URI& uri, VideoDetail& videoDetail, int seasonId);
 
-    bool ParseCreditsToVideoDetail(std::stringstream& sS, VideoDetail& videoDetail);
+    bool ParseCreditsToVideoDetail(const Poco::URI& uri, ApiUrlType apiUrlType, VideoDetail& videoDetail);
 
-    bool ParseImagesToVideoDetail(std::stringstream& sS, VideoDetail& videoDetail);
+    bool ParseImagesToVideoDetail(const Poco::URI& uri, ApiUrlType apiUrlType, VideoDetail& videoDetail);
 
     bool GetMovieDetail(int tmdbid, VideoDetail& videoDetail);
 
@@ -0,0 +1,141 @@
+#include "TVUpdateScheduler.h"
+
+#include <algorithm>
+#include <cstdio>
+
+const std::time_t TVUpdateScheduler::MIN_INTERVAL;
+const std::time_t TVUpdateScheduler::MAX_INTERVAL;
+
+const std::time_t SECONDS_PER_DAY = 86400; // 一天的秒数
+
+void TVUpdateScheduler::Observe(const std::string& path, std::size_t episodeCount, bool dueNow, std::time_t now)
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    auto                        iter = m_shows.find(path);
+    if (iter == m_shows.end()) {
+        // 首次出现且没有缺失NFO的剧分散到一天之内检查, 避免启动时集中访问TMDB
+        ShowState&  state  = m_shows[path];
+        std::time_t offset = static_cast<std::time_t>(std::hash<std::string>()(path) % SECONDS_PER_DAY);
+        state.episodeCount = episodeCount;
+        Push(path, state, dueNow ? now : now + offset);
+        return;
+    }
+
+    // 本地出现新的剧集文件时立即检查, 包括已完结的剧
+    if (iter->second.episodeCount != episodeCount) {
+        iter->second.episodeCount = episodeCount;
+        Push(path, iter->second, now);
+    }
+}
+
+std::vector<std::string> TVUpdateScheduler::PopDue(std::time_t now)
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    std::vector<std::string>    duePaths;
+    while (!m_queue.empty() && m_queue.top().checkTime <= now) {
+        CheckItem item = m_queue.top();
+        m_queue.pop();
+
+        // 跳过已被重新安排或者移除的检查项
+        auto iter = m_shows.find(item.path);
+        if (iter == m_shows.end() || iter->second.seq != item.seq) {
+            continue;
+        }
+        iter->second.seq = 0;
+        duePaths.push_back(item.path);
+    }
+    return duePaths;
+}
+
+void TVUpdateScheduler::Reschedule(const std::string& path, std::time_t checkTime)
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    auto                        iter = m_shows.find(path);
+    if (iter == m_shows.end()) {
+        return;
+    }
+    if (checkTime <= 0) {
+        iter->second.seq = 0;
+        return;
+    }
+    Push(path, iter->second, checkTime);
+}
+
+void TVUpdateScheduler::Remove(const std::string& path)
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    m_shows.erase(path);
+}
+
+std::size_t TVUpdateScheduler::ScheduledCount()
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    return std::count_if(m_shows.begin(), m_shows.end(), [](const std::pair<const std::string, ShowState>& pair) {
+        return pair.second.seq != 0;
+    });
+}
+
+void TVUpdateScheduler::Push(const std::string& path, ShowState& state, std::time_t checkTime)
+{
+    state.seq = m_nextSeq++;
+    m_queue.push(CheckItem{checkTime, path, state.seq});
+
+    // 失效的检查项过多时重建堆
+    if (m_queue.size() > m_shows.size() * 2 + 64) {
+        std::vector<CheckItem> items;
+        while (!m_queue.empty()) {
+            const CheckItem& item = m_queue.top();
+            auto             iter = m_shows.find(item.path);
+            if (iter != m_shows.end() && iter->second.seq == item.seq) {
+                items.push_back(item);
+            }
+            m_queue.pop();
+        }
+        m_queue = CheckQueue(std::greater<CheckItem>(), std::move(items));
+    }
+}
+
+std::time_t TVUpdateScheduler::NextCheckTime(const AiringInfo& info, std::time_t lastFileTime, std::time_t now)
+{
+    if (info.isEnded) {
+        return 0;
+    }
+
+    // 有下一集的播出计划时, 在播出半天后检查, 留出TMDB更新元数据和本地下载的时间
+    std::time_t nextAirTime = ParseDate(info.nextAirDate);
+    if (nextAirTime > 0) {
+        return std::min(std::max(nextAirTime + SECONDS_PER_DAY / 2, now + MIN_INTERVAL), now + MAX_INTERVAL);
+    }
+
+    // 没有播出计划时按照最近的活跃程度退避: 近期仍有播出或者新文件的剧检查得更频繁
+    std::time_t lastActiveTime = std::max(ParseDate(info.lastAirDate), lastFileTime);
+    std::time_t idleTime       = now - lastActiveTime;
+    std::time_t interval       = MAX_INTERVAL;
+    if (idleTime < 7 * SECONDS_PER_DAY) {
+        interval = SECONDS_PER_DAY;
+    } else if (idleTime < 30 * SECONDS_PER_DAY) {
+        interval = 3 * SECONDS_PER_DAY;
+    } else if (idleTime < 180 * SECONDS_PER_DAY) {
+        interval = 7 * SECONDS_PER_DAY;
+    }
+    return now + interval;
+}
+
+std::time_t TVUpdateScheduler::ParseDate(const std::string& date)
+{
+    int year  = 0;
+    int month = 0;
+    int day   = 0;
+    if (std::sscanf(date.c_str(), "%d-%d-%d", &year, &month, &day) != 3 || month < 1 || month > 12 || day < 1 ||
+        day > 31) {
+        return 0;
+    }
+
+    // 公历日期转换为距1970-01-01的天数, 不依赖本地时区
+    year -= month <= 2 ? 1 : 0;
+    const int era       = (year >= 0 ? year : year - 399) / 400;
+    const int yearOfEra = year - era * 400;
+    const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int dayOfEra  = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return static_cast<std::time_t>(era * 146097 + dayOfEra - 719468) * SECONDS_PER_DAY;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "CommonType.h"
+
+/**
+ * @brief 按照播出计划安排电视剧的更新检查
+ *
+ * 每部剧按照下次检查的时间放入优先队列, 只有到期的剧才会访问TMDB.
+ * 下次检查的时间由TMDB的下一集播出日期, 最近播出日期, 播出状态以及本地剧集文件的更新时间决定,
+ * 已完结的剧不再检查, 直到本地出现新的剧集文件.
+ */
+class TVUpdateScheduler
+{
+    /**
+     * @brief 队列中的检查项, 重新安排时旧的检查项通过序号失效
+     *
+     */
+    struct CheckItem {
+        std::time_t checkTime; // 检查的时间
+        std::string path;      // 电视剧的路径
+        uint64_t    seq;       // 检查项的序号
+
+        bool operator>(const CheckItem& other) const { return checkTime > other.checkTime; }
+    };
+
+    /**
+     * @brief 单部剧的调度状态
+     *
+     */
+    struct ShowState {
+        std::size_t episodeCount = 0; // 最近一次观察到的本地剧集数
+        uint64_t    seq          = 0; // 有效检查项的序号, 0表示未安排检查
+    };
+
+    using CheckQueue = std::priority_queue<CheckItem, std::vector<CheckItem>, std::greater<CheckItem>>;
+
+public:
+
+    static const std::time_t MIN_INTERVAL = 3600;       // 两次检查的最小间隔, 单位: 秒
+    static const std::time_t MAX_INTERVAL = 30 * 86400;  // 两次检查的最大间隔, 单位: 秒
+
+    /**
+     * @brief 同步本地扫描的结果, 新的剧或者本地剧集数变化的剧会被安排检查
+     *
+     * @param path 电视剧的路径
+     * @param episodeCount 本地的剧集数
+     * @param dueNow 是否需要立即检查(如存在缺失的剧集NFO)
+     * @param now 当前时间
+     */
+    void Observe(const std::string& path, std::size_t episodeCount, bool dueNow, std::time_t now);
+
+    /**
+     * @brief 取出所有到期的电视剧, 取出后需要通过Reschedule()重新安排
+     *
+     * @param now 当前时间
+     * @return std::vector<std::string> 到期的电视剧路径, 按照检查时间排序
+     */
+    std::vector<std::string> PopDue(std::time_t now);
+
+    /**
+     * @brief 安排下次检查
+     *
+     * @param path 电视剧的路径
+     * @param checkTime 检查的时间, 为0时不再检查(直到本地剧集数变化)
+     */
+    void Reschedule(const std::string& path, std::time_t checkTime);
+
+    /**
+     * @brief 移除电视剧(如已从媒体库中删除)
+     *
+     * @param path 电视剧的路径
+     */
+    void Remove(const std::string& path);
+
+    /**
+     * @brief 获取已安排检查的电视剧数量
+     *
+     * @return std::size_t 数量
+     */
+    std::size_t ScheduledCount();
+
+    /**
+     * @brief 根据播出计划计算下次检查的时间
+     *
+     * @param info 播出计划
+     * @param lastFileTime 本地最新剧集文件的修改时间
+     * @param now 当前时间
+     * @return std::time_t 下次检查的时间, 已完结时为0
+     */
+    static std::time_t NextCheckTime(const AiringInfo& info, std::time_t lastFileTime, std::time_t now);
+
+    /**
+     * @brief 将日期(YYYY-MM-DD, UTC)转换为时间戳
+     *
+     * @param date 日期
+     * @return std::time_t 时间戳, 格式错误时为0
+     */
+    static std::time_t ParseDate(const std::string& date);
+
+private:
+
+    void Push(const std::string& path, ShowState& state, std::time_t checkTime);
+
+private:
+
+    CheckQueue                       m_queue;      // 检查项的最小堆
+    std::map<std::string, ShowState> m_shows;      // 路径 -> 调度状态
+    uint64_t                         m_nextSeq{1}; // 下一个检查项的序号
+    std::mutex                       m_lock;       // 调度状态的锁
+};
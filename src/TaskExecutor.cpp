@@ -0,0 +1,81 @@
+#include "TaskExecutor.h"
+
+#include "Logger.h"
+
+TaskExecutor::TaskExecutor(std::size_t threadNum, std::size_t queueCapacity)
+    : m_capacity(queueCapacity), m_stopped(false)
+{
+    for (std::size_t i = 0; i < threadNum; i++) {
+        m_workers.emplace_back(&TaskExecutor::WorkerLoop, this);
+    }
+}
+
+TaskExecutor::~TaskExecutor()
+{
+    Shutdown();
+}
+
+bool TaskExecutor::Submit(std::vector<Task> tasks)
+{
+    {
+        std::lock_guard<std::mutex> locker(m_lock);
+        if (m_stopped || m_tasks.size() + tasks.size() > m_capacity) {
+            return false;
+        }
+        for (auto& task : tasks) {
+            m_tasks.push_back(std::move(task));
+        }
+    }
+    m_cond.notify_all();
+    return true;
+}
+
+std::size_t TaskExecutor::Pending()
+{
+    std::lock_guard<std::mutex> locker(m_lock);
+    return m_tasks.size();
+}
+
+void TaskExecutor::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> locker(m_lock);
+        if (m_stopped) {
+            return;
+        }
+        m_stopped = true;
+        m_tasks.clear();
+    }
+    m_cond.notify_all();
+
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void TaskExecutor::WorkerLoop()
+{
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> locker(m_lock);
+            m_cond.wait(locker, [this]() { return m_stopped || !m_tasks.empty(); });
+            if (m_stopped) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        // 单个任务的异常不能导致工作线程退出
+        try {
+            task();
+        } catch (std::exception& e) {
+            LOG_ERROR("Background task failed: {}", e.what());
+        } catch (...) {
+            LOG_ERROR("Background task failed with unknown exception");
+        }
+    }
+}
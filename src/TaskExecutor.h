@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 固定线程数, 有界队列的后台任务执行器
+ *
+ * 队列已满时拒绝提交, 而不是无限堆积任务; 析构时丢弃未开始的任务并等待正在执行的任务结束.
+ * 用于TMDB的对冲请求和批量任务内并发执行的条目这类不需要状态记录与取消的短任务; 扫描, 刷新与批量刮削等
+ * 长任务由JobScheduler调度. 对冲请求不能排在长任务之后等待线程, 批量任务的条目也不能各占调度器的线程,
+ * 因此使用独立的执行器.
+ */
+class TaskExecutor
+{
+public:
+
+    using Task = std::function<void()>;
+
+    /**
+     * @brief 构造执行器并启动工作线程
+     *
+     * @param threadNum 工作线程数
+     * @param queueCapacity 等待队列的容量
+     */
+    TaskExecutor(std::size_t threadNum, std::size_t queueCapacity);
+
+    ~TaskExecutor();
+
+    TaskExecutor(const TaskExecutor&)            = delete;
+    TaskExecutor& operator=(const TaskExecutor&) = delete;
+
+    /**
+     * @brief 提交一组任务, 队列剩余容量不足时整组拒绝
+     *
+     * @param tasks 任务列表
+     * @return true 全部提交成功
+     * @return false 队列容量不足或执行器已停止, 没有任何任务被提交
+     */
+    bool Submit(std::vector<Task> tasks);
+
+    /**
+     * @brief 获取等待执行的任务数
+     *
+     * @return std::size_t 任务数
+     */
+    std::size_t Pending();
+
+    /**
+     * @brief 停止执行器, 丢弃未开始的任务并等待工作线程退出
+     *
+     */
+    void Shutdown();
+
+private:
+
+    void WorkerLoop();
+
+private:
+
+    std::size_t              m_capacity; // 等待队列的容量
+    bool                     m_stopped;  // 是否已停止
+    std::deque<Task>         m_tasks;    // 等待执行的任务
+    std::vector<std::thread> m_workers;  // 工作线程
+    std::mutex               m_lock;     // 队列的锁
+    std::condition_variable  m_cond;     // 队列的条件变量
+};